@@ -77,7 +77,15 @@ public:
 		logOption_->LogMessage(LogLevel::Log_Debug, "Weapon", int(weapon));
 		logOption_->decreaseDepth();
 
-		if (hostLevel != hobbitProcessAnalyzer->readData<uint8_t>(0x00762B5C))
+		// Level and the NPC's current animation in one batch
+		uint8_t currentLevel = 0;
+		uint32_t npcAnimation = 0;
+		ReadBatch batch;
+		batch.add(hobbitProcessAnalyzer->getAddress(GameAddress::CurrentLevel), currentLevel);
+		batch.add(npc.getAnimationPtr(), npcAnimation);
+		hobbitProcessAnalyzer->readBatch(batch);
+
+		if (hostLevel != currentLevel)
 		{
 			logOption_->setColor("RED");
 			logOption_->LogMessage(LogLevel::Log_Debug, "No Synchrone");
@@ -86,11 +94,9 @@ public:
 		}
 
 		//set position, rotation, and animation
-		npc.setPositionX(position.x);
-		npc.setPositionY(position.y);
-		npc.setPositionZ(position.z);
+		npc.setPosition(position.x, position.y, position.z);
 		npc.setRotationY(rotation.y);
-		if (animation != npc.getAnimation())
+		if (animation != npcAnimation)
 		{
 			npc.setAnimation(animation);
 			npc.setAnimFrames(animFrame, lastAnimFrame);
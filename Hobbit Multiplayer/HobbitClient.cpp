@@ -18,6 +18,9 @@ HobbitClient::HobbitClient(std::string initialServerIp)
 	messageLabelStates[DataLabel::CONNECTED_PLAYER_LEVEL] = true;
 	messageLabelStates[DataLabel::INVENTORY] = true;
 
+	client.addListener([this](const std::queue<uint8_t>& clientIDs) {
+		onClientListUpdate(clientIDs);
+		});
 }
 
 // Add new methods:
@@ -59,12 +62,18 @@ int HobbitClient::start() {
 int HobbitClient::start(const std::string& ip) {
 	serverIp = ip;
 
-	client.addListener([this](const std::queue<uint8_t>& clientIDs) {
-		onClientListUpdate(clientIDs);
-		});
-
 	if (client.start(serverIp)) return 1;
 
+	return startGame();
+}
+
+int HobbitClient::startLocal(std::shared_ptr<LocalChannel> channel) {
+	if (!client.connectLocal(channel)) return 1;
+
+	return startGame();
+}
+
+int HobbitClient::startGame() {
 	guids = getPlayersNpcGuid();
 
 	while (!hobbitGameManager.isGameRunning()) {
@@ -111,12 +120,18 @@ void HobbitClient::update() {
 			continue;
 		}
 
+		// Game memory read during the tick is fetched once per page
+		HobbitProcessAnalyzer* hobbitProcessAnalyzer = hobbitGameManager.getHobbitProcessAnalyzer();
+		hobbitProcessAnalyzer->beginTick();
+
 		readMessage();
 		for (int i = 0; i < MAX_PLAYERS; ++i)
 		{
 			connectedPlayers[i].processPlayer(client.getClientID());
 		}
 		writeMessage();
+
+		hobbitProcessAnalyzer->endTick();
 		std::this_thread::sleep_for(std::chrono::milliseconds(200));
 	}
 }
@@ -140,11 +155,16 @@ void HobbitClient::readMessage() {
 	// Read all Event Messages
 	while (client.eventMessagesSize() > 0) {
 		BaseMessage eventMessageOpt = client.frontEventMessage();
-		if (eventMessageOpt.message.size() > 0) {
+		if (eventMessageOpt.messageType == KEYFRAME_MESSAGE) {
+			applyKeyframe(eventMessageOpt.message);
+			client.popFrontEventMessage();
+		}
+		else if (eventMessageOpt.message.size() > 0) {
 			readGameMessage(eventMessageOpt.senderID, eventMessageOpt.message);
 			client.popFrontEventMessage();
 		}
 	}
+	applyKeyframeEnemies();
 	// Read all Snap Messages
 	std::map<uint8_t, BaseMessage> snapshotMessages = client.snapMessage();
 	for (auto& pair : snapshotMessages) {
@@ -153,6 +173,63 @@ void HobbitClient::readMessage() {
 	}
 
 }
+void HobbitClient::applyKeyframe(std::queue<uint8_t>& data) {
+	auto takeBlock = [&data](std::queue<uint8_t>& block) {
+		uint32_t size;
+		if (!popUint32(data, size) || data.size() < size)
+			return false;
+		for (uint32_t i = 0; i < size; ++i) {
+			block.push(data.front());
+			data.pop();
+		}
+		return true;
+	};
+
+	uint8_t snapshotCount = data.empty() ? 0 : data.front();
+	if (!data.empty()) data.pop();
+	for (int i = 0; i < snapshotCount && !data.empty(); ++i) {
+		uint8_t senderID = data.front();
+		data.pop();
+		std::queue<uint8_t> snapshot;
+		if (!takeBlock(snapshot))
+			break;
+		readGameMessage(senderID, snapshot);
+	}
+
+	uint8_t levelCount = data.empty() ? 0 : data.front();
+	if (!data.empty()) data.pop();
+	for (int i = 0; i < levelCount && !data.empty(); ++i) {
+		uint8_t level = data.front();
+		data.pop();
+		// A newer keyframe replaces the totals of an older one
+		keyframeEnemies[level] = std::queue<uint8_t>();
+		if (!takeBlock(keyframeEnemies[level]))
+			break;
+	}
+
+	std::queue<uint8_t> inventory;
+	if (takeBlock(inventory))
+		readGameMessage(0, inventory);
+
+	logOption_->LogMessage(LogLevel::Log_Info, "Applied room keyframe:", int(snapshotCount), "players,", int(levelCount), "levels");
+
+	// Totals for the level we are on go in now, in line with the events around them
+	applyKeyframeEnemies();
+}
+void HobbitClient::applyKeyframeEnemies() {
+	auto levelEnemies = keyframeEnemies.find(static_cast<uint8_t>(hobbitGameManager.getCurrentLevel()));
+	if (levelEnemies == keyframeEnemies.end())
+		return;
+
+	// Skip each record's label and size, the totals are not deltas for readGameMessage
+	std::queue<uint8_t>& records = levelEnemies->second;
+	while (records.size() >= 2) {
+		records.pop();
+		records.pop();
+		mainPlayer.readKeyframeEnemiesHealth(records);
+	}
+	keyframeEnemies.erase(levelEnemies);
+}
 void HobbitClient::writeMessage() {
 
 	std::vector<BaseMessage> messages;
@@ -242,6 +319,7 @@ void HobbitClient::onEnterNewLevel() {
 	std::this_thread::sleep_for(std::chrono::seconds(5));
 
 	hobbitGameManager.getHobbitProcessAnalyzer()->updateObjectStackAddress();
+	hobbitGameManager.getHobbitProcessAnalyzer()->invalidateObjectIndex();
 
 
 	if (guids.size() == 0)
@@ -279,7 +357,7 @@ void HobbitClient::onClientListUpdate(const std::queue<uint8_t>& clientIDs) {
 		}
 	}
 
-	//[missing] share the information of all, inventory
+	// Everything that happened before we joined arrives once in the room keyframe, see applyKeyframe()
 }
 std::vector<uint64_t> HobbitClient::getPlayersNpcGuid() {
 	std::ifstream file;
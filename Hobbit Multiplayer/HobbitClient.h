@@ -40,9 +40,13 @@ public:
 
 	int start();
 	int start(const std::string& ip);
+	// Joins a server running in this process ("Server & Client" mode)
+	int startLocal(std::shared_ptr<LocalChannel> channel);
 	void stop();
 
 	bool isRunning() { return running; }
+	// Send snapshots straight to other players over UDP, set before start()
+	void setSnapshotMesh(bool enable) { client.enableMesh(enable); }
 	// Add these methods
 	std::map<DataLabel, bool> getMessageLabelStates() const;
 	void setMessageLabelProcessing(DataLabel label, bool enable);
@@ -67,16 +71,24 @@ private:
 	ConnectedPlayer connectedPlayers[MAX_PLAYERS];
 	MainPlayer mainPlayer;
 
+	// Enemy totals from the last keyframe, applied when we get on that level
+	std::map<uint8_t, std::queue<uint8_t>> keyframeEnemies;
+
+	int startGame();
 	void update();
 	void readMessage();
 	void readGameMessage(int senderID, std::queue<uint8_t>& gameData);
+	void applyKeyframe(std::queue<uint8_t>& data);
+	void applyKeyframeEnemies();
 	void writeMessage();
 
 	void onEnterNewLevel();
 	void onExitLevel() { processMessages = false; }
 
 	void onOpenGame();
-	void onCloseGame() { processMessages = false; stop(); }
+	// Runs on the game manager's thread, which stop() joins; the thread that
+	// started the client sees running drop and stops it
+	void onCloseGame() { processMessages = false; running = false; }
 
 	void onClientListUpdate(const std::queue<uint8_t>&);
 
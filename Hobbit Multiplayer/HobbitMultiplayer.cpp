@@ -99,8 +99,9 @@ void HobbitMultiplayer::startServerClient()
 	server.start();
 	logOption_->LogMessage(LogLevel::Log_Info, "Server Started");
 
+	// The host's own client talks to the server in-process; the LAN address is only what other players see
 	string myIp = getLocalIPv4Address();
-	if (hobbitClient.start(myIp))
+	if (hobbitClient.startLocal(server.attachLocalClient(myIp)))
 		return;
 	logOption_->LogMessage(LogLevel::Log_Info, "Client Started");
 
@@ -32,6 +32,7 @@ public:
 
 	std::map<DataLabel, bool> getMessageLabelStates() const;
 	void setMessageLabelProcessing(DataLabel label, bool enable);
+	void setSnapshotMesh(bool enable) { hobbitClient.setSnapshotMesh(enable); }
 
 	LogOption::Ptr logOption_;
 	Server server;
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <cstring>
 #include <queue>
+#include <array>
 #include <vector>
 #include <vector>
 #include <cstdint>
@@ -20,13 +21,13 @@
 #include <limits>  // for std::numeric_limits
 #include "Utility.h"
 #include "../ServerClient/Client.h"
+#include "../ServerClient/InventoryCounters.h"
 #include "../HobbitGameManager/HobbitGameManager.h"
 #include "../HobbitGameManager/NPC.h"
+#include "../HobbitGameManager/PointerPaths.h"
+#include "../HobbitGameManager/MemoryWatcher.h"
 #include "../LogSystem/LogManager.h"
 
-#define ptrInventory 0x0075BDB0
-#define ptrLevel 0x0075BDB0
-
 #define EVENT_EYSN TRUE
 class MainPlayer {
 
@@ -47,17 +48,56 @@ class MainPlayer {
 
 	int8_t bilboWeapon;
 
-	const uint32_t X_POSITION_PTR = 0x0075BA3C;
+	// Chains from the player pointer, guarded by the pointer itself. The
+	// animation object can be replaced while the player object stays; the
+	// cache sees that in its hops, so a level entry only walks what moved.
+	static const size_t PLAYER_OBJECT_PATH = 0;
+	static const size_t PLAYER_ANIMATION_PATH = 1;
+	static const PointerPaths& playerPaths()
+	{
+		static const PointerPaths paths = []
+			{
+				PointerPaths declared;
+				declared.add({ 0x0 });
+				declared.add({ 0x0, 0x560 }, 0x8);
+				return declared;
+			}();
+		return paths;
+	}
+	PointerCache playerPointers{ playerPaths(), 0x0, sizeof(uint32_t) };
+
+	static const uint8_t INVENTORY_SLOTS = 56;
+	using InventorySlots = std::array<float, INVENTORY_SLOTS>;
 
 	std::vector<std::pair<uint32_t, float>> enemies; //address and health
+	// Health changes of the other players written to the enemies of this level,
+	// per GUID; a keyframe's totals are applied minus this
+	std::map<uint64_t, float> appliedRemoteEnemies;
 	std::vector<std::pair<uint8_t, float>> inventory;
 
+	// Inventory is synced as PN-counters; appliedRemoteInventory is the part of
+	// the other replicas' sum already written to the game, per slot
+	InventoryCounters inventoryCounters;
+	std::map<uint8_t, float> appliedRemoteInventory;
+	const uint64_t replicaID = InventoryCounters::newReplicaID();
+
+	// The slots are watched; writeInventoryEvent only diffs them when they changed
+	MemoryWatcher inventoryWatcher;
+	InventorySlots polledInventory{};
+	bool inventoryChanged = false;
+
 	std::atomic<bool> processPackets;
 
 	LogOption::Ptr logOption_;
 public:
 	MainPlayer() : logOption_(LogManager::Instance().CreateLogOption("MAIN PLAYER"))
 	{
+		inventoryWatcher.watch<InventorySlots>(GameAddress::Inventory, std::chrono::milliseconds(0),
+			[this](const InventorySlots&, const InventorySlots& slots)
+			{
+				polledInventory = slots;
+				inventoryChanged = true;
+			});
 	}
 	void setHobbitProcessAnalyzer(HobbitGameManager& initialHobbitGameManager)
 	{
@@ -89,107 +129,140 @@ public:
 
 	void readPtrs() {
 
-		//Biblbo Pointers
-		bilboPosXPTR = hobbitProcessAnalyzer->readData<uint32_t>(X_POSITION_PTR);
-		bilboAnimPTR = 0x8 + hobbitProcessAnalyzer->readData<uint32_t>(0x560 + hobbitProcessAnalyzer->readData<uint32_t>(X_POSITION_PTR));
+		//Biblbo Pointers; walked again only if a pointer on the way changed
+		const std::vector<uint32_t>& bilboPtrs = playerPointers.get(*hobbitProcessAnalyzer, hobbitProcessAnalyzer->getAddress(GameAddress::PlayerPtr));
+		bilboPosXPTR = bilboPtrs[PLAYER_OBJECT_PATH];
+		bilboAnimPTR = bilboPtrs[PLAYER_ANIMATION_PATH];
 
 		//Enemies 
 		enemies.clear();
+		appliedRemoteEnemies.clear();
 		logOption_->LogMessage(LogLevel::Log_Debug, "List Enemies");
 		logOption_->increaseDepth();
 		std::vector<uint32_t> allEnemieAddrs = hobbitProcessAnalyzer->findAllGameObjByPattern<uint64_t>(0x0000000200000002, 0x184 + 0x8 * 0x4); //put the values that indicate that thing
 
-		for (uint32_t e : allEnemieAddrs)
+		// type, GUID and health of every candidate in one batch
+		struct EnemyReads
+		{
+			uint32_t type = 0;
+			uint32_t guid = 0;
+			float health = 0;
+		};
+		std::vector<EnemyReads> enemyReads(allEnemieAddrs.size());
+		ReadBatch batch;
+		for (size_t i = 0; i < allEnemieAddrs.size(); i++)
 		{
-			if (0x04004232 != hobbitProcessAnalyzer->readData<uint32_t>(e + 0x10))
+			batch.add(allEnemieAddrs[i] + 0x10, enemyReads[i].type);
+			batch.add(allEnemieAddrs[i] + 0x8, enemyReads[i].guid);
+			batch.add(allEnemieAddrs[i] + 0x290, enemyReads[i].health);
+		}
+		hobbitProcessAnalyzer->readBatch(batch);
+
+		for (size_t i = 0; i < allEnemieAddrs.size(); i++)
+		{
+			uint32_t e = allEnemieAddrs[i];
+			if (0x04004232 != enemyReads[i].type)
 				continue;
-			if (0xABCABCABCABCABC0 == hobbitProcessAnalyzer->readData<uint32_t>(e + 0x8))
+			if (0xABCABCABCABCABC0 == enemyReads[i].guid)
 				logOption_->LogMessage(LogLevel::Log_Error, "YOU ARE SETTING BILBO AS ENEMY NPC!!!");
 
 			//hex
-			logOption_->LogMessage(LogLevel::Log_Debug, "Address:", e, "Health: ", hobbitProcessAnalyzer->readData<float>(e + 0x290));
-			enemies.push_back(std::make_pair(e, hobbitProcessAnalyzer->readData<float>(e + 0x290))); // address and health
+			logOption_->LogMessage(LogLevel::Log_Debug, "Address:", e, "Health: ", enemyReads[i].health);
+			enemies.push_back(std::make_pair(e, enemyReads[i].health)); // address and health
 		}
 		logOption_->decreaseDepth();
 		logOption_->LogMessage(LogLevel::Log_Debug, "Enemis Foud:", enemies.size());
 
 		//Items
+		inventory.clear();
 		logOption_->LogMessage(LogLevel::Log_Debug, "List Items");
 		logOption_->increaseDepth();
-		for (uint8_t item = 0; item < 56; item++)
+		InventorySlots slots = readInventory();
+		for (uint8_t item = 0; item < INVENTORY_SLOTS; item++)
 		{
-			logOption_->LogMessage(LogLevel::Log_Debug, "Address:", ptrInventory + 0x4 * item, "Value: ", hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * item));
-			inventory.push_back(std::make_pair(item, hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * item)));
+			logOption_->LogMessage(LogLevel::Log_Debug, "Address:", inventoryAddress() + 0x4 * item, "Value: ", slots[item]);
+			inventory.push_back(std::make_pair(item, slots[item]));
 		}
 		logOption_->decreaseDepth();
 	}
 	void readProcessInventory(std::queue<uint8_t>& gameData)
 	{
-		uint32_t numberChangeInventory = convertQueueToType<uint32_t>(gameData);
-		std::queue<std::pair<uint8_t, float>> readInventory;
-		for (int i = 0; i < numberChangeInventory; i++)
+		uint32_t numberCounters = convertQueueToType<uint32_t>(gameData);
+		std::vector<uint8_t> grownSlots;
+		for (uint32_t i = 0; i < numberCounters; i++)
 		{
-			uint8_t item = convertQueueToType<uint8_t>(gameData);
-			float value = convertQueueToType<float>(gameData);
-			readInventory.push(std::pair(item, value));
+			InventoryCounterEntry entry;
+			entry.slot = convertQueueToType<uint8_t>(gameData);
+			entry.replicaID = convertQueueToType<uint64_t>(gameData);
+			entry.increments = convertQueueToType<float>(gameData);
+			entry.decrements = convertQueueToType<float>(gameData);
+			if (inventoryCounters.merge(entry))
+				grownSlots.push_back(entry.slot);
 		}
 
-		while (!readInventory.empty())
+		for (uint8_t slot : grownSlots)
+			applyRemoteInventory(slot);
+	}
+	void readProcessEnemiesHealth(std::queue<uint8_t>& gameData) {
+
+		uint32_t numberHurtEnemies = convertQueueToType<uint32_t>(gameData);
+		for (int i = 0; i < numberHurtEnemies; ++i)
 		{
-			logOption_->LogMessage(LogLevel::Log_Debug, "Inventory Changed");
-			logOption_->increaseDepth();
-			logOption_->LogMessage(LogLevel::Log_Debug, "GUID:", readInventory.front().first * 0x4 + ptrInventory, "New Value:", readInventory.front().second);
-			logOption_->decreaseDepth();
+			uint64_t guid = convertQueueToType<uint64_t>(gameData);
+			float healthChange = convertQueueToType<float>(gameData);
 
-			float value = hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * readInventory.front().first);
-			inventory.at(readInventory.front().first).second += readInventory.front().second;
-			if (inventory.at(readInventory.front().first).second < 0)
-				inventory.at(readInventory.front().first).second = 0;
-			hobbitProcessAnalyzer->writeData<float>(ptrInventory + 0x4 * readInventory.front().first, inventory.at(readInventory.front().first).second);
-			readInventory.pop();
+			applyRemoteEnemyHealth(guid, healthChange);
 		}
-		logOption_->decreaseDepth();
 	}
-	void readProcessEnemiesHealth(std::queue<uint8_t>& gameData) {
+	// Same record as readProcessEnemiesHealth, but every entry is the total change
+	// by the other players since the level started; only the part not applied yet goes in
+	void readKeyframeEnemiesHealth(std::queue<uint8_t>& gameData) {
 
 		uint32_t numberHurtEnemies = convertQueueToType<uint32_t>(gameData);
 		for (int i = 0; i < numberHurtEnemies; ++i)
 		{
 			uint64_t guid = convertQueueToType<uint64_t>(gameData);
-			float healthChange = convertQueueToType<float>(gameData);
+			float totalChange = convertQueueToType<float>(gameData);
 
-			std::pair enemyNewHealth = std::make_pair(guid, healthChange);
+			float missing = totalChange - appliedRemoteEnemies[guid];
+			if (missing != 0)
+				applyRemoteEnemyHealth(guid, missing);
+		}
+	}
+	void applyRemoteEnemyHealth(uint64_t guid, float healthChange) {
 
-			// validate GUID
-			if (enemyNewHealth.first == 0)
-				continue;
+		std::pair enemyNewHealth = std::make_pair(guid, healthChange);
 
-			//Log the Changes
-			logOption_->LogMessage(LogLevel::Log_Debug, "Enemy Hurt");
-			logOption_->increaseDepth();
-			logOption_->LogMessage(LogLevel::Log_Debug, "GUID:", enemyNewHealth.first, "Dagame Deal:", enemyNewHealth.second);
-			logOption_->decreaseDepth();
+		// validate GUID
+		if (enemyNewHealth.first == 0)
+			return;
 
-			//find by guid
-			uint32_t objAddrs = hobbitProcessAnalyzer->findGameObjByGUID(enemyNewHealth.first);
+		//Log the Changes
+		logOption_->LogMessage(LogLevel::Log_Debug, "Enemy Hurt");
+		logOption_->increaseDepth();
+		logOption_->LogMessage(LogLevel::Log_Debug, "GUID:", enemyNewHealth.first, "Dagame Deal:", enemyNewHealth.second);
+		logOption_->decreaseDepth();
+
+		//find by guid
+		uint32_t objAddrs = hobbitProcessAnalyzer->findGameObjByGUID(enemyNewHealth.first);
+
+		//check if found object by address
+		if (objAddrs != 0)
+		{
+			// read current health of enemy
+			float health = hobbitProcessAnalyzer->readData<float>(objAddrs + 0x290);
 
-			//check if found object by address
-			if (objAddrs != 0)
-			{
-				// read current health of enemy
-				float health = hobbitProcessAnalyzer->readData<float>(objAddrs + 0x290);
 
+			for (auto& e : enemies)
+			{
+				uint64_t guidEnemy = hobbitProcessAnalyzer->readData<uint64_t>(e.first + 0x8);
 
-				for (auto& e : enemies)
+				if (guidEnemy == enemyNewHealth.first)
 				{
-					uint64_t guidEnemy = hobbitProcessAnalyzer->readData<uint64_t>(e.first + 0x8);
-
-					if (guidEnemy == enemyNewHealth.first)
-					{
-						e.second = health + enemyNewHealth.second;
-						hobbitProcessAnalyzer->writeData<float>(e.first + 0x290, e.second);
-						break;
-					}
+					e.second = health + enemyNewHealth.second;
+					hobbitProcessAnalyzer->writeData<float>(e.first + 0x290, e.second);
+					appliedRemoteEnemies[guid] += healthChange;
+					break;
 				}
 			}
 		}
@@ -247,26 +320,27 @@ private:
 	{
 		logOption_->setColor("GREEN");
 		//sending the following message:
-		//label - Snap, 0 - reserve for size
-		//number of enemies
-		//GUID of enemy, health change
+		//ENEMIES_HEALTH records with the GUID and health change of every hurt enemy
 
 		if (!EVENT_EYSN)
 			return BaseMessage(); // if not enabled return empty message
-		BaseMessage msg(EVENT_MESSAGE, 0);
-		std::vector<uint8_t> dataVec = { static_cast<uint8_t>(DataLabel::ENEMIES_HEALTH), 0 }; // label - Snap, 0 - reserve for size
+		std::vector<EnemyHealthChange> hurtEnemies;
 
+		// current health and GUID of every enemy in one batch
+		std::vector<std::pair<float, uint64_t>> enemyReads(enemies.size());
+		ReadBatch batch;
+		for (size_t i = 0; i < enemies.size(); i++)
+		{
+			batch.add(enemies[i].first + 0x290, enemyReads[i].first);
+			batch.add(enemies[i].first + 0x8, enemyReads[i].second);
+		}
+		hobbitProcessAnalyzer->readBatch(batch);
 
-		// amount of enemies send
-		uint32_t enemisSend = 0;
-		pushTypeToVector(enemisSend, dataVec);
-
-		dataVec[1] += sizeof(uint32_t);
-
-		for (auto& e : enemies)
+		for (size_t i = 0; i < enemies.size(); i++)
 		{
+			auto& e = enemies[i];
 			// get current health of npc
-			float currentHealth = hobbitProcessAnalyzer->readData<float>(e.first + 0x290);
+			float currentHealth = enemyReads[i].first;
 			//if (currentHealth < 0)
 			//{
 			//	e.second = 0;
@@ -275,43 +349,36 @@ private:
 			if (e.second != currentHealth)
 			{
 				//hex
-				logOption_->LogMessage(LogLevel::Log_Debug, "Write Enemy GUID", hobbitProcessAnalyzer->readData<uint64_t>(e.first + 0x8));
+				logOption_->LogMessage(LogLevel::Log_Debug, "Write Enemy GUID", enemyReads[i].second);
 				logOption_->increaseDepth();
 				logOption_->LogMessage(LogLevel::Log_Debug, "Heath: Before", e.second, "After", currentHealth);
 				logOption_->decreaseDepth();
 
 
-				//GUID
-				pushTypeToVector(hobbitProcessAnalyzer->readData<uint64_t>(e.first + 0x8), dataVec);
-				dataVec[1] += sizeof(uint64_t);
-
-				//Heath change
-				pushTypeToVector(currentHealth - e.second, dataVec);
-				dataVec[1] += sizeof(float);
+				//GUID, Heath change
+				hurtEnemies.push_back({ enemyReads[i].second, currentHealth - e.second });
 
 				e.second = currentHealth;
-				++enemisSend;
 			}
 		}
 
-		dataVec[2] = enemisSend;//set enemies send
-
-		// Convert vector to queue
-		for (const int& element : dataVec) {
-			msg.message.push(element);
-		}
-		if (enemisSend > 0)
-		{
-			logOption_->LogMessage(LogLevel::Log_Debug, "Sending: Enemies sent", enemisSend);
-			logOption_->resetColor();
-			return msg;
-		}
-		else
+		if (hurtEnemies.empty())
 		{
 			logOption_->resetColor();
 			return BaseMessage();
+		}
 
+		BaseMessage msg(EVENT_MESSAGE, 0);
+		std::vector<uint8_t> dataVec;
+		writeEnemiesHealthRecord(dataVec, hurtEnemies);
+
+		// Convert vector to queue
+		for (const uint8_t& element : dataVec) {
+			msg.message.push(element);
 		}
+		logOption_->LogMessage(LogLevel::Log_Debug, "Sending: Enemies sent", int(hurtEnemies.size()));
+		logOption_->resetColor();
+		return msg;
 	}
 	BaseMessage writeInventoryEvent()
 	{
@@ -319,67 +386,104 @@ private:
 		if (!EVENT_EYSN)
 			return BaseMessage(); // if not enabled return empty message
 
-		BaseMessage msg(EVENT_MESSAGE, 0);
-		std::vector<uint8_t> dataVec = { static_cast<uint8_t>(DataLabel::INVENTORY), 0 };
-
-		// amount of enemies send
-		uint32_t inventorySend = 0;
-		pushTypeToVector(inventorySend, dataVec);
-
-		dataVec[1] += sizeof(uint32_t);
-
-		for (uint8_t i = 0; i < 56; i++)
+		// Unchanged slots can't hold anything new: what wasn't shared last
+		// time still isn't (except a held-back slot 7, see below), and remote
+		// changes written to the game show up as a change
+		inventoryWatcher.poll(*hobbitProcessAnalyzer);
+		if (!inventoryChanged)
 		{
-			if (i > 1 and i < 6) i = 6;
-			else if (i > 7 and i < 20) i = 20;
-			else if (i > 22 and i < 25) i = 25;
-			else if (i > 25 and i < 28) i = 28;
-			else if (i == 46) i++;
-			else if (i == 50) i = 52;
-			if ((inventory[i].second != hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i) and i < 53) or (i >= 53 and inventory[i].second > hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i)))
-			{
-				if (i == 6 and inventory[i].second > hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i))
-					continue;
-				if (i == 7 and inventory[25].second > hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * 25))
-					continue;
-				else if (i == 7 and inventory[i].second > hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i))
-					continue;
-				//hex
-				logOption_->LogMessage(LogLevel::Log_Debug, "Write Inventory Address", ptrInventory + 0x4 * i);
-				logOption_->increaseDepth();
-				logOption_->LogMessage(LogLevel::Log_Debug, "Value: Before", inventory[i].second, "After", hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i));
-				logOption_->decreaseDepth();
+			logOption_->resetColor();
+			return BaseMessage();
+		}
+		inventoryChanged = false;
 
-				//inventory[i].second = hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i);
-				//  
-				pushTypeToVector(i, dataVec);
-				dataVec[1] += sizeof(uint8_t);
+		// Own changes grow our counters; only the counters of changed slots are sent
+		std::vector<InventoryCounterEntry> changedCounters;
+		const InventorySlots& slots = polledInventory;
+		for (uint8_t i = 0; i < INVENTORY_SLOTS; i++)
+		{
+			float currentValue = slots[i];
+			if (!isSharedInventoryChange(i, slots))
+				continue;
 
+			//hex
+			logOption_->LogMessage(LogLevel::Log_Debug, "Write Inventory Address", inventoryAddress() + 0x4 * i);
+			logOption_->increaseDepth();
+			logOption_->LogMessage(LogLevel::Log_Debug, "Value: Before", inventory[i].second, "After", currentValue);
+			logOption_->decreaseDepth();
 
-				//
-				pushTypeToVector(hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i) - inventory[i].second, dataVec);
-				inventory[i].second = hobbitProcessAnalyzer->readData<float>(ptrInventory + 0x4 * i);
-				dataVec[1] += sizeof(float);
+			inventoryCounters.add(replicaID, i, currentValue - inventory[i].second);
+			inventory[i].second = currentValue;
+			changedCounters.push_back(inventoryCounters.entry(i, replicaID));
+		}
+		// A slot-7 gain held back while slot 25 dropped goes out once slot 25's
+		// new value is the baseline, which this pass just set: diff again next
+		// time even if nothing else changes
+		inventoryChanged = slots[7] > inventory[7].second;
 
-				++inventorySend;
-			}
+		if (changedCounters.empty())
+		{
+			logOption_->resetColor();
+			return BaseMessage();
 		}
 
-		dataVec[2] = inventorySend;//set enemies send
+		BaseMessage msg(EVENT_MESSAGE, 0);
+		std::vector<uint8_t> dataVec;
+		writeInventoryRecord(dataVec, changedCounters);
 
 		// Convert vector to queue
-		for (const int& element : dataVec) {
+		for (const uint8_t& element : dataVec) {
 			msg.message.push(element);
 		}
-		if (inventorySend > 0)
-		{
-			logOption_->LogMessage(LogLevel::Log_Debug, "Sending: Items sent", int(inventorySend));
-			logOption_->resetColor();
-			return msg;
-		}
-		else
-			logOption_->resetColor();
-		return BaseMessage();
+		logOption_->LogMessage(LogLevel::Log_Debug, "Sending: Items sent", int(changedCounters.size()));
+		logOption_->resetColor();
+		return msg;
+	}
+	// Slots the game uses for things that aren't shared are never synced, and
+	// some slots only share gains or only share losses
+	static bool isSharedInventorySlot(uint8_t slot)
+	{
+		return !((slot > 1 && slot < 6) || (slot > 7 && slot < 20) || (slot > 22 && slot < 25) ||
+			(slot > 25 && slot < 28) || slot == 46 || slot == 50 || slot == 51);
+	}
+	bool isSharedInventoryChange(uint8_t slot, const InventorySlots& slots)
+	{
+		if (!isSharedInventorySlot(slot))
+			return false;
+
+		float currentValue = slots[slot];
+		float lastValue = inventory[slot].second;
+		if (lastValue == currentValue)
+			return false;
+		if (slot >= 53)
+			return lastValue > currentValue;
+		if (slot == 6)
+			return lastValue < currentValue;
+		if (slot == 7)
+			return lastValue < currentValue && inventory[25].second <= slots[25];
+		return true;
+	}
+	void applyRemoteInventory(uint8_t slot)
+	{
+		float remoteValue = inventoryCounters.valueExcept(slot, replicaID);
+		float change = remoteValue - appliedRemoteInventory[slot];
+		if (change == 0 || slot >= inventory.size())
+			return;
+		appliedRemoteInventory[slot] = remoteValue;
+
+		logOption_->LogMessage(LogLevel::Log_Debug, "Inventory Changed");
+		logOption_->increaseDepth();
+		logOption_->LogMessage(LogLevel::Log_Debug, "Address:", slot * 0x4 + inventoryAddress(), "Change:", change);
+		logOption_->decreaseDepth();
+
+		// Applied on top of the game value, so local changes that were not shared stay
+		float value = hobbitProcessAnalyzer->readData<float>(inventoryAddress() + 0x4 * slot) + change;
+		if (value < 0)
+			value = 0;
+		// The baseline is clamped the same way, or the clamp would read as a change of our own next poll
+		float baseline = inventory.at(slot).second + change;
+		inventory.at(slot).second = baseline < 0 ? 0 : baseline;
+		hobbitProcessAnalyzer->writeData<float>(inventoryAddress() + 0x4 * slot, value);
 	}
 	BaseMessage writeChangeLevelEvent()
 	{
@@ -395,17 +499,17 @@ private:
 
 		dataVec[1] += sizeof(uint32_t);
 
-		if (level != hobbitProcessAnalyzer->readData<float>(ptrLevel))
+		if (level != hobbitProcessAnalyzer->readData<float>(inventoryAddress()))
 		{
 			//hex
-			logOption_->LogMessage(LogLevel::Log_Debug, "Value: Before: ", level, "After: ", hobbitProcessAnalyzer->readData<float>(ptrLevel));
+			logOption_->LogMessage(LogLevel::Log_Debug, "Value: Before: ", level, "After: ", hobbitProcessAnalyzer->readData<float>(inventoryAddress()));
 			logOption_->decreaseDepth();
 
 			//push current level
 			pushTypeToVector(level, dataVec);
 			dataVec[1] += sizeof(uint32_t);
 
-			level = hobbitProcessAnalyzer->readData<float>(ptrLevel);
+			level = hobbitProcessAnalyzer->readData<float>(inventoryAddress());
 			//push next level
 			pushTypeToVector(level, dataVec);
 			dataVec[1] += sizeof(uint32_t);
@@ -419,21 +523,39 @@ private:
 		return BaseMessage();
 	}
 
+	uint32_t inventoryAddress() const
+	{
+		return hobbitProcessAnalyzer->getAddress(GameAddress::Inventory);
+	}
+	// All the slots are next to each other, so they come in one read
+	InventorySlots readInventory()
+	{
+		InventorySlots slots{};
+		ReadBatch batch;
+		batch.add(inventoryAddress(), slots);
+		hobbitProcessAnalyzer->readBatch(batch);
+		return slots;
+	}
+
 	void processData()
 	{
-		position.x = hobbitProcessAnalyzer->readData<float>(0x7C4 + bilboPosXPTR);
-		position.y = hobbitProcessAnalyzer->readData<float>(0x7C8 + bilboPosXPTR);
-		position.z = hobbitProcessAnalyzer->readData<float>(0x7CC + bilboPosXPTR);
-		rotation.y = hobbitProcessAnalyzer->readData<float>(0x7AC + bilboPosXPTR);
-		animation = hobbitProcessAnalyzer->readData<uint32_t>(bilboAnimPTR);
-		if (!(animation >= 0 && animation <= 200))
-			animation = 1;
+		// Everything the snapshot needs in one batch
+		ReadBatch batch;
+		batch.add(0x7C4 + bilboPosXPTR, position.x);
+		batch.add(0x7C8 + bilboPosXPTR, position.y);
+		batch.add(0x7CC + bilboPosXPTR, position.z);
+		batch.add(0x7AC + bilboPosXPTR, rotation.y);
+		batch.add(bilboAnimPTR, animation);
 
-		bilboAnimFrame = hobbitProcessAnalyzer->readData<float>(0x0075BA3C + 0x530);
-		bilboLastAnimFrame = hobbitProcessAnalyzer->readData<float>(0x0075BA3C + 0x53C);
+		batch.add(hobbitProcessAnalyzer->getAddress(GameAddress::PlayerPtr) + 0x530, bilboAnimFrame);
+		batch.add(hobbitProcessAnalyzer->getAddress(GameAddress::PlayerPtr) + 0x53C, bilboLastAnimFrame);
 
-		bilboWeapon = hobbitProcessAnalyzer->readData<int8_t>(0x0075C738);
+		batch.add(hobbitProcessAnalyzer->getAddress(GameAddress::Weapon), bilboWeapon);
 
-		nowLevel = hobbitProcessAnalyzer->readData<uint8_t>(0x00762B5C);
+		batch.add(hobbitProcessAnalyzer->getAddress(GameAddress::CurrentLevel), nowLevel);
+		hobbitProcessAnalyzer->readBatch(batch);
+
+		if (!(animation >= 0 && animation <= 200))
+			animation = 1;
 	}
-};
+};
\ No newline at end of file
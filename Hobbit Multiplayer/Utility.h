@@ -17,6 +17,7 @@
 #include <iomanip>
 
 #include "../ServerClient/Client.h"
+#include "../ServerClient/GameData.h"
 
 // Utility functions for handling serialization and deserialization
 template <typename T>
@@ -42,15 +43,6 @@ void pushTypeToVector(const T& value, std::vector<uint8_t>& myVector) {
 	myVector.insert(myVector.end(), bytes, bytes + sizeof(T));
 }
 
-// Enum for data labels
-enum class DataLabel {
-	SERVER = 0,
-	CONNECTED_PLAYER_SNAP = 1,
-	CONNECTED_PLAYER_LEVEL = 2,
-	ENEMIES_HEALTH = 3,
-	INVENTORY = 4
-};
-
 // Structs for message handling
 struct MessageBundle {
 	BaseMessage* textResponse = nullptr;
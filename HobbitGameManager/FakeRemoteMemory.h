@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <map>
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include "RemoteMemory.h"
+
+// Address space made of byte ranges mapped inside this process. Lets the
+// analyzer and the game-side code run without the game, e.g. in the memory
+// benchmark. Set it up with map() before sharing it between threads.
+class FakeRemoteMemory : public RemoteMemory
+{
+public:
+	// Maps size zeroed bytes at base; ranges must not overlap
+	void map(uint64_t base, size_t size, bool writable = true)
+	{
+		Range& range = ranges[base];
+		range.bytes.assign(size, 0);
+		range.writable = writable;
+	}
+	// Direct access for setting up state, nullptr if the address isn't mapped
+	uint8_t* data(uint64_t address)
+	{
+		return find(address, 1);
+	}
+	void setAlive(bool alive)
+	{
+		this->alive = alive;
+	}
+
+	bool read(uint64_t address, void* buffer, size_t size) override
+	{
+		uint8_t* bytes = find(address, size);
+		if (!bytes)
+			return fail();
+		std::memcpy(buffer, bytes, size);
+		return true;
+	}
+	bool write(uint64_t address, const void* data, size_t size) override
+	{
+		uint8_t* bytes = find(address, size);
+		if (!bytes)
+			return fail();
+		std::memcpy(bytes, data, size);
+		return true;
+	}
+
+	std::vector<MemoryRegion> regions() override
+	{
+		std::vector<MemoryRegion> found;
+		for (const auto& entry : ranges)
+		{
+			MemoryRegion region;
+			region.base = entry.first;
+			region.size = entry.second.bytes.size();
+			region.writable = entry.second.writable;
+			found.push_back(region);
+		}
+		return found;
+	}
+	bool isAlive() override
+	{
+		return alive;
+	}
+
+	int lastError() const override
+	{
+		return lastErrno;
+	}
+	const char* name() const override
+	{
+		return "fake";
+	}
+
+private:
+	struct Range
+	{
+		std::vector<uint8_t> bytes;
+		bool writable = true;
+	};
+	std::map<uint64_t, Range> ranges;
+	bool alive = true;
+	std::atomic<int> lastErrno{ 0 };
+
+	// Local copy of [address, address + size), or nullptr unless one range holds all of it
+	uint8_t* find(uint64_t address, size_t size)
+	{
+		auto it = ranges.upper_bound(address);
+		if (it == ranges.begin())
+			return nullptr;
+		--it;
+		if (address + size > it->first + it->second.bytes.size())
+			return nullptr;
+		return it->second.bytes.data() + (address - it->first);
+	}
+	bool fail()
+	{
+		lastErrno = EFAULT;
+		return false;
+	}
+};
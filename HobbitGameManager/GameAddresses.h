@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed addresses in Meridian.exe's data section. The constants are those of
+// the build the project was written against; in other builds they are found
+// again by signature (see SignatureDatabase), and these are the fallback.
+enum class GameAddress
+{
+	PlayerPtr,          // Bilbo's object
+	Weapon,
+	Inventory,          // 56 float slots
+	GameState,
+	CurrentLevel,
+	LevelLoaded,
+	LevelLoading,
+	LevelAssigned,
+	ObjectStack,
+	ObjectStackSize,
+	Count
+};
+
+struct GameAddressInfo
+{
+	const char* name;   // as written in the signature file
+	uint32_t fallback;
+};
+
+inline const std::array<GameAddressInfo, static_cast<size_t>(GameAddress::Count)>& gameAddressTable()
+{
+	static const std::array<GameAddressInfo, static_cast<size_t>(GameAddress::Count)> table = { {
+		{ "PlayerPtr",       0x0075BA3C },
+		{ "Weapon",          0x0075C738 },
+		{ "Inventory",       0x0075BDB0 },
+		{ "GameState",       0x00762B58 },
+		{ "CurrentLevel",    0x00762B5C },
+		{ "LevelLoaded",     0x00760354 },
+		{ "LevelLoading",    0x0076035C },
+		{ "LevelAssigned",   0x007A59C8 },
+		{ "ObjectStack",     0x0076F648 },
+		{ "ObjectStackSize", 0x0076F660 },
+	} };
+	return table;
+}
@@ -9,6 +9,7 @@
 #include <future>
 #include <chrono>
 #include "HobbitProcessAnalyzer.h"
+#include "MemoryWatcher.h"
 #include "../LogSystem/LogManager.h"
 class HobbitGameManager
 {
@@ -21,6 +22,11 @@ public:
     {
         LogManager::Instance().MoveLogOption("HOBBIT PROC ANALYZ", "HOBBIT GAME MANAGER");
         LogManager::Instance().DisplayHierarchy();
+        watchLevelState();
+
+        // Whichever thread finds the game or sees it exit raises the event
+        hobitProcessAnalyzer.getAttachment().addListenerAttach([this] { eventOpenGame(); });
+        hobitProcessAnalyzer.getAttachment().addListenerDetach([this] { eventCloseGame(); });
     }
     ~HobbitGameManager()
     {
@@ -35,10 +41,7 @@ public:
             logOption_->LogMessage(LogLevel::Log_Prompt, "You must open the game!");
             std::this_thread::sleep_for(std::chrono::seconds(2)); // Sleep for 2 seconds
         }
-        
-        // Set proces and Stack Address
-        hobitProcessAnalyzer.updatePtrToProcess();
-        hobitProcessAnalyzer.updateObjectStackAddress();
+        // Finding the game raised eventOpenGame, which set the process and stack address
 
         // Start Update Thread
         stopThread = false; // Initialize stopThread to false
@@ -47,12 +50,17 @@ public:
     void stop()
     {
         stopThread = true;
-        if (updateThread.joinable())
+        // A listener of the update thread may stop the manager; that thread ends on its own
+        if (updateThread.joinable() && updateThread.get_id() != std::this_thread::get_id())
             updateThread.join();
     }
     bool isOnLevel()
     {
-        return   (!!hobitProcessAnalyzer.readData<bool>(0x007A59C8) && isLevelLoaded && !isLevelEnded);
+        return   (!!hobitProcessAnalyzer.readData<bool>(hobitProcessAnalyzer.getAddress(GameAddress::LevelAssigned)) && isLevelLoaded && !isLevelEnded);
+    }
+    uint32_t getCurrentLevel()
+    {
+        return currentLevel;
     }
     bool isGameRunning()
     {
@@ -82,6 +90,12 @@ public:
 private:
     HobbitProcessAnalyzer hobitProcessAnalyzer; // TO DO make this thread safe
 
+    // The flags that start and end levels are polled every tick, the game
+    // state less often; see watchLevelState
+    MemoryWatcher levelWatcher;
+    const std::chrono::milliseconds LEVEL_INTERVAL{ 10 };
+    const std::chrono::milliseconds GAME_STATE_INTERVAL{ 100 };
+
     std::thread updateThread;
     std::atomic<bool> stopThread;
 
@@ -95,6 +109,7 @@ private:
     void eventEnterNewLevel() {
         isLevelLoaded = true;
         hobitProcessAnalyzer.updateObjectStackAddress();
+        hobitProcessAnalyzer.invalidateObjectIndex();
         for (const auto& listener : listenersEnterNewLevel)
         {
             listener();
@@ -103,6 +118,7 @@ private:
     void eventExitLevel() {
         isLevelLoaded = false;
         hobitProcessAnalyzer.updateObjectStackAddress();
+        hobitProcessAnalyzer.invalidateObjectIndex();
         for (const auto& listener : listenersExitLevel)
         {
             listener();
@@ -114,6 +130,7 @@ private:
         isLevelLoaded = false;
         hobitProcessAnalyzer.updatePtrToProcess();
         hobitProcessAnalyzer.updateObjectStackAddress();
+        hobitProcessAnalyzer.invalidateObjectIndex();
         for (const auto& listener : listenersOpenGame)
         {
             listener();
@@ -125,6 +142,7 @@ private:
         isLevelLoaded = false;
         hobitProcessAnalyzer.updatePtrToProcess();
         hobitProcessAnalyzer.updateObjectStackAddress();
+        hobitProcessAnalyzer.invalidateObjectIndex();
         for (const auto& listener : listenersCloseGame)
         {
             listener();
@@ -132,18 +150,17 @@ private:
 
     }
 
-   
-    std::atomic<bool> wasHobbitOpen = false;
-    std::atomic<bool> isHobbitOpen = false;
 
+    // The current values start as the game's values read as zero, which is
+    // what the watches compare their first poll with
     std::atomic<uint32_t> previousState = -1;
-    std::atomic<uint32_t> currentState = -1;
+    std::atomic<uint32_t> currentState = 0;
 
     std::atomic<uint32_t> previousLevel = -1;
-    std::atomic<uint32_t> currentLevel = -1;
+    std::atomic<uint32_t> currentLevel = 0;
 
     std::atomic<bool> wasLevelEnded = false;
-    std::atomic<bool> isLevelEnded = false;
+    std::atomic<bool> isLevelEnded = true;
 
     std::atomic<bool> wasLevelLoading = false;
     std::atomic<bool> isLevelLoading = false;
@@ -151,36 +168,21 @@ private:
     std::atomic<bool> isLevelLoaded = false;
     std::atomic<bool> wasLevelLoaded = false;
 
+    std::atomic<bool> isLevelAssigned = false;
 
-    void updateGameState()
+
+    // The callbacks only keep the new values; updateLevelState works out the
+    // transitions after every poll
+    void watchLevelState()
     {
-        isHobbitOpen = hobitProcessAnalyzer.isGameRunning();
-        if (!isHobbitOpen)
-        {
-            if (isHobbitOpen != wasHobbitOpen)
-            {
-                eventCloseGame();
-            }
-            wasHobbitOpen = !!isHobbitOpen;
-            return;
-        }
-        if (wasHobbitOpen)
-        {
-            eventOpenGame();
-            wasHobbitOpen = !!isHobbitOpen;
-        }
+        levelWatcher.watch<uint32_t>(GameAddress::GameState, GAME_STATE_INTERVAL, [this](uint32_t, uint32_t state) { currentState = state; });
+        levelWatcher.watch<uint32_t>(GameAddress::CurrentLevel, LEVEL_INTERVAL, [this](uint32_t, uint32_t level) { currentLevel = level; });
+        levelWatcher.watch<uint8_t>(GameAddress::LevelLoaded, LEVEL_INTERVAL, [this](uint8_t, uint8_t loaded) { isLevelEnded = !loaded; });
+        levelWatcher.watch<uint8_t>(GameAddress::LevelLoading, LEVEL_INTERVAL, [this](uint8_t, uint8_t loading) { isLevelLoading = loading != 0; });
+        levelWatcher.watch<uint8_t>(GameAddress::LevelAssigned, LEVEL_INTERVAL, [this](uint8_t, uint8_t assigned) { isLevelAssigned = assigned != 0; });
     }
     void updateLevelState()
     {
-      
-
-        // read instances of game (current level, etc.)
-        currentState = hobitProcessAnalyzer.readData<uint32_t>(0x00762B58); // 0x00762B58: game state address
-        currentLevel = hobitProcessAnalyzer.readData<uint32_t>(0x00762B5C);  // 0x00762B5C: current level address
-        isLevelEnded = !hobitProcessAnalyzer.readData<bool>(0x00760354);  //0x00760354: is loaded level address
-        isLevelLoading = hobitProcessAnalyzer.readData<bool>(0x0076035C);  //0x0x0072F048: is loaded level address
-
-        bool isLevelAssigned = !!hobitProcessAnalyzer.readData<bool>(0x007A59C8);  //0x0x0072F048: is loaded level address
         isLevelLoaded = (isLevelAssigned && !isLevelLoading);
 
         if (wasLevelEnded != isLevelEnded && isLevelEnded)
@@ -199,15 +201,17 @@ private:
     {
         while (!stopThread)
         {
+            // Raises eventOpenGame / eventCloseGame; while the game is open
+            // this is only a check of its handle
             if (!isGameRunning())
             {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1000));
                 continue;
             }
-            updateGameState();
+            auto nextPoll = levelWatcher.poll(hobitProcessAnalyzer);
             updateLevelState();
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::this_thread::sleep_until((std::min)(nextPoll, std::chrono::steady_clock::now() + LEVEL_INTERVAL));
         }
     }
 };
\ No newline at end of file
@@ -1,27 +1,131 @@
 #pragma once
+#ifdef _MSC_VER
 #pragma warning(push)
 #pragma warning(disable : 4312)
 #pragma warning(disable : 4267)
+#endif
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <iomanip>
-#ifdef _WIN32
-#include <winsock2.h>   // Ensure winsock2.h is included before Windows.h
-#include <Windows.h>
-#endif
 #include<unordered_map>
 #include <iomanip>
 #include"ProcessAnalyzerTypeWrapped.h"
+#include "ReadBatch.h"
+#include "TickCache.h"
+#include "WriteBackCache.h"
+#include "GameAddresses.h"
+#include "SignatureDatabase.h"
+#include "ProcessAttachment.h"
 #include "../LogSystem/LogManager.h"
 class HobbitProcessAnalyzer : public ProcessAnalyzerTypeWrapped
 {
 public:
-	HobbitProcessAnalyzer() : logOption_(LogManager::Instance().CreateLogOption("HOBBIT PROC ANALYZ"))
+	HobbitProcessAnalyzer() : logOption_(LogManager::Instance().CreateLogOption("HOBBIT PROC ANALYZ")),
+		attachment([this] { return getProcess(PROCESS_NAME); })
 	{
 		LogManager::Instance().MoveLogOption("PROC ANALYZ WRAP", "HOBBIT PROC ANALYZ");
+		LogManager::Instance().MoveLogOption("SIGNATURES", "HOBBIT PROC ANALYZ");
+		for (size_t i = 0; i < addresses.size(); ++i)
+			addresses[i] = gameAddressTable()[i].fallback;
+		signatures.load(SIGNATURE_FILE);
 	}
+	// Points the analyzer at the game the attachment holds, or at nothing
+	// once it has exited
 	void updatePtrToProcess()
 	{
-		hobbitProcess = getProcess("Meridian.exe");
+		setRemoteMemory(attachment.getProcess());
+		if (currentProcess())
+			resolveAddresses();
+	}
+	// Points the analyzer at another backend, e.g. a FakeRemoteMemory without the game.
+	// Calls running in other threads finish on the backend they started with.
+	void setRemoteMemory(std::shared_ptr<RemoteMemory> process)
+	{
+		std::shared_ptr<TickCache> newTickCache = process ? std::make_shared<TickCache>(std::move(process)) : nullptr;
+		std::shared_ptr<WriteBackCache> newWriteCache = newTickCache ? std::make_shared<WriteBackCache>(newTickCache) : nullptr;
+		{
+			std::lock_guard<std::mutex> lock(processMutex);
+			tickCache = newTickCache;
+			writeCache = newWriteCache;
+			hobbitProcess = newWriteCache;
+		}
+		++processGeneration;
+		invalidateObjectIndex();
+	}
+	// Changes whenever the analyzer is pointed at a process, so what was read
+	// from an earlier one can be told apart
+	uint64_t getProcessGeneration() const
+	{
+		return processGeneration;
+	}
+	std::shared_ptr<RemoteMemory> getRemoteMemory() const
+	{
+		std::shared_ptr<TickCache> cache = currentTickCache();
+		return cache ? cache->getProcess() : nullptr;
+	}
+
+	// Where a static address is in the running build: found by signature, or
+	// the built-in constant
+	uint32_t getAddress(GameAddress id) const
+	{
+		return addresses[static_cast<size_t>(id)];
+	}
+	void loadSignatures(const std::string& path)
+	{
+		signatures.load(path);
+	}
+	// Finds the addresses again in the exe's image, or in the cache of an
+	// earlier launch of the same build. Without signatures, or where one
+	// doesn't resolve, the built-in constant stays.
+	void resolveAddresses()
+	{
+		SignatureDatabase::Addresses found;
+		std::shared_ptr<RemoteMemory> process = getRemoteMemory();
+		if (process && !signatures.empty())
+			signatures.resolve(*process, MODULE_BASE, found);
+
+		const auto& table = gameAddressTable();
+		for (size_t i = 0; i < table.size(); ++i)
+		{
+			auto resolved = found.find(table[i].name);
+			uint32_t address = resolved != found.end() && resolved->second != 0 ? resolved->second : table[i].fallback;
+			if (address != table[i].fallback)
+				logOption_->LogMessage(LogLevel::Log_Info, table[i].name, "is at", address, "instead of", table[i].fallback);
+			addresses[i] = address;
+		}
+	}
+
+	// Between these, every page is read from the game once and then served
+	// from a copy, and writes are held back and written together at the end
+	void beginTick()
+	{
+		if (std::shared_ptr<TickCache> cache = currentTickCache())
+			cache->beginTick();
+		if (std::shared_ptr<WriteBackCache> cache = currentWriteCache())
+			cache->beginTick();
+	}
+	void endTick()
+	{
+		// Pages first: the flush compares spans with the game, not with this tick's copies
+		if (std::shared_ptr<TickCache> cache = currentTickCache())
+			cache->endTick();
+		if (std::shared_ptr<WriteBackCache> cache = currentWriteCache())
+		{
+			size_t failed = cache->flush();
+			if (failed > 0)
+				logOption_->LogMessage(LogLevel::Log_Error, "Could not write memory:", failed, "buffered writes failed", cache->lastError());
+		}
+	}
+	TickCache::Stats getTickCacheStats()
+	{
+		std::shared_ptr<TickCache> cache = currentTickCache();
+		return cache ? cache->getStats() : TickCache::Stats();
+	}
+	WriteBackCache::Stats getWriteCacheStats()
+	{
+		std::shared_ptr<WriteBackCache> cache = currentWriteCache();
+		return cache ? cache->getStats() : WriteBackCache::Stats();
 	}
 
 	using ProcessAnalyzerTypeWrapped::readData;
@@ -29,113 +133,154 @@ public:
 	using ProcessAnalyzerTypeWrapped::searchProcessMemory;
 
 	bool isProcessSet() {
-		if (hobbitProcess == nullptr)
-			logOption_->LogMessage(LogLevel::Log_Error, "ERROR: Hobbit Process is NOT set");
-
-		return (hobbitProcess != nullptr);
+		return isProcessSet(currentProcess());
 	}
+	// Looks for the game only while it isn't attached; once it is, this
+	// only asks its handle whether it has exited
 	bool isGameRunning()
 	{
-		return  getProcess("Meridian.exe") != nullptr;
+		return attachment.update();
+	}
+	ProcessAttachment& getAttachment()
+	{
+		return attachment;
 	}
 
 	template <typename T>
 	std::vector<uint32_t> searchProcessMemory(T pattern)
 	{
-		return ProcessAnalyzerTypeWrapped::searchProcessMemory(hobbitProcess, convertToUint8Vector(pattern));
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		return ProcessAnalyzerTypeWrapped::searchProcessMemory(process.get(), convertToUint8Vector(pattern));
 	}
 	template <typename T>
 	std::vector<uint32_t> searchProcessMemory(const std::vector<T>& pattern)
 	{
-		return ProcessAnalyzerTypeWrapped::searchProcessMemory(hobbitProcess, convertToUint8Vector(pattern));
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		return ProcessAnalyzerTypeWrapped::searchProcessMemory(process.get(), convertToUint8Vector(pattern));
 	}
 
 	template <typename T>
 	T readData(uint32_t address)
 	{
-		if (!isProcessSet()) return 0;
-		return convertToType<T>(ProcessAnalyzer::readData(hobbitProcess, (LPVOID)address, sizeof(T)));
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return 0;
+		return convertToType<T>(ProcessAnalyzer::readData(process.get(), address, sizeof(T)));
 	}
 	template <typename T>
 	std::vector<T> readData(uint32_t address, size_t byesSize)
 	{
-		if (!isProcessSet()) return std::vector<T>(byesSize);
-		return ProcessAnalyzerTypeWrapped::readData(hobbitProcess, (LPVOID)address, byesSize);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return std::vector<T>(byesSize);
+		return ProcessAnalyzerTypeWrapped::readData(process.get(), address, byesSize);
+	}
+
+	// Reads the whole batch at once. Like readData, what can't be read is zeroed.
+	bool readBatch(ReadBatch& batch)
+	{
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		std::vector<ReadRequest>& requests = batch.getRequests();
+		if (requests.empty()) return true;
+
+		size_t succeeded = 0;
+		if (isProcessSet(process))
+			succeeded = process->readBatch(requests.data(), requests.size());
+		else
+			for (ReadRequest& request : requests) request.ok = false;
+		if (succeeded == requests.size()) return true;
+
+		for (ReadRequest& request : requests)
+		{
+			if (!request.ok)
+				std::memset(request.buffer, 0, request.size);
+		}
+		if (process)
+			logOption_->LogMessage(LogLevel::Log_Error, "Could not read memory:", requests.size() - succeeded, "of", requests.size(), "batched reads failed", process->lastError());
+		return false;
 	}
 
-	
 	template <typename T>
 	void writeData(uint32_t address, T data)
 	{
-		if (!isProcessSet()) return;
-		ProcessAnalyzerTypeWrapped::writeData(hobbitProcess, (LPVOID)address, data);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return;
+		ProcessAnalyzerTypeWrapped::writeData(process.get(), address, data);
 	}
 	template <typename T>
 	void writeData(uint32_t address, std::vector<T> data)
 	{
-		if (!isProcessSet()) return;
-		ProcessAnalyzerTypeWrapped::writeData(hobbitProcess, (LPVOID)address, data);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return;
+		ProcessAnalyzerTypeWrapped::writeData(process.get(), address, data);
 	}
 
 
 	void updateObjectStackAddress()
 	{
+		std::shared_ptr<RemoteMemory> process = currentProcess();
 		try {
 			std::lock_guard<std::mutex> lock(objectStackMutex);
-			objectStackAddress = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(0x0076F648));
-			objectStackSize = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(0x0076F660));
-
+			uint32_t previousAddress = objectStackAddress;
+			uint32_t previousSize = objectStackSize;
+			objectStackAddress = readData<uint32_t>(process.get(), getAddress(GameAddress::ObjectStack));
+			objectStackSize = readData<uint32_t>(process.get(), getAddress(GameAddress::ObjectStackSize));
+			if (objectStackAddress != previousAddress || objectStackSize != previousSize)
+				objectIndexValid = false;
+
+			// Stack walks read every entry, so the whole stack comes in one call
+			if (std::shared_ptr<TickCache> cache = currentTickCache())
+			{
+				MemoryRegion stack;
+				stack.base = objectStackAddress;
+				stack.size = objectStackSize * OBJECT_PTR_SIZE;
+				bool plausible = stack.size > 0 && stack.size <= MAX_STACK_SIZE;
+				cache->setHotRegions(plausible ? std::vector<MemoryRegion>{ stack } : std::vector<MemoryRegion>());
+			}
 		}
 		catch (const std::runtime_error& e) {
 			std::lock_guard<std::mutex> lock(objectStackMutex);
 			objectStackAddress = 0;
 			objectStackSize = 0;
-			logOption_->LogMessage(LogLevel::Log_Warning, "Failed to read Object Stack Address from memory address 0x0076F648. Exception", e.what());
+			objectIndexValid = false;
+			logOption_->LogMessage(LogLevel::Log_Warning, "Failed to read Object Stack Address from memory address", getAddress(GameAddress::ObjectStack), "Exception", e.what());
 		}
 	}
+	// Objects can come and go on level events without the stack moving; the
+	// next GUID lookup then reads the stack again
+	void invalidateObjectIndex()
+	{
+		std::lock_guard<std::mutex> lock(objectStackMutex);
+		objectIndexValid = false;
+	}
+	uint64_t getObjectIndexRebuilds()
+	{
+		std::lock_guard<std::mutex> lock(objectStackMutex);
+		return objectIndexRebuilds;
+	}
 
 	uint32_t findGameObjByGUID(uint64_t guid)
 	{
-		if (!isProcessSet()) return 0;
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return 0;
 
 		std::lock_guard<std::mutex> lock(objectStackMutex);
 
-		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE){
-			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
-			if (objAddrs != 0)
-			{
-				uint32_t guidAddrs = objAddrs + 0x8;
-				uint64_t objGUID = readData<uint64_t>(hobbitProcess, reinterpret_cast<LPVOID>(guidAddrs));
-				if (objGUID == guid)
-				{
-					return objAddrs;
-				}
-			}
-		}
+		const GameObjectEntry* entry = findIndexedObject(guid);
+		if (entry)
+			return entry->objectAddress;
 		//hex
 		logOption_->LogMessage(LogLevel::Log_Warning, "Couldn't find", guid, " GUID in the Game Object Stack");
 		return 0;
 	}
 	uint32_t findGameObjStackByPtrGUID(uint64_t guid)
 	{
-		if (!isProcessSet()) return 0;
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return 0;
 
 		std::lock_guard<std::mutex> lock(objectStackMutex);
 
-		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE) {
-			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
-			if (objAddrs != 0)
-			{
-				uint32_t guidAddrs = objAddrs + 0x8;
-				uint64_t objGUID = readData<uint64_t>(hobbitProcess, reinterpret_cast<LPVOID>(guidAddrs));
-				if (objGUID == guid)
-				{
-					return objStackAddress;
-				}
-			}
-		}
+		const GameObjectEntry* entry = findIndexedObject(guid);
+		if (entry)
+			return entry->stackAddress;
 		//hex
 		logOption_->LogMessage(LogLevel::Log_Warning, "Couldn't find", guid, " GUID in the Game Object Stack");
 		return 0;
@@ -144,17 +289,18 @@ public:
 	template <typename T>
 	uint32_t findGameObjByPattern(T pattern, uint32_t shift)
 	{
-		if (!isProcessSet()) return 0;
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return 0;
 
 		std::lock_guard<std::mutex> lock(objectStackMutex);
 
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE) {
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				uint32_t patternAddrs = objAddrs + shift;
-				T objPattern = readData<T>(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs));
+				T objPattern = readData<T>(process.get(), patternAddrs);
 				if (objPattern == pattern)
 				{
 					return objAddrs;
@@ -168,18 +314,19 @@ public:
 	template <typename T>
 	uint32_t findGameObjByPattern(const std::vector<T>& pattern, uint32_t shift)
 	{
-		if (!isProcessSet()) return 0;
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return 0;
 
 		std::lock_guard<std::mutex> lock(objectStackMutex);
 
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE)
 		{
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				uint32_t patternAddrs = objAddrs + shift;
-				std::vector<T> objPattern = readData(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs), pattern.size() * sizeof(T));
+				std::vector<T> objPattern = readData(process.get(), patternAddrs, pattern.size() * sizeof(T));
 				if (memcmp(objPattern.data(), pattern.data(), pattern.size()) == 0)
 				{
 					return objAddrs;
@@ -197,7 +344,8 @@ public:
 	template <typename T>
 	std::vector<uint32_t> findAllGameObjByPattern(T pattern, uint32_t shift)
 	{
-		if (!isProcessSet()) return std::vector<uint32_t>(0);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return std::vector<uint32_t>(0);
 
 		std::vector<uint32_t> gameObjs;
 
@@ -206,11 +354,11 @@ public:
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE)
 		{
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				uint32_t patternAddrs = objAddrs + shift;
-				T objPattern = readData<T>(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs));
+				T objPattern = readData<T>(process.get(), patternAddrs);
 				if (objPattern == pattern)
 				{
 					gameObjs.push_back(objAddrs);
@@ -228,7 +376,8 @@ public:
 	template <typename T>
 	std::vector<uint32_t> findAllGameObjByPattern(const std::vector<T>& pattern, uint32_t shift)
 	{
-		if (!isProcessSet()) return std::vector<uint32_t>(0);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return std::vector<uint32_t>(0);
 
 		std::vector<uint32_t> gameObjs;
 
@@ -237,11 +386,11 @@ public:
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE)
 		{
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				uint32_t patternAddrs = objAddrs + shift;
-				std::vector<T> objPattern = readData(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs), pattern.size() * sizeof(T));
+				std::vector<T> objPattern = readData(process.get(), patternAddrs, pattern.size() * sizeof(T));
 				if (memcmp(objPattern.data(), pattern.data(), pattern.size()) == 0)
 				{
 					gameObjs.push_back(objAddrs);
@@ -263,23 +412,24 @@ public:
 	template <typename T, typename P>
 	std::vector<T> findReadAllGameObjByPattern(P pattern, uint32_t patternShift, uint32_t readShift)
 	{
+		std::shared_ptr<RemoteMemory> process = currentProcess();
 
-		if (!isProcessSet()) return std::vector<T>();
+		if (!isProcessSet(process)) return std::vector<T>();
 		std::vector<T>  gameObjs;
 
 		std::lock_guard<std::mutex> lock(objectStackMutex);
 
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE) {
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				uint32_t patternAddrs = objAddrs + patternShift;
-				P objPattern = readData<P>(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs));
+				P objPattern = readData<P>(process.get(), patternAddrs);
 				if (objPattern == pattern)
 				{
 					patternAddrs = objAddrs + readShift;
-					T objPattern = readData<T>(hobbitProcess, reinterpret_cast<LPVOID>(patternAddrs));
+					T objPattern = readData<T>(process.get(), patternAddrs);
 					gameObjs.push_back(objPattern);
 				}
 			}
@@ -289,7 +439,8 @@ public:
 	template <typename T, typename P>
 
 	std::vector<uint32_t> getAllObjects() {
-		if (!isProcessSet()) return std::vector<uint32_t>(0);
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!isProcessSet(process)) return std::vector<uint32_t>(0);
 
 		std::vector<uint32_t> foundObjects;
 
@@ -297,7 +448,7 @@ public:
 
 		for (size_t offset = 0; offset < objectStackSize * OBJECT_PTR_SIZE; offset += OBJECT_PTR_SIZE) {
 			uint32_t objStackAddress = objectStackAddress + offset;
-			uint32_t objAddrs = readData<uint32_t>(hobbitProcess, reinterpret_cast<LPVOID>(objStackAddress));
+			uint32_t objAddrs = readData<uint32_t>(process.get(), objStackAddress);
 			if (objAddrs != 0)
 			{
 				foundObjects.push_back(objAddrs);
@@ -309,12 +460,111 @@ public:
 
 
 private:
+	std::shared_ptr<RemoteMemory> currentProcess() const
+	{
+		std::lock_guard<std::mutex> lock(processMutex);
+		return hobbitProcess;
+	}
+	std::shared_ptr<TickCache> currentTickCache() const
+	{
+		std::lock_guard<std::mutex> lock(processMutex);
+		return tickCache;
+	}
+	std::shared_ptr<WriteBackCache> currentWriteCache() const
+	{
+		std::lock_guard<std::mutex> lock(processMutex);
+		return writeCache;
+	}
+	bool isProcessSet(const std::shared_ptr<RemoteMemory>& process)
+	{
+		if (process == nullptr)
+			logOption_->LogMessage(LogLevel::Log_Error, "ERROR: Hobbit Process is NOT set");
+		return process != nullptr;
+	}
+
+	struct GameObjectEntry
+	{
+		uint32_t objectAddress = 0;
+		uint32_t stackAddress = 0;
+	};
+
+	// Called with objectStackMutex held. A hit is checked against the GUID in
+	// the game; an object that moved makes the index rebuild once.
+	const GameObjectEntry* findIndexedObject(uint64_t guid)
+	{
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		if (!objectIndexValid)
+			rebuildObjectIndex();
+
+		auto found = objectIndex.find(guid);
+		if (found == objectIndex.end())
+			return nullptr;
+		if (readData<uint64_t>(process.get(), found->second.objectAddress + 0x8) == guid)
+			return &found->second;
+
+		rebuildObjectIndex();
+		found = objectIndex.find(guid);
+		return found == objectIndex.end() ? nullptr : &found->second;
+	}
+	// The whole stack in one read, then the GUID of every object in one batch.
+	// Like the walks it replaces, the first object with a GUID wins.
+	void rebuildObjectIndex()
+	{
+		std::shared_ptr<RemoteMemory> process = currentProcess();
+		objectIndex.clear();
+		objectIndexValid = true;
+		++objectIndexRebuilds;
+
+		size_t stackBytes = size_t(objectStackSize) * OBJECT_PTR_SIZE;
+		if (objectStackAddress == 0 || stackBytes == 0 || stackBytes > MAX_STACK_SIZE)
+			return;
+
+		std::vector<uint8_t> stack = ProcessAnalyzer::readData(process.get(), objectStackAddress, stackBytes);
+		std::vector<uint32_t> objects(objectStackSize);
+		std::vector<uint64_t> guids(objectStackSize);
+		ReadBatch batch;
+		for (uint32_t i = 0; i < objectStackSize; ++i)
+		{
+			std::memcpy(&objects[i], stack.data() + i * OBJECT_PTR_SIZE, sizeof(uint32_t));
+			if (objects[i] != 0)
+				batch.add(objects[i] + 0x8, guids[i]);
+		}
+		readBatch(batch);
+
+		objectIndex.reserve(objectStackSize);
+		for (uint32_t i = 0; i < objectStackSize; ++i)
+		{
+			if (objects[i] != 0)
+				objectIndex.emplace(guids[i], GameObjectEntry{ objects[i], objectStackAddress + i * OBJECT_PTR_SIZE });
+		}
+	}
+
 	LogOption::Ptr logOption_;
-	HANDLE hobbitProcess = 0;
+	// Swapped by setRemoteMemory while other threads read; only used through copies
+	mutable std::mutex processMutex;
+	std::shared_ptr<RemoteMemory> hobbitProcess;
+	std::shared_ptr<TickCache> tickCache;
+	std::shared_ptr<WriteBackCache> writeCache;
+	std::atomic<uint64_t> processGeneration{ 0 };
+	const char* PROCESS_NAME = "Meridian.exe";
+	ProcessAttachment attachment;
+
+	// Meridian.exe is loaded at its preferred base
+	const uint32_t MODULE_BASE = 0x00400000;
+	const char* SIGNATURE_FILE = "signatures.txt";
+	SignatureDatabase signatures;
+	std::array<std::atomic<uint32_t>, static_cast<size_t>(GameAddress::Count)> addresses;
 
 	uint32_t objectStackSize = 0x0;
 	const uint32_t OBJECT_PTR_SIZE = 0x14;
+	// A stack bigger than this is a bad read, not worth fetching whole
+	const uint32_t MAX_STACK_SIZE = 0x100000;
 	uint32_t objectStackAddress = 0;
 
 	std::mutex objectStackMutex;
+
+	// GUID -> object, built from one read of the stack
+	std::unordered_map<uint64_t, GameObjectEntry> objectIndex;
+	bool objectIndexValid = false;
+	uint64_t objectIndexRebuilds = 0;
 };
\ No newline at end of file
@@ -0,0 +1,235 @@
+#pragma once
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "RemoteMemory.h"
+
+// A process on Linux (the game under Wine, or a stand-in for benchmarks)
+// through process_vm_readv/process_vm_writev. Needs ptrace access to the
+// target: same user, and a parent of it unless kernel.yama.ptrace_scope is 0.
+// The process is held by a pidfd where the kernel has them (5.3), so a new
+// process that gets the same ID later isn't taken for it.
+class LinuxRemoteMemory : public RemoteMemory
+{
+public:
+	explicit LinuxRemoteMemory(pid_t pid) : pid(pid)
+	{
+#ifdef SYS_pidfd_open
+		pidFile = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#endif
+		// Opened up front rather than on the first protected write, which
+		// may come from several threads at once
+		memFile = open(("/proc/" + std::to_string(pid) + "/mem").c_str(), O_RDWR | O_CLOEXEC);
+	}
+	~LinuxRemoteMemory()
+	{
+		if (memFile >= 0)
+			close(memFile);
+		if (pidFile >= 0)
+			close(pidFile);
+	}
+
+	// Returns the ID of the first process with this executable name, 0 if there is none
+	static pid_t findProcess(const char* processName)
+	{
+		// comm holds at most 15 characters of the name
+		std::string wanted = std::string(processName).substr(0, 15);
+		DIR* proc = opendir("/proc");
+		if (proc == nullptr)
+			return 0;
+
+		pid_t found = 0;
+		while (dirent* entry = readdir(proc))
+		{
+			if (!std::isdigit(static_cast<unsigned char>(entry->d_name[0])))
+				continue;
+			std::ifstream comm(std::string("/proc/") + entry->d_name + "/comm");
+			std::string name;
+			if (std::getline(comm, name) && name == wanted)
+			{
+				found = static_cast<pid_t>(std::atoi(entry->d_name));
+				break;
+			}
+		}
+		closedir(proc);
+		return found;
+	}
+
+	bool read(uint64_t address, void* buffer, size_t size) override
+	{
+		iovec local{ buffer, size };
+		iovec remote{ reinterpret_cast<void*>(static_cast<uintptr_t>(address)), size };
+		ssize_t done = process_vm_readv(pid, &local, 1, &remote, 1, 0);
+		if (done == static_cast<ssize_t>(size))
+			return true;
+		lastErrno = done < 0 ? errno : EFAULT;
+		return false;
+	}
+	bool write(uint64_t address, const void* data, size_t size) override
+	{
+		iovec local{ const_cast<void*>(data), size };
+		iovec remote{ reinterpret_cast<void*>(static_cast<uintptr_t>(address)), size };
+		ssize_t done = process_vm_writev(pid, &local, 1, &remote, 1, 0);
+		if (done == static_cast<ssize_t>(size))
+			return true;
+
+		// process_vm_writev respects page protection; /proc/<pid>/mem writes
+		// through it, like VirtualProtectEx around the write on Windows
+		if (memFile >= 0 && pwrite(memFile, data, size, static_cast<off_t>(address)) == static_cast<ssize_t>(size))
+			return true;
+		lastErrno = errno;
+		return false;
+	}
+	// One process_vm_readv for up to BATCH_IOVECS requests. The call stops at
+	// the first request it can't read; that one is retried alone and the
+	// batch goes on after it.
+	size_t readBatch(ReadRequest* requests, size_t count) override
+	{
+		iovec local[BATCH_IOVECS];
+		iovec remote[BATCH_IOVECS];
+		size_t succeeded = 0;
+		size_t next = 0;
+		while (next < count)
+		{
+			size_t n = (std::min)(count - next, BATCH_IOVECS);
+			for (size_t i = 0; i < n; ++i)
+			{
+				ReadRequest& request = requests[next + i];
+				local[i] = { request.buffer, request.size };
+				remote[i] = { reinterpret_cast<void*>(static_cast<uintptr_t>(request.address)), request.size };
+			}
+			ssize_t done = process_vm_readv(pid, local, n, remote, n, 0);
+			if (done < 0)
+				lastErrno = errno;
+
+			size_t bytes = done < 0 ? 0 : static_cast<size_t>(done);
+			size_t i = next;
+			for (; i < next + n && bytes >= requests[i].size; ++i)
+			{
+				bytes -= requests[i].size;
+				requests[i].ok = true;
+				++succeeded;
+			}
+			if (i < next + n)
+			{
+				requests[i].ok = read(requests[i].address, requests[i].buffer, requests[i].size);
+				succeeded += requests[i].ok;
+				++i;
+			}
+			next = i;
+		}
+		return succeeded;
+	}
+	// One process_vm_writev the same way; a request it stops at, e.g. on a
+	// read-only page, goes through write() and its /proc/<pid>/mem fallback
+	size_t writeBatch(WriteRequest* requests, size_t count) override
+	{
+		iovec local[BATCH_IOVECS];
+		iovec remote[BATCH_IOVECS];
+		size_t succeeded = 0;
+		size_t next = 0;
+		while (next < count)
+		{
+			size_t n = (std::min)(count - next, BATCH_IOVECS);
+			for (size_t i = 0; i < n; ++i)
+			{
+				WriteRequest& request = requests[next + i];
+				local[i] = { const_cast<void*>(request.data), request.size };
+				remote[i] = { reinterpret_cast<void*>(static_cast<uintptr_t>(request.address)), request.size };
+			}
+			ssize_t done = process_vm_writev(pid, local, n, remote, n, 0);
+			if (done < 0)
+				lastErrno = errno;
+
+			size_t bytes = done < 0 ? 0 : static_cast<size_t>(done);
+			size_t i = next;
+			for (; i < next + n && bytes >= requests[i].size; ++i)
+			{
+				bytes -= requests[i].size;
+				requests[i].ok = true;
+				++succeeded;
+			}
+			if (i < next + n)
+			{
+				requests[i].ok = write(requests[i].address, requests[i].data, requests[i].size);
+				succeeded += requests[i].ok;
+				++i;
+			}
+			next = i;
+		}
+		return succeeded;
+	}
+
+	std::vector<MemoryRegion> regions() override
+	{
+		std::vector<MemoryRegion> found;
+		std::ifstream maps("/proc/" + std::to_string(pid) + "/maps");
+		std::string line;
+		while (std::getline(maps, line))
+		{
+			// start-end perms offset dev inode path
+			unsigned long long start = 0, end = 0;
+			char perms[5] = {};
+			if (std::sscanf(line.c_str(), "%llx-%llx %4s", &start, &end, perms) != 3 || perms[0] != 'r')
+				continue;
+			MemoryRegion region;
+			region.base = start;
+			region.size = end - start;
+			region.writable = perms[1] == 'w';
+			found.push_back(region);
+		}
+		return found;
+	}
+	// A pidfd becomes readable when the process exits
+	bool isAlive() override
+	{
+		if (pidFile >= 0)
+		{
+			pollfd exited{ pidFile, POLLIN, 0 };
+			int ready = poll(&exited, 1, 0);
+			if (ready >= 0)
+				return ready == 0;
+		}
+		return kill(pid, 0) == 0 || errno == EPERM;
+	}
+
+	int lastError() const override
+	{
+		return lastErrno;
+	}
+	const char* name() const override
+	{
+		return "linux";
+	}
+
+	pid_t getPid() const
+	{
+		return pid;
+	}
+
+private:
+	// Below IOV_MAX (1024) and small enough for the stack
+	static constexpr size_t BATCH_IOVECS = 256;
+
+	pid_t pid;
+	int pidFile = -1;
+	int memFile = -1;
+	std::atomic<int> lastErrno{ 0 };
+};
+#endif
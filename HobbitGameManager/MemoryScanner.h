@@ -0,0 +1,329 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "RemoteMemory.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HOBBIT_SCAN_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile the SIMD paths for their instruction set only; which
+// one runs is decided at runtime. MSVC needs no flags for the intrinsics.
+#if defined(HOBBIT_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HOBBIT_SCAN_TARGET(set) __attribute__((target(set)))
+#else
+#define HOBBIT_SCAN_TARGET(set)
+#endif
+
+enum class ScanInstructionSet
+{
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+// Searches a process's readable memory for a byte pattern. Regions are split
+// into chunks that a pool of threads reads and scans in parallel, each thread
+// reusing its own buffer. Chunks are read with pattern size - 1 bytes of the
+// next one, so a match straddling two chunks is found, once.
+//
+// Candidates are positions whose first and last byte match the pattern,
+// compared 32 (AVX2) or 16 (SSE2) positions at a time; only those are
+// compared in full.
+class MemoryScanner
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+	// threads = 0 uses every core
+	explicit MemoryScanner(size_t threads = 0) : instructionSet(detectInstructionSet())
+	{
+		threadCount = threads ? threads : (std::max)(1u, std::thread::hardware_concurrency());
+	}
+	~MemoryScanner()
+	{
+		{
+			std::lock_guard<std::mutex> lock(poolMutex);
+			stopping = true;
+		}
+		wake.notify_all();
+		for (std::unique_ptr<Worker>& worker : workers)
+			worker->thread.join();
+	}
+	MemoryScanner(const MemoryScanner&) = delete;
+	MemoryScanner& operator=(const MemoryScanner&) = delete;
+
+	// The best set this CPU supports
+	static ScanInstructionSet detectInstructionSet()
+	{
+#ifdef HOBBIT_SCAN_X86
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool sse2 = (info[3] & (1 << 26)) != 0;
+		bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+		bool avx2 = false;
+		if (maxLeaf >= 7 && osSavesYmm)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		bool sse2 = __builtin_cpu_supports("sse2");
+		bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2)
+			return ScanInstructionSet::AVX2;
+		if (sse2)
+			return ScanInstructionSet::SSE2;
+#endif
+		return ScanInstructionSet::Scalar;
+	}
+	// For comparisons; a set the CPU lacks falls back to the best it has
+	void setInstructionSet(ScanInstructionSet set)
+	{
+		instructionSet = (std::min)(set, detectInstructionSet());
+	}
+	ScanInstructionSet getInstructionSet() const
+	{
+		return instructionSet;
+	}
+	size_t getThreadCount() const
+	{
+		return threadCount;
+	}
+
+	// Addresses of every match, in address order
+	std::vector<uint64_t> search(RemoteMemory& process, const std::vector<uint8_t>& pattern)
+	{
+		std::lock_guard<std::mutex> searchLock(searchMutex);
+		std::vector<uint64_t> found;
+		if (pattern.empty())
+			return found;
+
+		chunks.clear();
+		for (const MemoryRegion& region : process.regions())
+		{
+			if (region.size < pattern.size())
+				continue;
+			for (uint64_t offset = 0; offset < region.size; offset += CHUNK_SIZE)
+			{
+				Chunk chunk;
+				chunk.address = region.base + offset;
+				chunk.size = static_cast<size_t>(std::min<uint64_t>(CHUNK_SIZE, region.size - offset));
+				chunk.readSize = static_cast<size_t>(std::min<uint64_t>(chunk.size + pattern.size() - 1, region.size - offset));
+				chunks.push_back(chunk);
+			}
+		}
+		this->process = &process;
+		this->pattern = &pattern;
+		nextChunk = 0;
+
+		// The calling thread scans too, so a pool of threadCount - 1 is enough
+		size_t helpers = (std::min)(threadCount, chunks.size()) - (chunks.empty() ? 0 : 1);
+		{
+			// A worker added now starts at the current generation, so it waits for this
+			// search like the others instead of taking an earlier one for it
+			std::lock_guard<std::mutex> lock(poolMutex);
+			while (workers.size() < helpers)
+			{
+				workers.push_back(std::make_unique<Worker>());
+				Worker* worker = workers.back().get();
+				uint64_t seen = generation;
+				worker->thread = std::thread([this, worker, seen] { workerLoop(*worker, seen); });
+			}
+			++generation;
+			pending = workers.size();
+		}
+		wake.notify_all();
+		scanChunks(caller);
+		{
+			std::unique_lock<std::mutex> lock(poolMutex);
+			done.wait(lock, [this] { return pending == 0; });
+		}
+
+		found = caller.found;
+		for (std::unique_ptr<Worker>& worker : workers)
+			found.insert(found.end(), worker->found.begin(), worker->found.end());
+		std::sort(found.begin(), found.end());
+		return found;
+	}
+
+	// Appends base + i for every i < positions where pattern matches data + i.
+	// data must hold at least positions + patternSize - 1 bytes.
+	static void scanBuffer(const uint8_t* data, size_t positions, const uint8_t* pattern, size_t patternSize,
+		uint64_t base, std::vector<uint64_t>& found, ScanInstructionSet set)
+	{
+#ifdef HOBBIT_SCAN_X86
+		if (set == ScanInstructionSet::AVX2)
+			return scanAvx2(data, positions, pattern, patternSize, base, found);
+		if (set == ScanInstructionSet::SSE2)
+			return scanSse2(data, positions, pattern, patternSize, base, found);
+#endif
+		scanScalar(data, positions, pattern, patternSize, base, found);
+	}
+
+private:
+	struct Chunk
+	{
+		uint64_t address = 0;
+		size_t size = 0;        // positions that belong to this chunk
+		size_t readSize = 0;    // with the overlap into the next one
+	};
+	struct Worker
+	{
+		std::thread thread;
+		std::vector<uint8_t> buffer;
+		std::vector<uint64_t> found;
+	};
+
+	size_t threadCount;
+	ScanInstructionSet instructionSet;
+
+	// One search at a time; the pool is shared by its chunks
+	std::mutex searchMutex;
+	std::vector<Chunk> chunks;
+	RemoteMemory* process = nullptr;
+	const std::vector<uint8_t>* pattern = nullptr;
+	std::atomic<size_t> nextChunk{ 0 };
+
+	std::mutex poolMutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+	std::vector<std::unique_ptr<Worker>> workers;
+	Worker caller;
+	uint64_t generation = 0;
+	size_t pending = 0;
+	bool stopping = false;
+
+	void workerLoop(Worker& worker, uint64_t seen)
+	{
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(poolMutex);
+				wake.wait(lock, [&] { return stopping || generation != seen; });
+				if (stopping)
+					return;
+				seen = generation;
+			}
+			scanChunks(worker);
+			{
+				std::lock_guard<std::mutex> lock(poolMutex);
+				--pending;
+			}
+			done.notify_all();
+		}
+	}
+	void scanChunks(Worker& worker)
+	{
+		worker.found.clear();
+		size_t patternSize = pattern->size();
+		while (true)
+		{
+			size_t index = nextChunk.fetch_add(1);
+			if (index >= chunks.size())
+				return;
+			const Chunk& chunk = chunks[index];
+			worker.buffer.resize(chunk.readSize);
+			if (!process->read(chunk.address, worker.buffer.data(), chunk.readSize))
+				continue;
+
+			if (chunk.readSize < patternSize)
+				continue;
+			size_t positions = (std::min)(chunk.size, chunk.readSize - patternSize + 1);
+			scanBuffer(worker.buffer.data(), positions, pattern->data(), patternSize, chunk.address, worker.found, instructionSet);
+		}
+	}
+
+	static uint32_t countTrailingZeros(uint32_t mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return index;
+#else
+		return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+	}
+
+	static void scanScalar(const uint8_t* data, size_t positions, const uint8_t* pattern, size_t patternSize,
+		uint64_t base, std::vector<uint64_t>& found)
+	{
+		size_t i = 0;
+		while (i < positions)
+		{
+			const void* hit = std::memchr(data + i, pattern[0], positions - i);
+			if (hit == nullptr)
+				return;
+			i = static_cast<const uint8_t*>(hit) - data;
+			if (data[i + patternSize - 1] == pattern[patternSize - 1] && std::memcmp(data + i, pattern, patternSize) == 0)
+				found.push_back(base + i);
+			++i;
+		}
+	}
+
+#ifdef HOBBIT_SCAN_X86
+	HOBBIT_SCAN_TARGET("sse2")
+	static void scanSse2(const uint8_t* data, size_t positions, const uint8_t* pattern, size_t patternSize,
+		uint64_t base, std::vector<uint64_t>& found)
+	{
+		const __m128i first = _mm_set1_epi8(static_cast<char>(pattern[0]));
+		const __m128i last = _mm_set1_epi8(static_cast<char>(pattern[patternSize - 1]));
+		size_t i = 0;
+		for (; i + 16 <= positions; i += 16)
+		{
+			__m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			__m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + patternSize - 1));
+			uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+			while (mask != 0)
+			{
+				size_t at = i + countTrailingZeros(mask);
+				if (std::memcmp(data + at, pattern, patternSize) == 0)
+					found.push_back(base + at);
+				mask &= mask - 1;
+			}
+		}
+		scanScalar(data + i, positions - i, pattern, patternSize, base + i, found);
+	}
+
+	HOBBIT_SCAN_TARGET("avx2")
+	static void scanAvx2(const uint8_t* data, size_t positions, const uint8_t* pattern, size_t patternSize,
+		uint64_t base, std::vector<uint64_t>& found)
+	{
+		const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+		const __m256i last = _mm256_set1_epi8(static_cast<char>(pattern[patternSize - 1]));
+		size_t i = 0;
+		for (; i + 32 <= positions; i += 32)
+		{
+			__m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+			__m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + patternSize - 1));
+			uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+				_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+			while (mask != 0)
+			{
+				size_t at = i + countTrailingZeros(mask);
+				if (std::memcmp(data + at, pattern, patternSize) == 0)
+					found.push_back(base + at);
+				mask &= mask - 1;
+			}
+		}
+		scanSse2(data + i, positions - i, pattern, patternSize, base + i, found);
+	}
+#endif
+};
@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include "HobbitProcessAnalyzer.h"
+#include "GameAddresses.h"
+#include "ReadBatch.h"
+
+// Values in the game polled for changes. Watches with the same interval form
+// a tier; the tiers due at a poll are read together in one batch, and a
+// watch's callback only runs when its value differs from the last poll.
+// Before the first poll every value counts as zero, so a value that isn't
+// fires on the first poll.
+//
+// The watcher has no thread of its own: the owner calls poll() from its
+// loop, and the callbacks run there, after the reads.
+class MemoryWatcher
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using WatchId = uint64_t;
+
+	template <typename T>
+	using Callback = std::function<void(const T& previous, const T& current)>;
+
+	template <typename T>
+	WatchId watch(uint32_t address, std::chrono::milliseconds interval, Callback<T> onChange)
+	{
+		return addWatch<T>(false, GameAddress::Count, address, interval, std::move(onChange));
+	}
+	// Follows the address if it is resolved again, e.g. for another build
+	template <typename T>
+	WatchId watch(GameAddress address, std::chrono::milliseconds interval, Callback<T> onChange)
+	{
+		return addWatch<T>(true, address, 0, interval, std::move(onChange));
+	}
+	void unwatch(WatchId id)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Tier& tier : tiers)
+		{
+			tier.watches.erase(std::remove_if(tier.watches.begin(), tier.watches.end(),
+				[id](const Watch& watch) { return watch.id == id; }), tier.watches.end());
+		}
+		tiers.erase(std::remove_if(tiers.begin(), tiers.end(),
+			[](const Tier& tier) { return tier.watches.empty(); }), tiers.end());
+	}
+	// Every value back to zero, so the next poll reports what isn't
+	void reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (Tier& tier : tiers)
+		{
+			for (Watch& watch : tier.watches)
+				std::fill(watch.previous.begin(), watch.previous.end(), 0);
+		}
+	}
+
+	// Reads the tiers that are due and runs the callbacks of what changed.
+	// Returns when the next tier is due.
+	Clock::time_point poll(HobbitProcessAnalyzer& analyzer, Clock::time_point now = Clock::now())
+	{
+		std::vector<std::function<void()>> changed;
+		Clock::time_point next = (Clock::time_point::max)();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			std::vector<Tier*> due;
+			for (Tier& tier : tiers)
+			{
+				if (tier.due <= now)
+				{
+					// A tier that fell behind starts over from now instead of catching up
+					due.push_back(&tier);
+					tier.due = tier.due + tier.interval > now ? tier.due + tier.interval : now + tier.interval;
+				}
+				next = (std::min)(next, tier.due);
+			}
+			readTiers(analyzer, due, changed);
+			++polls;
+		}
+		for (const std::function<void()>& callback : changed)
+			callback();
+		return next;
+	}
+	uint64_t getPolls()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return polls;
+	}
+
+private:
+	struct Watch
+	{
+		WatchId id = 0;
+		bool named = false;             // address is looked up in the analyzer every poll
+		GameAddress name = GameAddress::Count;
+		uint32_t address = 0;
+		std::vector<uint8_t> previous;
+		std::vector<uint8_t> current;
+		std::function<void(const uint8_t* previous, const uint8_t* current)> onChange;
+	};
+	struct Tier
+	{
+		std::chrono::milliseconds interval{ 0 };
+		Clock::time_point due;
+		std::vector<Watch> watches;
+	};
+
+	std::mutex mutex;
+	std::vector<Tier> tiers;
+	WatchId nextId = 1;
+	uint64_t polls = 0;
+
+	template <typename T>
+	WatchId addWatch(bool named, GameAddress name, uint32_t address, std::chrono::milliseconds interval, Callback<T> onChange)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Type T must be trivially copyable");
+		static_assert(!std::is_same<T, bool>::value, "Watch flags as uint8_t, any byte is not a valid bool");
+
+		Watch watch;
+		watch.named = named;
+		watch.name = name;
+		watch.address = address;
+		watch.previous.assign(sizeof(T), 0);
+		watch.current.assign(sizeof(T), 0);
+		watch.onChange = [onChange](const uint8_t* previous, const uint8_t* current)
+			{
+				T before, after;
+				std::memcpy(&before, previous, sizeof(T));
+				std::memcpy(&after, current, sizeof(T));
+				onChange(before, after);
+			};
+
+		std::lock_guard<std::mutex> lock(mutex);
+		watch.id = nextId++;
+		auto tier = std::find_if(tiers.begin(), tiers.end(), [interval](const Tier& tier) { return tier.interval == interval; });
+		if (tier == tiers.end())
+		{
+			tiers.emplace_back();
+			tier = tiers.end() - 1;
+			tier->interval = interval;
+		}
+		tier->watches.push_back(std::move(watch));
+		return tier->watches.back().id;
+	}
+	// What can't be read comes back as zero, like readData
+	void readTiers(HobbitProcessAnalyzer& analyzer, const std::vector<Tier*>& due, std::vector<std::function<void()>>& changed)
+	{
+		if (due.empty())
+			return;
+		ReadBatch batch;
+		for (Tier* tier : due)
+		{
+			for (Watch& watch : tier->watches)
+			{
+				uint32_t address = watch.named ? analyzer.getAddress(watch.name) : watch.address;
+				batch.add(address, watch.current.data(), watch.current.size());
+			}
+		}
+		analyzer.readBatch(batch);
+
+		for (Tier* tier : due)
+		{
+			for (Watch& watch : tier->watches)
+			{
+				if (watch.current == watch.previous)
+					continue;
+				changed.push_back([onChange = watch.onChange, previous = watch.previous, current = watch.current]
+					{
+						onChange(previous.data(), current.data());
+					});
+				watch.previous = watch.current;
+			}
+		}
+	}
+};
@@ -1,5 +1,21 @@
 #include "NPC.h"
 HobbitProcessAnalyzer* NPC::hobbitProcessAnalyzer = nullptr;
+
+namespace
+{
+	// Indices into NPC::objectPaths()
+	const size_t ANIMATION_PATH = 0;
+}
+const PointerPaths& NPC::objectPaths()
+{
+	static const PointerPaths paths = []
+		{
+			PointerPaths declared;
+			declared.add({ 0x304, 0x50, 0x10C }, 0x8);
+			return declared;
+		}();
+	return paths;
+}
 //static member functions
 void NPC::setHobbitProcessAnalyzer(HobbitProcessAnalyzer* newHobbitProcessAnalyzer)
 {
@@ -7,7 +23,7 @@ void NPC::setHobbitProcessAnalyzer(HobbitProcessAnalyzer* newHobbitProcessAnalyz
 }
 
 // Constructors
-NPC::NPC() : logOption_(LogManager::Instance().CreateLogOption("NPC")) {
+NPC::NPC() : logOption_(LogManager::Instance().CreateLogOption("NPC")), pointers(objectPaths(), 0x8, sizeof(uint64_t)) {
 
 }
 void NPC::setNCP(uint64_t GUID)
@@ -144,13 +160,20 @@ float NPC::getHealth() {
 
 void NPC::setAnimation(uint32_t newAnimation)
 {
+	if (animationAddress == 0)
+		return;
 	hobbitProcessAnalyzer->writeData(animationAddress, newAnimation);
 }
 uint32_t NPC::getAnimation() {
 	return hobbitProcessAnalyzer->readData<uint32_t>(animationAddress);
 }
+uint32_t NPC::getAnimationPtr() {
+	return animationAddress;
+}
 void NPC::setAnimFrames(float newAnimFrame, float newLastAnimFrame)
 {
+	if (animationAddress == 0)
+		return;
 	hobbitProcessAnalyzer->writeData(animationAddress + 0x8, newAnimFrame);
 	hobbitProcessAnalyzer->writeData(animationAddress + 0x14, newLastAnimFrame);
 }
@@ -189,16 +212,16 @@ void NPC::setPositionXPtr()
 	positionXAddress.push_back(0x18 + 0x8 + ObjectPtr);
 
 	// set the animation position X pointer
-	uint32_t animAdd1 = getObjectPtr();
-	uint32_t animAdd2 = hobbitProcessAnalyzer->readData<uint32_t>(0x304 + animAdd1);
-	uint32_t animAdd3 = hobbitProcessAnalyzer->readData<uint32_t>(0x50 + animAdd2);
-	uint32_t animAdd4 = hobbitProcessAnalyzer->readData<uint32_t>(0x10C + animAdd3);
-	if (animAdd4 == 0) 
+	animationAddress = pointers.get(*hobbitProcessAnalyzer, ObjectPtr)[ANIMATION_PATH];
+	if (animationAddress == 0)
+	{
+		// The chain to the animation object is broken, e.g. while the level loads
+		logOption_->LogMessage(LogLevel::Log_Warning, "No animation object", "Health:", getHealth());
+	}
+	else
 	{
-		logOption_->LogMessage(LogLevel::Log_Debug, "Health:", getHealth());
+		positionXAddress.push_back(-0xC4 + animationAddress);
 	}
-	animationAddress = 0x8 + animAdd4;
-	positionXAddress.push_back(-0xC4 + animationAddress);
 
 	// Display the position X pointers Data
 	for (uint32_t posxAdd : positionXAddress)
@@ -225,12 +248,8 @@ void NPC::setRotationYPtr()
 // Sets animation pointer of the NPC
 void NPC::setAnimationPtr()
 {
-	// set animation pointer
-	uint32_t animAdd1 = getObjectPtr();
-	uint32_t animAdd2 = hobbitProcessAnalyzer->readData<uint32_t>(0x304 + animAdd1);
-	uint32_t animAdd3 = hobbitProcessAnalyzer->readData<uint32_t>(0x50 + animAdd2);
-	uint32_t animAdd4 = hobbitProcessAnalyzer->readData<uint32_t>(0x10C + animAdd3);
-	animationAddress = 0x8 + animAdd4;
+	// set animation pointer; the chain is the one setPositionXPtr walked
+	animationAddress = pointers.get(*hobbitProcessAnalyzer, getObjectPtr())[ANIMATION_PATH];
 
 
 	// Display the animation pointer Data
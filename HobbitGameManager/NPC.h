@@ -1,8 +1,8 @@
 #pragma once
 #include <vector>
 #include "HobbitProcessAnalyzer.h"
+#include "PointerPaths.h"
 #include "../LogSystem/LogManager.h"
-#include <windows.h>
 class NPC
 {
 public:
@@ -47,6 +47,7 @@ public:
 
 	void setAnimation(uint32_t newAnimation);
 	uint32_t getAnimation();
+	uint32_t getAnimationPtr();
 	void setAnimFrames(float newAnimFrame, float newLastAnimFrame);
 
 	void setWeapon(uint32_t newWeapon);
@@ -62,6 +63,8 @@ private:
 	std::vector<uint32_t> positionXAddress;		// Position X pointer
 	uint32_t rotationYAddress = 0;				// Rotation Y pointer
 	uint32_t animationAddress = 0;				// Animation pointer
+	// Pointer chains from the object, kept while its GUID and every pointer on the way hold
+	PointerCache pointers;
 	// GUID of object
 	uint64_t guid = 0;
 	// Sets objects pointer of the NPC
@@ -72,5 +75,7 @@ private:
 	void setRotationYPtr();
 	// Sets animation pointer of the NPC
 	void setAnimationPtr();
+	// The chains every NPC walks from its object
+	static const PointerPaths& objectPaths();
 };
 
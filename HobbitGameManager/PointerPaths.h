@@ -0,0 +1,181 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "HobbitProcessAnalyzer.h"
+#include "ReadBatch.h"
+
+// Pointer chains declared once, as offsets from a root. A path reads a
+// pointer at root + hops[0], then at that + hops[1], and so on, and adds
+// finalOffset to the last one. Paths are kept as a trie, so a hop several
+// paths share is read once, and every depth of the trie is one batch.
+class PointerPaths
+{
+public:
+	size_t add(const std::vector<uint32_t>& hops, uint32_t finalOffset = 0)
+	{
+		int32_t node = -1;
+		for (uint32_t offset : hops)
+			node = findOrAddNode(node, offset);
+		paths.push_back(Path{ node, finalOffset });
+		return paths.size() - 1;
+	}
+	size_t size() const
+	{
+		return paths.size();
+	}
+
+	// Address of every path from root, by index. A chain that reaches a null
+	// pointer stops there; the paths through it come out as 0 and the result
+	// is false. hops, if given, gets the pointer read at every hop, for
+	// unchanged().
+	bool resolve(HobbitProcessAnalyzer& analyzer, uint32_t root, std::vector<uint32_t>& results, std::vector<uint32_t>* hops = nullptr) const
+	{
+		std::vector<uint32_t> values(nodes.size());
+		for (uint32_t depth = 1; depth <= maxDepth; ++depth)
+		{
+			ReadBatch batch;
+			for (size_t i = 0; i < nodes.size(); ++i)
+			{
+				if (nodes[i].depth != depth)
+					continue;
+				uint32_t base = nodes[i].parent < 0 ? root : values[nodes[i].parent];
+				if (nodes[i].parent >= 0 && base == 0)
+					continue;
+				batch.add(base + nodes[i].offset, values[i]);
+			}
+			analyzer.readBatch(batch);
+		}
+
+		bool complete = true;
+		results.resize(paths.size());
+		for (size_t i = 0; i < paths.size(); ++i)
+		{
+			uint32_t base = paths[i].node < 0 ? root : values[paths[i].node];
+			if (paths[i].node >= 0 && base == 0)
+			{
+				complete = false;
+				results[i] = 0;
+				continue;
+			}
+			results[i] = base + paths[i].finalOffset;
+		}
+		if (hops)
+			hops->swap(values);
+		return complete;
+	}
+	// Reads every hop of a complete resolve() from root again, together with
+	// what is already in batch (e.g. a guard), in one batch. True if each
+	// hop still holds the pointer in hops.
+	bool unchanged(HobbitProcessAnalyzer& analyzer, uint32_t root, const std::vector<uint32_t>& hops, ReadBatch& batch) const
+	{
+		if (hops.size() != nodes.size())
+			return false;
+		std::vector<uint32_t> values(nodes.size());
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			uint32_t base = nodes[i].parent < 0 ? root : hops[nodes[i].parent];
+			batch.add(base + nodes[i].offset, values[i]);
+		}
+		return analyzer.readBatch(batch) && values == hops;
+	}
+
+private:
+	struct Node
+	{
+		int32_t parent;     // -1 for a hop from the root
+		uint32_t offset;
+		uint32_t depth;
+	};
+	struct Path
+	{
+		int32_t node;       // last hop, -1 for root + finalOffset
+		uint32_t finalOffset;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<Path> paths;
+	uint32_t maxDepth = 0;
+
+	int32_t findOrAddNode(int32_t parent, uint32_t offset)
+	{
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			if (nodes[i].parent == parent && nodes[i].offset == offset)
+				return static_cast<int32_t>(i);
+		}
+		uint32_t depth = parent < 0 ? 1 : nodes[parent].depth + 1;
+		nodes.push_back(Node{ parent, offset, depth });
+		maxDepth = (std::max)(maxDepth, depth);
+		return static_cast<int32_t>(nodes.size() - 1);
+	}
+};
+
+// The results of a PointerPaths for one root, kept while a guard holds: the
+// guardSize bytes at root + guardOffset, as they were when the paths were
+// walked (e.g. an object's GUID), and the pointer at every hop. Both are
+// checked in one batch; the paths are only walked again when one of them
+// changed, the root moved, a chain was broken or the game was opened again.
+// A GUID alone doesn't do: an object can keep it while the objects it
+// points to are replaced, e.g. on a level load.
+class PointerCache
+{
+public:
+	PointerCache(const PointerPaths& paths, uint32_t guardOffset, size_t guardSize)
+		: paths(paths), guardOffset(guardOffset), guardSize((std::min)(guardSize, sizeof(uint64_t)))
+	{
+
+	}
+
+	const std::vector<uint32_t>& get(HobbitProcessAnalyzer& analyzer, uint32_t root)
+	{
+		uint64_t generation = analyzer.getProcessGeneration();
+		if (valid && root == cachedRoot && generation == cachedGeneration && stillHolds(analyzer, root))
+			return results;
+
+		++resolves;
+		guard = readGuard(analyzer, root);
+		valid = paths.resolve(analyzer, root, results, &hops) && guard != 0;
+		cachedRoot = root;
+		cachedGeneration = generation;
+		return results;
+	}
+	void invalidate()
+	{
+		valid = false;
+	}
+	uint64_t getResolves() const
+	{
+		return resolves;
+	}
+
+private:
+	const PointerPaths& paths;
+	uint32_t guardOffset;
+	size_t guardSize;
+
+	std::vector<uint32_t> results;
+	std::vector<uint32_t> hops;
+	uint32_t cachedRoot = 0;
+	uint64_t cachedGeneration = 0;
+	uint64_t guard = 0;
+	bool valid = false;
+	uint64_t resolves = 0;
+
+	uint64_t readGuard(HobbitProcessAnalyzer& analyzer, uint32_t root)
+	{
+		std::vector<uint8_t> bytes = analyzer.readData<uint8_t>(root + guardOffset, guardSize);
+		uint64_t value = 0;
+		std::memcpy(&value, bytes.data(), (std::min)(bytes.size(), sizeof(value)));
+		return value;
+	}
+	bool stillHolds(HobbitProcessAnalyzer& analyzer, uint32_t root)
+	{
+		uint64_t current = 0;
+		ReadBatch batch;
+		batch.add(root + guardOffset, &current, guardSize);
+		return paths.unchanged(analyzer, root, hops, batch) && current == guard;
+	}
+};
@@ -1,14 +1,10 @@
 #pragma once
-#ifdef _WIN32
-#include <winsock2.h>   // Ensure winsock2.h is included before Windows.h
-#include <Windows.h>
-#include<memoryapi.h>
-#include<TlHelp32.h>
-#endif
-
 #include<iostream>
 #include<vector>
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 
 #include <cstdint> 
@@ -37,40 +33,40 @@ public:
 		return converter.f;
 	}
 
-	HANDLE getProcess(std::string processName)
+	std::shared_ptr<RemoteMemory> getProcess(std::string processName)
 	{
-		getProcess(processName.c_str());
+		return getProcess(processName.c_str());
 	}
 	
 	template <typename T>
-	void writeData(HANDLE process, LPVOID address, T data)
+	void writeData(RemoteMemory* process, uint64_t address, T data)
 	{
 		ProcessAnalyzer::writeData(process, address, convertToUint8Vector(data));
 	}
 	template <typename T>
-	void writeData(HANDLE process, LPVOID address, std::vector<T> data)
+	void writeData(RemoteMemory* process, uint64_t address, std::vector<T> data)
 	{
 		ProcessAnalyzer::writeData(process, address, convertToUint8Vector(data));
 	}
 
 	template <typename T>
-	T readData(HANDLE process, LPVOID address)
+	T readData(RemoteMemory* process, uint64_t address)
 	{
 		return convertToType<T>(ProcessAnalyzer::readData(process, address, sizeof(T)));
 	}
 	template <typename T>
-	std::vector<T> readData(HANDLE process, LPVOID address, size_t size)
+	std::vector<T> readData(RemoteMemory* process, uint64_t address, size_t size)
 	{
 		return convertToVector<T>(ProcessAnalyzer::readData(process, address, size * sizeof(T)));
 	}
 
 	template <typename T>
-	std::vector<uint32_t> searchProcessMemory(HANDLE process, T pattern)
+	std::vector<uint32_t> searchProcessMemory(RemoteMemory* process, T pattern)
 	{
 		return searchProcessMemory(process, convertToUint8Vector(pattern));
 	}
 	template <typename T>
-	std::vector<uint32_t> searchProcessMemory(HANDLE process, const std::vector<T>& pattern)
+	std::vector<uint32_t> searchProcessMemory(RemoteMemory* process, const std::vector<T>& pattern)
 	{
 		return searchProcessMemory(process, convertToUint8Vector(pattern));
 	}
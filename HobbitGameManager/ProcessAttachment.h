@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include "RemoteMemory.h"
+
+// A process found once and held until it exits. While nothing is attached,
+// update() looks for the process, at most once per retry interval. While it
+// is attached, update() only asks the held handle (a pidfd on Linux) whether
+// the process has exited, and the process list is not walked again until it
+// has. The listeners hear about both, in the thread that called update().
+class ProcessAttachment
+{
+public:
+	using Clock = std::chrono::steady_clock;
+	using Listener = std::function<void()>;
+	// Finds and opens the process, nullptr if it isn't running
+	using Opener = std::function<std::shared_ptr<RemoteMemory>()>;
+
+	explicit ProcessAttachment(Opener open, std::chrono::milliseconds retryInterval = std::chrono::milliseconds(1000))
+		: open(std::move(open)), retryInterval(retryInterval)
+	{
+
+	}
+
+	// Attaches, or notices the exit. Returns whether the process is attached.
+	bool update(Clock::time_point now = Clock::now())
+	{
+		std::vector<Listener> notify;
+		bool attached = false;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (process)
+			{
+				if (process->isAlive())
+					return true;
+				// Looked for again on the next update
+				process = nullptr;
+				nextSearch = now;
+				notify = listenersDetach;
+			}
+			else if (now >= nextSearch)
+			{
+				nextSearch = now + retryInterval;
+				++searches;
+				process = open();
+				if (process)
+					notify = listenersAttach;
+			}
+			attached = process != nullptr;
+		}
+		for (const Listener& listener : notify)
+			listener();
+		return attached;
+	}
+
+	bool isAttached()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return process != nullptr;
+	}
+	std::shared_ptr<RemoteMemory> getProcess()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return process;
+	}
+	// How often the process list was walked
+	uint64_t getSearches()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return searches;
+	}
+
+	void addListenerAttach(const Listener& listener)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		listenersAttach.push_back(listener);
+	}
+	void addListenerDetach(const Listener& listener)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		listenersDetach.push_back(listener);
+	}
+
+private:
+	Opener open;
+	std::chrono::milliseconds retryInterval;
+
+	std::mutex mutex;
+	std::shared_ptr<RemoteMemory> process;
+	Clock::time_point nextSearch;
+	uint64_t searches = 0;
+
+	std::vector<Listener> listenersAttach;
+	std::vector<Listener> listenersDetach;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include "RemoteMemory.h"
+
+// Reads collected first and issued together by HobbitProcessAnalyzer::readBatch,
+// instead of a round trip to the game per value. The destinations must stay
+// alive until the batch has been read.
+class ReadBatch
+{
+public:
+	template <typename T>
+	void add(uint32_t address, T& destination)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Type T must be trivially copyable");
+		static_assert(!std::is_same<T, bool>::value, "Read flags into uint8_t, any byte is not a valid bool");
+
+		ReadRequest request;
+		request.address = address;
+		request.buffer = &destination;
+		request.size = sizeof(T);
+		requests.push_back(request);
+	}
+	// For values whose type is only known by size
+	void add(uint32_t address, void* destination, size_t size)
+	{
+		ReadRequest request;
+		request.address = address;
+		request.buffer = destination;
+		request.size = size;
+		requests.push_back(request);
+	}
+	void clear()
+	{
+		requests.clear();
+	}
+	size_t size() const
+	{
+		return requests.size();
+	}
+	std::vector<ReadRequest>& getRequests()
+	{
+		return requests;
+	}
+
+private:
+	std::vector<ReadRequest> requests;
+};
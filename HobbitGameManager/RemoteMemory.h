@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// A committed, readable range of the target's address space
+struct MemoryRegion
+{
+	uint64_t base = 0;
+	uint64_t size = 0;
+	bool writable = false;
+};
+
+// One read of a batch; ok is set by readBatch
+struct ReadRequest
+{
+	uint64_t address = 0;
+	void* buffer = nullptr;
+	size_t size = 0;
+	bool ok = false;
+};
+// One write of a batch; ok is set by writeBatch
+struct WriteRequest
+{
+	uint64_t address = 0;
+	const void* data = nullptr;
+	size_t size = 0;
+	bool ok = false;
+};
+
+// Access to the memory of another process. ProcessAnalyzer and everything
+// above it only go through this, so the same code runs against the game on
+// Windows (Win32RemoteMemory), a process on Linux (LinuxRemoteMemory) or an
+// address space faked inside this process (FakeRemoteMemory).
+class RemoteMemory
+{
+public:
+	virtual ~RemoteMemory() = default;
+
+	// Both fail if any byte of the range can't be accessed. read is called
+	// from several threads at once by pattern searches.
+	virtual bool read(uint64_t address, void* buffer, size_t size) = 0;
+	// Writes through read-only and code pages too, the game patches rely on it
+	virtual bool write(uint64_t address, const void* data, size_t size) = 0;
+	// Issues all the reads at once where the backend can and returns how many
+	// succeeded. By default they are read one by one.
+	virtual size_t readBatch(ReadRequest* requests, size_t count)
+	{
+		size_t succeeded = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			requests[i].ok = read(requests[i].address, requests[i].buffer, requests[i].size);
+			succeeded += requests[i].ok;
+		}
+		return succeeded;
+	}
+	// The same for writes
+	virtual size_t writeBatch(WriteRequest* requests, size_t count)
+	{
+		size_t succeeded = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			requests[i].ok = write(requests[i].address, requests[i].data, requests[i].size);
+			succeeded += requests[i].ok;
+		}
+		return succeeded;
+	}
+
+	// Readable committed regions in address order, for pattern searches
+	virtual std::vector<MemoryRegion> regions() = 0;
+	virtual bool isAlive() = 0;
+
+	// System error of the last failed call (GetLastError / errno), for the log
+	virtual int lastError() const = 0;
+	virtual const char* name() const = 0;
+
+protected:
+	// Where the region holding this address ends, for backends whose reads
+	// depend on it; coalesced spans never run past it
+	virtual uint64_t regionEnd(uint64_t)
+	{
+		return UINT64_MAX;
+	}
+
+	// For backends that pay per call: requests that are contiguous or close
+	// together are read as one span and copied out. A span that fails is
+	// read again request by request, so one bad address doesn't fail the rest.
+	size_t readCoalesced(ReadRequest* requests, size_t count)
+	{
+		const uint64_t MAX_GAP = 64;
+		const uint64_t MAX_SPAN = 64 * 1024;
+
+		std::vector<size_t> order(count);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [requests](size_t a, size_t b)
+			{
+				return requests[a].address < requests[b].address;
+			});
+
+		std::vector<uint8_t> span;
+		size_t succeeded = 0;
+		for (size_t first = 0; first < count;)
+		{
+			uint64_t start = requests[order[first]].address;
+			uint64_t end = start + requests[order[first]].size;
+			uint64_t limit = regionEnd(start);
+			size_t last = first + 1;
+			while (last < count)
+			{
+				const ReadRequest& next = requests[order[last]];
+				uint64_t nextEnd = (std::max)(end, next.address + next.size);
+				if (next.address > end + MAX_GAP || nextEnd - start > MAX_SPAN || nextEnd > limit)
+					break;
+				end = nextEnd;
+				++last;
+			}
+
+			bool spanRead = false;
+			if (last - first > 1)
+			{
+				span.resize(end - start);
+				spanRead = read(start, span.data(), span.size());
+			}
+			for (size_t i = first; i < last; ++i)
+			{
+				ReadRequest& request = requests[order[i]];
+				if (spanRead)
+				{
+					std::memcpy(request.buffer, span.data() + (request.address - start), request.size);
+					request.ok = true;
+				}
+				else
+				{
+					request.ok = read(request.address, request.buffer, request.size);
+				}
+				succeeded += request.ok;
+			}
+			first = last;
+		}
+		return succeeded;
+	}
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "RemoteMemory.h"
+#include "SignatureScanner.h"
+#include "../LogSystem/LogManager.h"
+
+// Signatures of the game's static addresses, read from a text file with one
+// per line:
+//
+//   # name  operand offset  pattern
+//   PlayerPtr  2  8B 0D ?? ?? ?? ?? 85 C9
+//
+// A signature is code that refers to the address; the address is the 32-bit
+// operand at match + operand offset. resolve() finds them all in one pass over
+// the exe's image and keeps the result on disk, keyed by a hash of the exe's
+// headers and of the signatures, so the next launch of the same build skips
+// the scan.
+class SignatureDatabase
+{
+	LogOption::Ptr logOption_;
+
+public:
+	// Resolved address per name; 0 for a signature that didn't match once
+	using Addresses = std::map<std::string, uint32_t>;
+
+	SignatureDatabase() : logOption_(LogManager::Instance().CreateLogOption("SIGNATURES"))
+	{
+
+	}
+
+	// A missing file leaves the database empty
+	bool load(const std::string& path)
+	{
+		signatures.clear();
+		definitionsHash = FNV_OFFSET;
+		std::ifstream file(path);
+		if (!file.is_open())
+			return false;
+
+		std::string line;
+		for (size_t number = 1; std::getline(file, line); ++number)
+		{
+			size_t comment = line.find('#');
+			if (comment != std::string::npos)
+				line.erase(comment);
+			std::istringstream fields(line);
+			Signature signature;
+			std::string offset, pattern;
+			if (!(fields >> signature.name))
+				continue;
+			fields >> offset;
+			std::getline(fields, pattern);
+
+			char* end = nullptr;
+			signature.operandOffset = std::strtoul(offset.c_str(), &end, 0);
+			if (offset.empty() || *end != '\0' || !Signature::parse(pattern, signature)
+				|| signature.operandOffset + sizeof(uint32_t) > signature.bytes.size())
+			{
+				logOption_->LogMessage(LogLevel::Log_Warning, path, "line", number, "is not a valid signature, skipped");
+				continue;
+			}
+			signatures.push_back(signature);
+			definitionsHash = fnv1a(line.data(), line.size(), definitionsHash);
+		}
+		return true;
+	}
+	bool empty() const
+	{
+		return signatures.empty();
+	}
+	void setCacheDirectory(const std::string& directory)
+	{
+		cacheDirectory = directory;
+	}
+
+	// Resolves every signature in the image of the module at moduleBase
+	bool resolve(RemoteMemory& process, uint32_t moduleBase, Addresses& addresses)
+	{
+		addresses.clear();
+		std::vector<uint8_t> headers(HEADERS_SIZE);
+		if (signatures.empty() || !process.read(moduleBase, headers.data(), headers.size()))
+			return false;
+		uint32_t imageSize = peImageSize(headers);
+		if (imageSize == 0)
+		{
+			logOption_->LogMessage(LogLevel::Log_Warning, "No PE image at", moduleBase);
+			return false;
+		}
+
+		std::string cachePath = getCachePath(fnv1a(headers.data(), headers.size(), definitionsHash));
+		if (loadCache(cachePath, addresses))
+			return true;
+
+		std::vector<uint8_t> image = readImage(process, moduleBase, imageSize);
+		SignatureScanner scanner;
+		for (const Signature& signature : signatures)
+			scanner.add(signature);
+		std::vector<std::vector<uint64_t>> found = scanner.scan(image.data(), image.size(), moduleBase);
+
+		for (size_t i = 0; i < signatures.size(); ++i)
+		{
+			uint32_t address = 0;
+			if (found[i].size() == 1)
+			{
+				size_t operand = static_cast<size_t>(found[i][0] - moduleBase) + signatures[i].operandOffset;
+				std::memcpy(&address, image.data() + operand, sizeof(address));
+				// Data the exe refers to lies in its own image
+				if (address < moduleBase || address >= moduleBase + imageSize)
+				{
+					logOption_->LogMessage(LogLevel::Log_Warning, signatures[i].name, "- operand", address, "is outside the image");
+					address = 0;
+				}
+			}
+			else
+			{
+				logOption_->LogMessage(LogLevel::Log_Warning, signatures[i].name, found[i].empty() ? "- no match" : "- no unique match");
+			}
+			addresses[signatures[i].name] = address;
+		}
+		saveCache(cachePath, addresses);
+		return true;
+	}
+
+private:
+	static constexpr size_t HEADERS_SIZE = 0x1000;
+	static constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+	static constexpr uint64_t FNV_PRIME = 0x100000001B3ull;
+
+	std::vector<Signature> signatures;
+	uint64_t definitionsHash = FNV_OFFSET;
+	std::string cacheDirectory = "address_cache";
+
+	static uint64_t fnv1a(const void* data, size_t size, uint64_t hash)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+	// SizeOfImage from the optional header, 0 if this isn't a PE image
+	static uint32_t peImageSize(const std::vector<uint8_t>& headers)
+	{
+		uint32_t peOffset = 0, signature = 0, imageSize = 0;
+		if (headers[0] != 'M' || headers[1] != 'Z')
+			return 0;
+		std::memcpy(&peOffset, headers.data() + 0x3C, sizeof(peOffset));
+		if (peOffset > headers.size() - 0x54)
+			return 0;
+		std::memcpy(&signature, headers.data() + peOffset, sizeof(signature));
+		std::memcpy(&imageSize, headers.data() + peOffset + 0x50, sizeof(imageSize));
+		return signature == 0x00004550 ? imageSize : 0;
+	}
+	// The image as one buffer; what isn't readable stays zero
+	static std::vector<uint8_t> readImage(RemoteMemory& process, uint32_t moduleBase, uint32_t imageSize)
+	{
+		std::vector<uint8_t> image(imageSize);
+		uint64_t imageEnd = uint64_t(moduleBase) + imageSize;
+		for (const MemoryRegion& region : process.regions())
+		{
+			uint64_t start = std::max<uint64_t>(region.base, moduleBase);
+			uint64_t end = (std::min)(region.base + region.size, imageEnd);
+			if (start < end)
+				process.read(start, image.data() + (start - moduleBase), static_cast<size_t>(end - start));
+		}
+		return image;
+	}
+
+	std::string getCachePath(uint64_t key) const
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "%016llx.txt", static_cast<unsigned long long>(key));
+		return (std::filesystem::path(cacheDirectory) / name).string();
+	}
+	// Only a cache with every signature in it counts
+	bool loadCache(const std::string& path, Addresses& addresses) const
+	{
+		std::ifstream file(path);
+		if (!file.is_open())
+			return false;
+		std::string name, value;
+		while (file >> name >> value)
+			addresses[name] = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 0));
+		for (const Signature& signature : signatures)
+		{
+			if (addresses.count(signature.name) == 0)
+			{
+				addresses.clear();
+				return false;
+			}
+		}
+		logOption_->LogMessage(LogLevel::Log_Info, "Addresses loaded from", path);
+		return true;
+	}
+	void saveCache(const std::string& path, const Addresses& addresses) const
+	{
+		std::error_code error;
+		std::filesystem::create_directories(cacheDirectory, error);
+		std::ofstream file(path);
+		if (!file.is_open())
+		{
+			logOption_->LogMessage(LogLevel::Log_Warning, "Can't write", path);
+			return;
+		}
+		for (const auto& [name, address] : addresses)
+		{
+			char value[16];
+			std::snprintf(value, sizeof(value), "0x%08X", address);
+			file << name << " " << value << "\n";
+		}
+	}
+};
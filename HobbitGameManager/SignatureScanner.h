@@ -0,0 +1,190 @@
+#pragma once
+#include <array>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+
+// A byte pattern with wildcards, written as in "8B 0D ?? ?? ?? ?? 85 C9"
+struct Signature
+{
+	std::string name;
+	std::vector<uint8_t> bytes;
+	std::vector<uint8_t> wildcard;  // 1 where any byte matches
+	size_t operandOffset = 0;       // where the address sits in a match
+
+	// Fails on bad bytes and on patterns without a single fixed byte
+	static bool parse(const std::string& pattern, Signature& signature)
+	{
+		signature.bytes.clear();
+		signature.wildcard.clear();
+		std::istringstream tokens(pattern);
+		std::string token;
+		bool anyFixed = false;
+		while (tokens >> token)
+		{
+			if (token == "?" || token == "??")
+			{
+				signature.bytes.push_back(0);
+				signature.wildcard.push_back(1);
+				continue;
+			}
+			char* end = nullptr;
+			unsigned long value = std::strtoul(token.c_str(), &end, 16);
+			if (token.size() != 2 || *end != '\0' || value > 0xFF)
+				return false;
+			signature.bytes.push_back(static_cast<uint8_t>(value));
+			signature.wildcard.push_back(0);
+			anyFixed = true;
+		}
+		return anyFixed;
+	}
+	bool matches(const uint8_t* data) const
+	{
+		for (size_t i = 0; i < bytes.size(); ++i)
+		{
+			if (!wildcard[i] && data[i] != bytes[i])
+				return false;
+		}
+		return true;
+	}
+};
+
+// Finds every signature in one pass over a buffer. The longest run of fixed
+// bytes of each signature goes into an Aho-Corasick automaton; where one of
+// those runs ends, the whole signature is compared around it.
+class SignatureScanner
+{
+public:
+	void add(const Signature& signature)
+	{
+		Anchor anchor;
+		for (size_t start = 0; start < signature.bytes.size();)
+		{
+			if (signature.wildcard[start])
+			{
+				++start;
+				continue;
+			}
+			size_t end = start;
+			while (end < signature.bytes.size() && !signature.wildcard[end])
+				++end;
+			if (end - start > anchor.size)
+			{
+				anchor.offset = start;
+				anchor.size = end - start;
+			}
+			start = end;
+		}
+		signatures.push_back(signature);
+		anchors.push_back(anchor);
+		built = false;
+	}
+	size_t size() const
+	{
+		return signatures.size();
+	}
+
+	// Addresses where each signature matches, at most maxMatches of each;
+	// base is the address of data[0]
+	std::vector<std::vector<uint64_t>> scan(const uint8_t* data, size_t size, uint64_t base, size_t maxMatches = 2)
+	{
+		if (!built)
+			build();
+
+		std::vector<std::vector<uint64_t>> found(signatures.size());
+		int32_t state = 0;
+		for (size_t i = 0; i < size; ++i)
+		{
+			state = nodes[state].next[data[i]];
+			for (size_t index : nodes[state].output)
+			{
+				// The anchor ends at i; the signature starts before it
+				size_t anchorEnd = anchors[index].offset + anchors[index].size;
+				if (i + 1 < anchorEnd)
+					continue;
+				size_t start = i + 1 - anchorEnd;
+				const Signature& signature = signatures[index];
+				if (start + signature.bytes.size() > size || found[index].size() >= maxMatches)
+					continue;
+				if (signature.matches(data + start))
+					found[index].push_back(base + start);
+			}
+		}
+		return found;
+	}
+
+private:
+	struct Anchor
+	{
+		size_t offset = 0;
+		size_t size = 0;
+	};
+	struct Node
+	{
+		std::array<int32_t, 256> next;
+		int32_t fail = 0;
+		std::vector<size_t> output;   // signatures whose anchor ends here
+	};
+
+	std::vector<Signature> signatures;
+	std::vector<Anchor> anchors;
+	std::vector<Node> nodes;
+	bool built = false;
+
+	// Trie of the anchors, then every missing transition filled in from the
+	// failure links, so scanning is one table lookup per byte
+	void build()
+	{
+		nodes.assign(1, Node());
+		nodes[0].next.fill(-1);
+		for (size_t index = 0; index < signatures.size(); ++index)
+		{
+			int32_t state = 0;
+			for (size_t i = 0; i < anchors[index].size; ++i)
+			{
+				uint8_t byte = signatures[index].bytes[anchors[index].offset + i];
+				if (nodes[state].next[byte] < 0)
+				{
+					nodes[state].next[byte] = static_cast<int32_t>(nodes.size());
+					nodes.emplace_back();
+					nodes.back().next.fill(-1);
+				}
+				state = nodes[state].next[byte];
+			}
+			nodes[state].output.push_back(index);
+		}
+
+		std::queue<int32_t> pending;
+		for (int32_t& child : nodes[0].next)
+		{
+			if (child < 0)
+				child = 0;
+			else
+				pending.push(child);
+		}
+		while (!pending.empty())
+		{
+			int32_t state = pending.front();
+			pending.pop();
+			for (size_t byte = 0; byte < 256; ++byte)
+			{
+				int32_t child = nodes[state].next[byte];
+				int32_t fallback = nodes[nodes[state].fail].next[byte];
+				if (child < 0)
+				{
+					nodes[state].next[byte] = fallback;
+					continue;
+				}
+				nodes[child].fail = fallback;
+				const std::vector<size_t>& inherited = nodes[fallback].output;
+				nodes[child].output.insert(nodes[child].output.end(), inherited.begin(), inherited.end());
+				pending.push(child);
+			}
+		}
+		built = true;
+	}
+};
@@ -0,0 +1,305 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstring>
+#include "RemoteMemory.h"
+
+// Remote pages copied once per tick. Between beginTick() and endTick() the
+// first read that touches a page fetches the whole page, and every later read
+// of it in the same tick is served from the copy. Outside a tick, and for big
+// reads like pattern searches, reads go straight to the process.
+//
+// Writes invalidate the pages they touch, so a read after a write sees it.
+// The game keeps running during a tick; what the cache gives is one
+// consistent copy of each page per tick, no fresher than the first read.
+class TickCache : public RemoteMemory
+{
+public:
+	static const uint64_t PAGE_SIZE = 0x1000;
+	// Reads bigger than this bypass the cache
+	static const size_t MAX_CACHED_READ = 4 * PAGE_SIZE;
+
+	struct Stats
+	{
+		uint64_t hits = 0;          // reads served from copies only
+		uint64_t misses = 0;        // reads that had to fetch a page first
+		uint64_t pageFetches = 0;
+		uint64_t bypasses = 0;      // reads outside a tick, too big, or on pages that can't be read
+		uint64_t invalidations = 0; // pages dropped by writes
+	};
+
+	explicit TickCache(std::shared_ptr<RemoteMemory> process) : process(std::move(process))
+	{
+
+	}
+
+	// Tick boundaries; both drop every copy
+	void beginTick()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dropAll();
+		inTick = true;
+	}
+	void endTick()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dropAll();
+		inTick = false;
+	}
+	void invalidate(uint64_t address, size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		drop(address, size);
+	}
+	void invalidateAll()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		dropAll();
+	}
+	// Regions fetched whole, in one call, as soon as any of them is read in a tick
+	void setHotRegions(std::vector<MemoryRegion> regions)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		hotRegions = std::move(regions);
+	}
+
+	Stats getStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return stats;
+	}
+	void resetStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stats = Stats();
+	}
+	std::shared_ptr<RemoteMemory> getProcess() const
+	{
+		return process;
+	}
+
+	bool read(uint64_t address, void* buffer, size_t size) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (isCacheable(size))
+			{
+				bool fetched = fetchMissing(&address, &size, 1);
+				if (copyOut(address, buffer, size))
+				{
+					++(fetched ? stats.misses : stats.hits);
+					return true;
+				}
+			}
+			++stats.bypasses;
+		}
+		return process->read(address, buffer, size);
+	}
+	// Pages missing for any request of the batch are fetched in one batch of their own
+	size_t readBatch(ReadRequest* requests, size_t count) override
+	{
+		std::vector<size_t> bypassed;
+		size_t succeeded = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!inTick)
+			{
+				stats.bypasses += count;
+				return process->readBatch(requests, count);
+			}
+
+			std::vector<uint64_t> addresses;
+			std::vector<size_t> sizes;
+			std::vector<bool> copied(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (isCacheable(requests[i].size))
+				{
+					copied[i] = isCopied(requests[i].address, requests[i].size);
+					addresses.push_back(requests[i].address);
+					sizes.push_back(requests[i].size);
+				}
+			}
+			fetchMissing(addresses.data(), sizes.data(), addresses.size());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				ReadRequest& request = requests[i];
+				request.ok = isCacheable(request.size) && copyOut(request.address, request.buffer, request.size);
+				if (request.ok)
+				{
+					++(copied[i] ? stats.hits : stats.misses);
+					++succeeded;
+				}
+				else
+				{
+					++stats.bypasses;
+					bypassed.push_back(i);
+				}
+			}
+		}
+		for (size_t i : bypassed)
+		{
+			requests[i].ok = process->read(requests[i].address, requests[i].buffer, requests[i].size);
+			succeeded += requests[i].ok;
+		}
+		return succeeded;
+	}
+	bool write(uint64_t address, const void* data, size_t size) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			drop(address, size);
+		}
+		return process->write(address, data, size);
+	}
+	size_t writeBatch(WriteRequest* requests, size_t count) override
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t i = 0; i < count; ++i)
+				drop(requests[i].address, requests[i].size);
+		}
+		return process->writeBatch(requests, count);
+	}
+
+	std::vector<MemoryRegion> regions() override
+	{
+		return process->regions();
+	}
+	bool isAlive() override
+	{
+		return process->isAlive();
+	}
+	int lastError() const override
+	{
+		return process->lastError();
+	}
+	const char* name() const override
+	{
+		return process->name();
+	}
+
+private:
+	using Page = std::array<uint8_t, PAGE_SIZE>;
+
+	std::shared_ptr<RemoteMemory> process;
+	std::mutex mutex;
+	bool inTick = false;
+
+	// Page number -> index into pool; the pool's buffers are reused every tick
+	std::unordered_map<uint64_t, size_t> pages;
+	std::vector<std::unique_ptr<Page>> pool;
+	size_t poolUsed = 0;
+	std::unordered_set<uint64_t> unreadable;
+
+	std::vector<MemoryRegion> hotRegions;
+	Stats stats;
+
+	bool isCacheable(size_t size) const
+	{
+		return inTick && size > 0 && size <= MAX_CACHED_READ;
+	}
+
+	// Fetches the pages of these ranges that aren't copied yet, with the hot
+	// regions they fall in, in one batch. Returns whether anything was fetched.
+	bool fetchMissing(const uint64_t* addresses, const size_t* sizes, size_t count)
+	{
+		std::vector<uint64_t> missing;
+		auto want = [&](uint64_t page)
+			{
+				if (pages.count(page) == 0 && unreadable.count(page) == 0 && std::find(missing.begin(), missing.end(), page) == missing.end())
+					missing.push_back(page);
+			};
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint64_t first = addresses[i] / PAGE_SIZE;
+			uint64_t last = (addresses[i] + sizes[i] - 1) / PAGE_SIZE;
+			for (uint64_t page = first; page <= last; ++page)
+			{
+				if (pages.count(page) != 0)
+					continue;
+				for (const MemoryRegion& region : hotRegions)
+				{
+					if (page * PAGE_SIZE < region.base + region.size && region.base < (page + 1) * PAGE_SIZE)
+					{
+						for (uint64_t hot = region.base / PAGE_SIZE; hot <= (region.base + region.size - 1) / PAGE_SIZE; ++hot)
+							want(hot);
+					}
+				}
+				want(page);
+			}
+		}
+		if (missing.empty())
+			return false;
+
+		std::vector<ReadRequest> requests(missing.size());
+		for (size_t i = 0; i < missing.size(); ++i)
+		{
+			if (poolUsed == pool.size())
+				pool.push_back(std::make_unique<Page>());
+			pages[missing[i]] = poolUsed;
+			requests[i].address = missing[i] * PAGE_SIZE;
+			requests[i].buffer = pool[poolUsed]->data();
+			requests[i].size = PAGE_SIZE;
+			++poolUsed;
+		}
+		process->readBatch(requests.data(), requests.size());
+		stats.pageFetches += missing.size();
+
+		// Pages that can't be read are left out for the rest of the tick; reads touching them bypass
+		for (size_t i = 0; i < missing.size(); ++i)
+		{
+			if (!requests[i].ok)
+			{
+				pages.erase(missing[i]);
+				unreadable.insert(missing[i]);
+			}
+		}
+		return true;
+	}
+	bool isCopied(uint64_t address, size_t size) const
+	{
+		for (uint64_t page = address / PAGE_SIZE; page <= (address + size - 1) / PAGE_SIZE; ++page)
+		{
+			if (pages.count(page) == 0)
+				return false;
+		}
+		return true;
+	}
+	bool copyOut(uint64_t address, void* buffer, size_t size)
+	{
+		uint8_t* out = static_cast<uint8_t*>(buffer);
+		while (size > 0)
+		{
+			auto page = pages.find(address / PAGE_SIZE);
+			if (page == pages.end())
+				return false;
+			size_t offset = static_cast<size_t>(address % PAGE_SIZE);
+			size_t chunk = (std::min)(size, static_cast<size_t>(PAGE_SIZE) - offset);
+			std::memcpy(out, pool[page->second]->data() + offset, chunk);
+			out += chunk;
+			address += chunk;
+			size -= chunk;
+		}
+		return true;
+	}
+	void drop(uint64_t address, size_t size)
+	{
+		if (size == 0)
+			return;
+		for (uint64_t page = address / PAGE_SIZE; page <= (address + size - 1) / PAGE_SIZE; ++page)
+			stats.invalidations += pages.erase(page);
+	}
+	void dropAll()
+	{
+		pages.clear();
+		unreadable.clear();
+		poolUsed = 0;
+	}
+};
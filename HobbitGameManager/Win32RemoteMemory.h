@@ -0,0 +1,237 @@
+#pragma once
+#ifdef _WIN32
+#include <winsock2.h>   // Ensure winsock2.h is included before Windows.h
+#include <Windows.h>
+#include <memoryapi.h>
+#include <TlHelp32.h>
+
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "RemoteMemory.h"
+
+// The game process through ReadProcessMemory/WriteProcessMemory. The
+// protection of each region is queried once and kept; accesses to pages that
+// already allow them go straight through, the rest open the protection
+// around the access as the analyzer always did.
+class Win32RemoteMemory : public RemoteMemory
+{
+public:
+	explicit Win32RemoteMemory(HANDLE process) : process(process)
+	{
+
+	}
+	~Win32RemoteMemory()
+	{
+		CloseHandle(process);
+	}
+
+	// Returns the ID of the first process with this executable name, 0 if there is none
+	static DWORD findProcess(const char* processName)
+	{
+		HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+		if (snapshot == INVALID_HANDLE_VALUE)
+			return 0;
+
+		WCHAR wProcessName[MAX_PATH];
+		MultiByteToWideChar(CP_ACP, 0, processName, -1, wProcessName, MAX_PATH);
+
+		DWORD pid = 0;
+		PROCESSENTRY32 pe32;
+		pe32.dwSize = sizeof(PROCESSENTRY32); // you need this as windows API may evole and have different size for ProcessEntry32
+		if (Process32First(snapshot, &pe32))
+		{
+			do
+			{
+				if (wcscmp(pe32.szExeFile, wProcessName) == 0)
+				{
+					pid = pe32.th32ProcessID;
+					break;
+				}
+			} while (Process32Next(snapshot, &pe32));
+		}
+		CloseHandle(snapshot);
+		return pid;
+	}
+	static std::shared_ptr<Win32RemoteMemory> open(DWORD pid)
+	{
+		HANDLE processHandle = OpenProcess(PROCESS_ALL_ACCESS, FALSE, pid);
+		if (processHandle == NULL)
+			return nullptr;
+		return std::make_shared<Win32RemoteMemory>(processHandle);
+	}
+
+	bool read(uint64_t address, void* buffer, size_t size) override
+	{
+		LPVOID remote = reinterpret_cast<LPVOID>(static_cast<uintptr_t>(address));
+		if (hasProtection(address, size, READABLE))
+		{
+			if (ReadProcessMemory(process, remote, buffer, size, NULL))
+				return true;
+			forgetProtection(address);
+		}
+
+		// Change memory protection to PAGE_READWRITE
+		return accessUnprotected(address, size, PAGE_READWRITE, [&](LPVOID chunk, size_t offset, size_t chunkSize)
+			{
+				return ReadProcessMemory(process, chunk, static_cast<uint8_t*>(buffer) + offset, chunkSize, NULL);
+			});
+	}
+	bool write(uint64_t address, const void* data, size_t size) override
+	{
+		LPVOID remote = reinterpret_cast<LPVOID>(static_cast<uintptr_t>(address));
+		if (hasProtection(address, size, WRITABLE))
+		{
+			if (WriteProcessMemory(process, remote, data, size, NULL))
+				return true;
+			forgetProtection(address);
+		}
+
+		//change protection for the slelcted memory to read and write
+		return accessUnprotected(address, size, PAGE_EXECUTE_READWRITE, [&](LPVOID chunk, size_t offset, size_t chunkSize)
+			{
+				return WriteProcessMemory(process, chunk, static_cast<const uint8_t*>(data) + offset, chunkSize, NULL);
+			});
+	}
+	// A read can cost three calls, so nearby reads are merged into spans
+	size_t readBatch(ReadRequest* requests, size_t count) override
+	{
+		return readCoalesced(requests, count);
+	}
+
+	std::vector<MemoryRegion> regions() override
+	{
+		SYSTEM_INFO sysInfo;
+		GetSystemInfo(&sysInfo);
+
+		std::vector<MemoryRegion> found;
+		MEMORY_BASIC_INFORMATION mbi;
+		SIZE_T address = 0;
+		while (address < (SIZE_T)sysInfo.lpMaximumApplicationAddress && VirtualQueryEx(process, (LPCVOID)address, &mbi, sizeof(mbi)))
+		{
+			// Check if the memory region is readable
+			if (mbi.State == MEM_COMMIT && (mbi.Protect & PAGE_READONLY || mbi.Protect & PAGE_READWRITE || mbi.Protect & PAGE_EXECUTE_READ))
+			{
+				MemoryRegion region;
+				region.base = address;
+				region.size = mbi.RegionSize;
+				region.writable = (mbi.Protect & PAGE_READWRITE) != 0;
+				found.push_back(region);
+			}
+			address += mbi.RegionSize; // Move to the next memory region
+		}
+		return found;
+	}
+	bool isAlive() override
+	{
+		return WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+	}
+
+	int lastError() const override
+	{
+		return static_cast<int>(lastErrorCode);
+	}
+	const char* name() const override
+	{
+		return "win32";
+	}
+
+private:
+	static constexpr DWORD READABLE = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY
+		| PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+	static constexpr DWORD WRITABLE = PAGE_READWRITE | PAGE_EXECUTE_READWRITE;
+
+	struct Protection
+	{
+		uint64_t end = 0;
+		DWORD protect = PAGE_NOACCESS;
+	};
+
+	HANDLE process;
+	std::atomic<DWORD> lastErrorCode{ 0 };
+	// Region base -> its protection, from VirtualQueryEx
+	std::mutex protectionMutex;
+	std::map<uint64_t, Protection> protections;
+
+	// Whether the range lies in one region with any of these protections.
+	// The game rarely changes them; when an access fails anyway the region is
+	// queried again on the next one.
+	bool hasProtection(uint64_t address, size_t size, DWORD flags)
+	{
+		std::lock_guard<std::mutex> lock(protectionMutex);
+		const Protection* found = protectionAt(address);
+		return found && address + size <= found->end && (found->protect & flags) != 0 && (found->protect & PAGE_GUARD) == 0;
+	}
+	// Coalesced reads stay in one region, so they take the fast path above
+	uint64_t regionEnd(uint64_t address) override
+	{
+		std::lock_guard<std::mutex> lock(protectionMutex);
+		const Protection* found = protectionAt(address);
+		return found ? found->end : address;
+	}
+	// The cached region holding the address, queried if it isn't known yet.
+	// Called with protectionMutex held.
+	const Protection* protectionAt(uint64_t address)
+	{
+		auto region = protections.upper_bound(address);
+		if (region != protections.begin() && std::prev(region)->second.end > address)
+			return &std::prev(region)->second;
+
+		MEMORY_BASIC_INFORMATION mbi;
+		if (!VirtualQueryEx(process, reinterpret_cast<LPCVOID>(static_cast<uintptr_t>(address)), &mbi, sizeof(mbi)))
+			return nullptr;
+		uint64_t base = reinterpret_cast<uintptr_t>(mbi.BaseAddress);
+		Protection protection;
+		protection.end = base + mbi.RegionSize;
+		protection.protect = mbi.State == MEM_COMMIT ? mbi.Protect : PAGE_NOACCESS;
+		return &protections.insert_or_assign(base, protection).first->second;
+	}
+	// Runs the access region by region with the protection changed, putting
+	// back each region's own protection after: VirtualProtectEx only reports
+	// the old protection of the first page, so one call can't restore a range
+	// over several regions
+	template <typename Access>
+	bool accessUnprotected(uint64_t address, size_t size, DWORD newProtect, Access access)
+	{
+		uint64_t end = address + size;
+		for (uint64_t at = address; at < end;)
+		{
+			MEMORY_BASIC_INFORMATION mbi;
+			LPVOID remote = reinterpret_cast<LPVOID>(static_cast<uintptr_t>(at));
+			if (!VirtualQueryEx(process, remote, &mbi, sizeof(mbi)))
+				return fail();
+			uint64_t chunkEnd = (std::min)(end, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(mbi.BaseAddress) + mbi.RegionSize));
+			size_t chunkSize = static_cast<size_t>(chunkEnd - at);
+
+			DWORD oldProtect;
+			if (!VirtualProtectEx(process, remote, chunkSize, newProtect, &oldProtect))
+				return fail();
+			bool ok = access(remote, static_cast<size_t>(at - address), chunkSize);
+			DWORD error = GetLastError();
+			VirtualProtectEx(process, remote, chunkSize, oldProtect, &oldProtect);
+			if (!ok)
+			{
+				lastErrorCode = error;
+				return false;
+			}
+			at = chunkEnd;
+		}
+		return true;
+	}
+	void forgetProtection(uint64_t address)
+	{
+		std::lock_guard<std::mutex> lock(protectionMutex);
+		auto region = protections.upper_bound(address);
+		if (region != protections.begin() && std::prev(region)->second.end > address)
+			protections.erase(std::prev(region));
+	}
+
+	bool fail()
+	{
+		lastErrorCode = GetLastError();
+		return false;
+	}
+};
+#endif
@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstring>
+#include "RemoteMemory.h"
+
+// Writes held back until the end of a tick. Between beginTick() and flush()
+// writes only go into a buffer, where writes that overlap or touch are
+// merged: x, y and z written one after another reach the game as one span,
+// and a value written twice is written once. Reads see the buffered bytes.
+//
+// The bytes last written to the game are kept. At the flush, a span that is
+// the same as what was last written there is compared with the game first,
+// all of them in one batched read, and left out unless the game changed it
+// since; everything else is written in one batch. Outside a tick writes go
+// straight through. Over a TickCache, end its tick before flushing, or the
+// comparison sees the page as it was when the tick read it.
+class WriteBackCache : public RemoteMemory
+{
+public:
+	// Bytes of last-written values kept; past this they are all dropped
+	static constexpr size_t MAX_WRITTEN_BYTES = 64 * 1024;
+
+	struct Stats
+	{
+		uint64_t writes = 0;        // writes buffered in ticks
+		uint64_t spans = 0;         // spans written by flushes
+		uint64_t verified = 0;      // spans read back because they were written before
+		uint64_t skipped = 0;       // of those, spans the game still held
+		uint64_t failed = 0;        // spans that couldn't be written
+	};
+
+	explicit WriteBackCache(std::shared_ptr<RemoteMemory> process) : process(std::move(process))
+	{
+
+	}
+
+	void beginTick()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		inTick = true;
+	}
+	// Writes what the tick buffered and ends it. Returns how many spans failed.
+	size_t flush()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		inTick = false;
+		Ranges spans;
+		spans.swap(pending);
+		if (spans.empty())
+			return 0;
+
+		std::vector<WriteRequest> writes;
+		std::vector<Ranges::const_iterator> unchanged;
+		for (auto span = spans.cbegin(); span != spans.cend(); ++span)
+		{
+			if (wasWritten(span->first, span->second))
+				unchanged.push_back(span);
+			else
+				writes.push_back(WriteRequest{ span->first, span->second.data(), span->second.size() });
+		}
+
+		if (!unchanged.empty())
+		{
+			std::vector<std::vector<uint8_t>> current(unchanged.size());
+			std::vector<ReadRequest> reads(unchanged.size());
+			for (size_t i = 0; i < unchanged.size(); ++i)
+			{
+				current[i].resize(unchanged[i]->second.size());
+				reads[i].address = unchanged[i]->first;
+				reads[i].buffer = current[i].data();
+				reads[i].size = current[i].size();
+			}
+			process->readBatch(reads.data(), reads.size());
+			stats.verified += unchanged.size();
+			for (size_t i = 0; i < unchanged.size(); ++i)
+			{
+				if (reads[i].ok && current[i] == unchanged[i]->second)
+				{
+					++stats.skipped;
+					continue;
+				}
+				writes.push_back(WriteRequest{ unchanged[i]->first, unchanged[i]->second.data(), unchanged[i]->second.size() });
+			}
+		}
+		if (writes.empty())
+			return 0;
+
+		size_t succeeded = process->writeBatch(writes.data(), writes.size());
+		stats.spans += writes.size();
+		stats.failed += writes.size() - succeeded;
+		for (const WriteRequest& write : writes)
+		{
+			if (write.ok)
+				remember(write.address, static_cast<const uint8_t*>(write.data), write.size);
+			else
+				forget(write.address, write.size);
+		}
+		return writes.size() - succeeded;
+	}
+	// Forgets what was written, so every span of the next flush is written
+	void invalidate()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		written.clear();
+		writtenBytes = 0;
+	}
+
+	Stats getStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return stats;
+	}
+	void resetStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stats = Stats();
+	}
+
+	bool read(uint64_t address, void* buffer, size_t size) override
+	{
+		if (!process->read(address, buffer, size))
+			return false;
+		std::lock_guard<std::mutex> lock(mutex);
+		overlay(address, static_cast<uint8_t*>(buffer), size);
+		return true;
+	}
+	size_t readBatch(ReadRequest* requests, size_t count) override
+	{
+		size_t succeeded = process->readBatch(requests, count);
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!pending.empty())
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (requests[i].ok)
+					overlay(requests[i].address, static_cast<uint8_t*>(requests[i].buffer), requests[i].size);
+			}
+		}
+		return succeeded;
+	}
+	bool write(uint64_t address, const void* data, size_t size) override
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (inTick)
+			{
+				if (size > 0)
+					merge(pending, address, bytes, size);
+				++stats.writes;
+				return true;
+			}
+		}
+		bool ok = process->write(address, data, size);
+		std::lock_guard<std::mutex> lock(mutex);
+		if (ok)
+			remember(address, bytes, size);
+		else
+			forget(address, size);
+		return ok;
+	}
+
+	std::vector<MemoryRegion> regions() override
+	{
+		return process->regions();
+	}
+	bool isAlive() override
+	{
+		return process->isAlive();
+	}
+	int lastError() const override
+	{
+		return process->lastError();
+	}
+	const char* name() const override
+	{
+		return process->name();
+	}
+
+private:
+	// Disjoint byte ranges by start address
+	using Ranges = std::map<uint64_t, std::vector<uint8_t>>;
+
+	std::shared_ptr<RemoteMemory> process;
+	std::mutex mutex;
+	bool inTick = false;
+	Ranges pending;
+	Ranges written;
+	size_t writtenBytes = 0;
+	Stats stats;
+
+	// Puts the bytes into ranges, merged with the ranges they overlap or
+	// touch. Returns by how many bytes the ranges grew.
+	static size_t merge(Ranges& ranges, uint64_t address, const uint8_t* data, size_t size)
+	{
+		uint64_t start = address;
+		uint64_t end = address + size;
+		auto first = ranges.upper_bound(address);
+		if (first != ranges.begin() && std::prev(first)->first + std::prev(first)->second.size() >= address)
+			--first;
+		auto last = first;
+		size_t replaced = 0;
+		for (; last != ranges.end() && last->first <= end; ++last)
+		{
+			start = (std::min)(start, last->first);
+			end = (std::max)(end, last->first + last->second.size());
+			replaced += last->second.size();
+		}
+
+		std::vector<uint8_t> merged(static_cast<size_t>(end - start));
+		for (auto range = first; range != last; ++range)
+			std::memcpy(merged.data() + (range->first - start), range->second.data(), range->second.size());
+		std::memcpy(merged.data() + (address - start), data, size);
+		ranges.erase(first, last);
+		ranges.emplace(start, std::move(merged));
+		return static_cast<size_t>(end - start) - replaced;
+	}
+	// Copies the buffered bytes over what was read
+	void overlay(uint64_t address, uint8_t* buffer, size_t size) const
+	{
+		auto range = pending.upper_bound(address);
+		if (range != pending.begin())
+			--range;
+		for (; range != pending.end() && range->first < address + size; ++range)
+		{
+			uint64_t start = (std::max)(address, range->first);
+			uint64_t end = (std::min)(address + size, range->first + range->second.size());
+			if (start < end)
+				std::memcpy(buffer + (start - address), range->second.data() + (start - range->first), static_cast<size_t>(end - start));
+		}
+	}
+
+	bool wasWritten(uint64_t address, const std::vector<uint8_t>& bytes) const
+	{
+		auto range = written.upper_bound(address);
+		if (range == written.begin())
+			return false;
+		--range;
+		if (range->first + range->second.size() < address + bytes.size())
+			return false;
+		return std::memcmp(range->second.data() + (address - range->first), bytes.data(), bytes.size()) == 0;
+	}
+	void remember(uint64_t address, const uint8_t* data, size_t size)
+	{
+		if (size == 0)
+			return;
+		writtenBytes += merge(written, address, data, size);
+		if (writtenBytes > MAX_WRITTEN_BYTES)
+		{
+			written.clear();
+			writtenBytes = 0;
+		}
+	}
+	// After a failed write the game holds who knows what there
+	void forget(uint64_t address, size_t size)
+	{
+		auto range = written.upper_bound(address);
+		if (range != written.begin() && std::prev(range)->first + std::prev(range)->second.size() > address)
+			--range;
+		while (range != written.end() && range->first < address + size)
+		{
+			writtenBytes -= range->second.size();
+			range = written.erase(range);
+		}
+	}
+};
@@ -24,6 +24,7 @@
 #define IDC_CHECKBOX_PLAYER_LEVEL    2003
 #define IDC_CHECKBOX_INVENTORY       2004
 #define IDC_CHECKBOX_BILBO_ZERO_DAMAGE      2005
+#define IDC_CHECKBOX_SNAPSHOT_MESH   2006
 
 // Global Variables
 HINSTANCE hInst;
@@ -43,6 +44,7 @@ HWND hCheckEnemyHealth = nullptr;
 HWND hCheckPlayerLevel = nullptr;
 HWND hCheckInventory = nullptr;
 HWND hCheckBilbo0Damage = nullptr;
+HWND hCheckSnapshotMesh = nullptr;
 
 // UI State
 enum UIState { UI_FIRST, UI_SECOND };
@@ -176,6 +178,13 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 			(HMENU)IDC_JOIN_SERVER_BTN, hInst, nullptr
 		);
 
+		hCheckSnapshotMesh = CreateWindowW(
+			L"BUTTON", L"Direct P2P Snapshots",
+			WS_CHILD | WS_VISIBLE | BS_AUTOCHECKBOX,
+			50, 140, 200, 20, hWnd,
+			(HMENU)IDC_CHECKBOX_SNAPSHOT_MESH, hInst, nullptr
+		);
+
 		hExitServerBtn = CreateWindowW(
 			L"BUTTON", L"Exit Server",
 			WS_CHILD | BS_PUSHBUTTON,
@@ -260,9 +269,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 		// Main UI Logic
 		if (currentUI == UI_FIRST) {
 			if (wmId == IDC_CREATE_SERVER) {
+				hobbitMultiplayer.setSnapshotMesh(SendMessage(hCheckSnapshotMesh, BM_GETCHECK, 0, 0) == BST_CHECKED);
 				serverThread = std::thread([&]() { hobbitMultiplayer.startServerClient(); });
 				currentUI = UI_SECOND;
 				ShowWindow(hCreateServerBtn, SW_HIDE);
+				ShowWindow(hCheckSnapshotMesh, SW_HIDE);
 				ShowWindow(hJoinServerLabel, SW_HIDE);
 				ShowWindow(hJoinServerEdit, SW_HIDE);
 				ShowWindow(hJoinServerBtn, SW_HIDE);
@@ -279,9 +290,11 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				GetWindowTextW(hJoinServerEdit, buffer, 256);
 				std::string serverAddress(buffer, buffer + wcslen(buffer));
 
+				hobbitMultiplayer.setSnapshotMesh(SendMessage(hCheckSnapshotMesh, BM_GETCHECK, 0, 0) == BST_CHECKED);
 				serverThread = std::thread([&]() { hobbitMultiplayer.startClient(serverAddress); });
 				currentUI = UI_SECOND;
 				ShowWindow(hCreateServerBtn, SW_HIDE);
+				ShowWindow(hCheckSnapshotMesh, SW_HIDE);
 				ShowWindow(hJoinServerLabel, SW_HIDE);
 				ShowWindow(hJoinServerEdit, SW_HIDE);
 				ShowWindow(hJoinServerBtn, SW_HIDE);
@@ -305,6 +318,7 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
 				ShowWindow(hJoinServerLabel, SW_SHOW);
 				ShowWindow(hJoinServerEdit, SW_SHOW);
 				ShowWindow(hJoinServerBtn, SW_SHOW);
+				ShowWindow(hCheckSnapshotMesh, SW_SHOW);
 				ShowWindow(hCheckPlayerSnap, SW_HIDE);
 				ShowWindow(hCheckEnemyHealth, SW_HIDE);
 				ShowWindow(hCheckPlayerLevel, SW_HIDE);
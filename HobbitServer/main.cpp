@@ -0,0 +1,169 @@
+// Headless dedicated server: runs only the relay, without the game or the menu.
+//
+// Usage: HobbitServer [--config file] [--port N] [--tick-rate N] [--workers N]
+//                     [--max-clients N] [--log-level debug|info|warning|error]
+//                     [--capture file] [--metrics-port N] [--metrics-address ip]
+//
+// The config file holds the same settings as key=value lines (port, tick-rate,
+// workers, max-clients, log-level, capture, metrics-port, metrics-address);
+// '#' starts a comment. Options given on the command line override the file.
+
+#include <atomic>
+#include <csignal>
+#include <fstream>
+#include <map>
+
+#include "../ServerClient/Server.h"
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void onStopSignal(int) {
+    stopRequested = true;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+bool readConfigFile(const std::string& path, std::map<std::string, std::string>& settings) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line = trim(line.substr(0, line.find('#')));
+        size_t equals = line.find('=');
+        if (line.empty() || equals == std::string::npos)
+            continue;
+        settings[trim(line.substr(0, equals))] = trim(line.substr(equals + 1));
+    }
+    return true;
+}
+
+bool parseNumber(const std::string& text, unsigned long min, unsigned long max, unsigned long& value) {
+    try {
+        size_t used = 0;
+        value = std::stoul(text, &used);
+        return used == text.size() && value >= min && value <= max;
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool parseLogLevel(const std::string& text, LogLevel& level) {
+    static const std::map<std::string, LogLevel> levels = {
+        { "debug", LogLevel::Log_Debug },
+        { "info", LogLevel::Log_Info },
+        { "warning", LogLevel::Log_Warning },
+        { "error", LogLevel::Log_Error },
+    };
+    auto it = levels.find(text);
+    if (it == levels.end())
+        return false;
+    level = it->second;
+    return true;
+}
+
+bool applySettings(const std::map<std::string, std::string>& settings, ServerConfig& config, LogLevel& logLevel, LogOption::Ptr log) {
+    for (const auto& setting : settings) {
+        const std::string& key = setting.first;
+        const std::string& value = setting.second;
+        unsigned long number = 0;
+
+        if (key == "port" && parseNumber(value, 1, 65535, number))
+            config.port = static_cast<uint16_t>(number);
+        else if (key == "tick-rate" && parseNumber(value, 1, 1000, number))
+            config.tickInterval = std::chrono::milliseconds(1000 / number);
+        else if (key == "workers" && parseNumber(value, 0, 64, number))
+            config.workerThreads = number;
+        else if (key == "max-clients" && parseNumber(value, 1, MAX_CLIENTS, number))
+            config.maxClients = number;
+        else if (key == "capture" && !value.empty())
+            config.capturePath = value;
+        else if (key == "metrics-port" && parseNumber(value, 0, 65535, number))
+            config.metricsPort = static_cast<uint16_t>(number);
+        else if (key == "metrics-address" && !value.empty())
+            config.metricsAddress = value;
+        else if (key == "log-level" && parseLogLevel(value, logLevel))
+            continue;
+        else {
+            log->LogMessage(LogLevel::Log_Error, "Invalid setting", key, "=", value);
+            return false;
+        }
+    }
+    return true;
+}
+
+void printUsage() {
+    std::cout << "Usage: HobbitServer [--config file] [--port N] [--tick-rate N] [--workers N]\n"
+              << "                    [--max-clients N] [--log-level debug|info|warning|error]\n"
+              << "                    [--capture file] [--metrics-port N] [--metrics-address ip]\n"
+              << "  --port         TCP port to listen on (default " << PORT << ")\n"
+              << "  --tick-rate    merged event ticks per second (default " << 1000 / SERVER_TICK.count() << ")\n"
+              << "  --workers      socket send threads, 0 sends inline (default 0)\n"
+              << "  --max-clients  room size limit, 1-" << MAX_CLIENTS << " (default " << MAX_CLIENTS << ")\n"
+              << "  --capture      record every received frame for CaptureReplay\n"
+              << "  --metrics-port serve Prometheus metrics on http://127.0.0.1:N/metrics (default off)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    LogOption::Ptr log = LogManager::Instance().CreateLogOption("HOBBIT SERVER");
+
+    std::map<std::string, std::string> fileSettings;
+    std::map<std::string, std::string> argSettings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (arg.rfind("--", 0) != 0 || i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--config") {
+            if (!readConfigFile(value, fileSettings)) {
+                log->LogMessage(LogLevel::Log_Error, "Can't read config file", value);
+                return 1;
+            }
+        }
+        else {
+            argSettings[arg.substr(2)] = value;
+        }
+    }
+
+    ServerConfig config;
+    LogLevel logLevel = LogLevel::Log_Info;
+    if (!applySettings(fileSettings, config, logLevel, log) || !applySettings(argSettings, config, logLevel, log))
+        return 1;
+    LogManager::Instance().SetGlobalLogLevel(logLevel);
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    Server server(config);
+    if (!server.start())
+        return 1;
+    log->LogMessage(LogLevel::Log_Info, "Tick", config.tickInterval.count(), "ms, workers", config.workerThreads,
+        ", max clients", config.maxClients);
+
+    while (!stopRequested && server.getIsRunning()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    server.stop();
+    log->LogMessage(LogLevel::Log_Info, "Server stopped");
+    return 0;
+}
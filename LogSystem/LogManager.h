@@ -75,14 +75,24 @@ public:
 	void resetDapth() { depth = 0; }
 
 	void setColor(std::string color) {
+#ifdef _WIN32
 		HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
 		if (color == "GREEN") SetConsoleTextAttribute(hConsole, FOREGROUND_GREEN | FOREGROUND_INTENSITY);
 		else if (color == "RED") SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_INTENSITY);
 		else if (color == "BLUE") SetConsoleTextAttribute(hConsole, FOREGROUND_BLUE | FOREGROUND_INTENSITY);
+#else
+		if (color == "GREEN") std::cout << "\033[92m";
+		else if (color == "RED") std::cout << "\033[91m";
+		else if (color == "BLUE") std::cout << "\033[94m";
+#endif
 	}
 	void resetColor() {
+#ifdef _WIN32
 		HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
 		SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+#else
+		std::cout << "\033[0m";
+#endif
 	}
 
 private:
@@ -0,0 +1,167 @@
+#include "AsyncClient.h"
+
+using asio::ip::tcp;
+
+AsyncClient::AsyncClient(asio::io_context& ioContext)
+    : ClientMessageHandler("ASYNC CLIENT"), ioContext(ioContext), socket(ioContext),
+    writeSignal(ioContext, asio::steady_timer::time_point::max()), connectTimer(ioContext),
+    isConnected(false), stopRequested(false), outstanding(0) {}
+
+AsyncClient::~AsyncClient() {
+    stop();
+    // Everything cancelled by stop() still has to run once, with this alive
+    while (outstanding > 0) {
+        if (ioContext.stopped())
+            ioContext.restart();
+        ioContext.run_one();
+    }
+}
+
+void AsyncClient::start(const std::string& serverIP, uint16_t port, std::chrono::milliseconds connectTimeout) {
+    stopRequested = false;
+    spawn(run(serverIP, port, connectTimeout));
+}
+
+// Also aborts a connect in progress, before isConnected is set
+void AsyncClient::stop() {
+    stopRequested = true;
+    isConnected = false;
+    closeSocket();
+}
+
+void AsyncClient::sendMessage(const BaseMessage& msg) {
+    // Length prefix and body go into one buffer so the writer issues a single write per frame
+    std::vector<uint8_t> frame(sizeof(uint32_t));
+    BaseMessage::serializeMessage(msg, frame);
+    uint32_t msgSize = htonl(static_cast<uint32_t>(frame.size() - sizeof(uint32_t)));
+    std::memcpy(frame.data(), &msgSize, sizeof(msgSize));
+
+    ++outstanding;
+    asio::post(ioContext, [this, frame = std::move(frame)]() mutable {
+        writeQueue.push_back(std::move(frame));
+        writeSignal.cancel_one();
+        --outstanding;
+    });
+}
+
+asio::awaitable<void> AsyncClient::run(std::string serverIP, uint16_t port, std::chrono::milliseconds connectTimeout) {
+    bool connected = co_await connect(serverIP, port, connectTimeout);
+    // A connect aborted by stop() isn't reported
+    if (stopRequested)
+        co_return;
+    if (connectListener)
+        connectListener(connected);
+    if (!connected)
+        co_return;
+
+    sendMessage(helloMessage());
+    spawn(writeLoop());
+    co_await readLoop();
+}
+
+void AsyncClient::spawn(asio::awaitable<void> coroutine) {
+    ++outstanding;
+    asio::co_spawn(ioContext, std::move(coroutine), [this](std::exception_ptr) { --outstanding; });
+}
+
+asio::awaitable<bool> AsyncClient::connect(const std::string& serverIP, uint16_t port, std::chrono::milliseconds connectTimeout) {
+    std::error_code ec;
+    asio::ip::address address = asio::ip::make_address(serverIP, ec);
+    if (ec) {
+        logOption_->LogMessage(LogLevel::Log_Error, "", "Invalid server address", serverIP);
+        co_return false;
+    }
+
+    // Closing the socket when the timer fires aborts the pending connect
+    connectTimer.expires_after(connectTimeout);
+    ++outstanding;
+    connectTimer.async_wait([this](std::error_code timerEc) {
+        if (!timerEc)
+            closeSocket();
+        --outstanding;
+        });
+
+    auto [connectEc] = co_await socket.async_connect(tcp::endpoint(address, port), asio::as_tuple(asio::use_awaitable));
+    connectTimer.cancel();
+
+    if (stopRequested) {
+        closeSocket();
+        co_return false;
+    }
+    if (connectEc) {
+        logOption_->LogMessage(LogLevel::Log_Error, "", "Cannot connect to server", connectEc.message());
+        closeSocket();
+        co_return false;
+    }
+
+    socket.set_option(tcp::no_delay(true), ec);
+    isConnected = true;
+    logOption_->LogMessage(LogLevel::Log_Info, "", "Connected to server");
+    co_return true;
+}
+
+asio::awaitable<void> AsyncClient::readLoop() {
+    std::vector<uint8_t> buffer;
+    while (isConnected) {
+        uint32_t msgSize;
+        auto [headerEc, headerBytes] = co_await asio::async_read(socket, asio::buffer(&msgSize, sizeof(msgSize)),
+            asio::as_tuple(asio::use_awaitable));
+        if (headerEc)
+            break;
+        msgSize = ntohl(msgSize);
+
+        buffer.resize(msgSize);
+        auto [bodyEc, bodyBytes] = co_await asio::async_read(socket, asio::buffer(buffer),
+            asio::as_tuple(asio::use_awaitable));
+        if (bodyEc)
+            break;
+
+        BaseMessage* msg = BaseMessage::deserializeMessage(buffer);
+        if (msg) {
+            dispatchMessage(msg);
+            delete msg;
+        }
+    }
+
+    if (isConnected) {
+        logOption_->LogMessage(LogLevel::Log_Error, "", "Server is down or connection lost.");
+        notifyServerDown();
+    }
+}
+
+asio::awaitable<void> AsyncClient::writeLoop() {
+    while (isConnected) {
+        if (writeQueue.empty()) {
+            // Woken up by sendMessage() or closeSocket() cancelling the timer
+            co_await writeSignal.async_wait(asio::as_tuple(asio::use_awaitable));
+            continue;
+        }
+
+        // Gather everything queued so far into one write
+        std::deque<std::vector<uint8_t>> frames;
+        frames.swap(writeQueue);
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(frames.size());
+        for (const auto& frame : frames)
+            buffers.push_back(asio::buffer(frame));
+
+        auto [ec, bytes] = co_await asio::async_write(socket, buffers, asio::as_tuple(asio::use_awaitable));
+        if (ec)
+            break;
+    }
+}
+
+void AsyncClient::closeSocket() {
+    std::error_code ec;
+    socket.shutdown(tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+    writeSignal.cancel();
+    connectTimer.cancel();
+}
+
+void AsyncClient::notifyServerDown() {
+    isConnected = false;
+    closeSocket();
+    logOption_->LogMessage(LogLevel::Log_Info, "", "Disconnected from server. Please check the server status.");
+    updateClientList(std::queue<uint8_t>());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Requires C++20 (asio awaitables)
+#include <asio.hpp>
+
+#include "ClientMessageHandler.h"
+#define PORT 54000
+
+// Client built on asio coroutines. It owns no threads: connect, the framed
+// read loop and the write queue all run on the io_context passed in, which the
+// host drives (io_context::poll() from its update loop, or run() on a thread
+// it already has).
+//
+// sendMessage() only queues the frame and never blocks. The message accessors
+// inherited from ClientMessageHandler are thread safe. start(), stop() and the
+// destructor must be called from the thread that drives the io_context; the
+// destructor runs the io_context until every coroutine of the client is done.
+class AsyncClient : public ClientMessageHandler {
+public:
+	using ConnectListener = std::function<void(bool connected)>;
+
+	AsyncClient(asio::io_context& ioContext);
+	~AsyncClient();
+
+	void start(const std::string& serverIP, uint16_t port = PORT,
+		std::chrono::milliseconds connectTimeout = std::chrono::seconds(5));
+	void stop();
+
+	void sendMessage(const BaseMessage& msg) override;
+
+	bool getIsConnected() const { return isConnected; }
+	// Called once the connect attempt finished, with the result
+	void setConnectListener(ConnectListener listener) { connectListener = std::move(listener); }
+
+private:
+	asio::io_context& ioContext;
+	asio::ip::tcp::socket socket;
+	asio::steady_timer writeSignal;
+	asio::steady_timer connectTimer;
+	std::deque<std::vector<uint8_t>> writeQueue;
+	std::atomic<bool> isConnected;
+	std::atomic<bool> stopRequested;
+	// Coroutines and handlers still holding this; the destructor waits for them
+	std::atomic<size_t> outstanding;
+	ConnectListener connectListener;
+
+	asio::awaitable<void> run(std::string serverIP, uint16_t port, std::chrono::milliseconds connectTimeout);
+	asio::awaitable<bool> connect(const std::string& serverIP, uint16_t port, std::chrono::milliseconds connectTimeout);
+	asio::awaitable<void> readLoop();
+	asio::awaitable<void> writeLoop();
+
+	void spawn(asio::awaitable<void> coroutine);
+	void closeSocket();
+	void notifyServerDown();
+};
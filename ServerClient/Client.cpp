@@ -1,7 +1,7 @@
-#include "Client.h"
+﻿#include "Client.h"
 
-Client::Client() : isConnected(false), logOption_(LogManager::Instance().CreateLogOption("CLIENT")) {}
-Client::Client(std::string serverIP) : isConnected(false), logOption_(LogManager::Instance().CreateLogOption("CLIENT")) {
+Client::Client() : ClientMessageHandler("CLIENT"), isConnected(false) {}
+Client::Client(std::string serverIP) : ClientMessageHandler("CLIENT"), isConnected(false) {
     if (!connectToServer(serverIP)) {
         std::cerr << "Failed to connect to server.\n";
     }
@@ -34,158 +34,347 @@ void Client::stop() {
 }
 
 bool Client::connectToServer(const std::string& serverIP) {
+    // A receive thread left from an earlier connection is done with it first
+    if (receiveThread.joinable())
+        disconnect();
 #ifdef _WIN32
     WSADATA wsData;
-    WSAStartup(MAKEWORD(2, 2), &wsData);
+    if (!socketsStarted)
+        WSAStartup(MAKEWORD(2, 2), &wsData);
 #endif
+    socketsStarted = true;
+
+    this->serverIP = serverIP;
+    localChannel.reset();
+    stopRequested = false;
+    if (meshEnabled && !openMesh()) {
+        logOption_->LogMessage(LogLevel::Log_Warning, "", "Snapshot mesh unavailable, using the server only");
+    }
+    if (!openConnection()) {
+        closeMesh();
+        return false;
+    }
+
+    isConnected = true;
+    receiveThread = std::thread(&Client::receiveMessages, this);
+    logOption_->LogMessage(LogLevel::Log_Info, "", "Connected to server");
+    return true;
+}
 
-    serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket == INVALID_SOCKET) {
+bool Client::connectLocal(std::shared_ptr<LocalChannel> channel) {
+    if (receiveThread.joinable())
+        disconnect();
+#ifdef _WIN32
+    WSADATA wsData;
+    if (!socketsStarted)
+        WSAStartup(MAKEWORD(2, 2), &wsData);
+#endif
+    socketsStarted = true;
+
+    serverIP.clear();
+    stopRequested = false;
+    if (meshEnabled && !openMesh()) {
+        logOption_->LogMessage(LogLevel::Log_Warning, "", "Snapshot mesh unavailable, using the server only");
+    }
+
+    localChannel = channel;
+    sendMessage(helloMessage());
+
+    isConnected = true;
+    receiveThread = std::thread(&Client::receiveMessages, this);
+    logOption_->LogMessage(LogLevel::Log_Info, "", "Connected to local server");
+    return true;
+}
+
+bool Client::openConnection() {
+    SOCKET newSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (newSocket == INVALID_SOCKET) {
         logOption_->LogMessage(LogLevel::Log_Error, "", "Issues creating socket");
         return false;
     }
 
     sockaddr_in serverHint{};
     serverHint.sin_family = AF_INET;
-    serverHint.sin_port = htons(PORT);
+    serverHint.sin_port = htons(serverPort);
     inet_pton(AF_INET, serverIP.c_str(), &serverHint.sin_addr);
 
-    if (connect(serverSocket, (sockaddr*)&serverHint, sizeof(serverHint)) == SOCKET_ERROR) {
+    if (connect(newSocket, (sockaddr*)&serverHint, sizeof(serverHint)) == SOCKET_ERROR) {
         logOption_->LogMessage(LogLevel::Log_Error, "", "Cannot connect to server");
+        closesocket(newSocket);
         return false;
     }
 
-    isConnected = true;
-    receiveThread = std::thread(&Client::receiveMessages, this);
-    receiveThread.detach();
-    logOption_->LogMessage(LogLevel::Log_Info, "", "Connected to server");
+    int noDelay = 1;
+    setsockopt(newSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
+
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        serverSocket = newSocket;
+    }
+    sendMessage(helloMessage());
     return true;
 }
 
+void Client::closeServerSocket() {
+    std::lock_guard<std::mutex> lock(sendMutex);
+    SOCKET socket = serverSocket.exchange(INVALID_SOCKET);
+    if (socket == INVALID_SOCKET)
+        return;
+    shutdown(socket, 2);
+    closesocket(socket);
+}
+
+bool Client::resumeConnection() {
+    closeServerSocket();
+
+    // Retry with exponential backoff for as long as the server keeps our slot
+    auto deadline = std::chrono::steady_clock::now() + RESUME_TIMEOUT;
+    std::chrono::milliseconds backoff(100);
+    while (!stopRequested && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(backoff);
+        if (stopRequested)
+            break;
+
+        logOption_->LogMessage(LogLevel::Log_Info, "", "Trying to resume session...");
+        if (openConnection()) {
+            logOption_->LogMessage(LogLevel::Log_Info, "", "Reconnected to server");
+            return true;
+        }
+        backoff = (std::min)(backoff * 2, std::chrono::milliseconds(2000));
+    }
+    return false;
+}
+
 void Client::disconnect() {
-    isConnected = false;
-    if (receiveThread.joinable())
-        receiveThread.join();
-    else
+    bool wasConnected = isConnected.exchange(false);
+    stopRequested = true;
+    // Tells the server we are gone for good, so it doesn't keep our slot for a resume.
+    // Only once stopped: the server closing the link must not look like a lost connection.
+    if (wasConnected)
+        sendMessage(BaseMessage(CLIENT_LEAVE_MESSAGE, clientID));
+
+    // Unblocks the receive thread, which then exits without trying to resume.
+    // Runs even after the server went down: the mesh and winsock are still ours.
+    if (localChannel) {
+        localChannel->close();
+    }
+    else {
+        closeServerSocket();
+    }
+    // Nothing may touch the client once this returns, e.g. from ~Client
+    if (receiveThread.joinable()) {
+        if (receiveThread.get_id() == std::this_thread::get_id())
+            receiveThread.detach();
+        else
+            receiveThread.join();
+    }
+    closeMesh();
+    if (!socketsStarted)
         return;
-    closesocket(serverSocket);
+    socketsStarted = false;
 #ifdef _WIN32
     WSACleanup();
 #endif
 }
 
 void Client::receiveMessages() {
+    std::vector<uint8_t> buffer;
     while (isConnected) {
-        uint32_t msgSize;
-        int bytesReceived = recv(serverSocket, (char*)&msgSize, sizeof(msgSize), 0);
-        if (bytesReceived <= 0) {
+        if (!receiveFrame(buffer)) {
+            if (stopRequested)
+                break;
+
+            logOption_->LogMessage(LogLevel::Log_Warning, "", "Connection lost.");
+            // A local server going away is final, there is nothing to reconnect to
+            if (!localChannel && resumeConnection())
+                continue;
+
             logOption_->LogMessage(LogLevel::Log_Error, "", "Server is down or connection lost.");
             notifyServerDown();
             break;
         }
-        msgSize = ntohl(msgSize);
-
-        std::vector<uint8_t> buffer(msgSize);
-        size_t totalReceived = 0;
-        while (totalReceived < msgSize) {
-            bytesReceived = recv(serverSocket, (char*)buffer.data() + totalReceived, msgSize - totalReceived, 0);
-            if (bytesReceived <= 0) break;
-            totalReceived += bytesReceived;
-        }
-        if (bytesReceived <= 0) break;
 
         BaseMessage* msg = BaseMessage::deserializeMessage(buffer);
         if (msg) {
-            if (msg->messageType == CLIENT_LIST_MESSAGE) {
-                updateClientList(msg->message);
-            }
-            else {
-                sortMessageByType(msg);
-            }
+            dispatchMessage(msg);
             delete msg;
         }
     }
-    disconnect();
+}
+
+bool Client::receiveFrame(std::vector<uint8_t>& buffer) {
+    if (localChannel)
+        return localChannel->toClient.pop(buffer);
+
+    uint32_t msgSize;
+    size_t totalReceived = 0;
+    while (totalReceived < sizeof(msgSize)) {
+        int bytesReceived = recv(serverSocket, (char*)&msgSize + totalReceived, sizeof(msgSize) - totalReceived, 0);
+        if (bytesReceived <= 0) return false;
+        totalReceived += bytesReceived;
+    }
+    msgSize = ntohl(msgSize);
+
+    buffer.resize(msgSize);
+    totalReceived = 0;
+    while (totalReceived < msgSize) {
+        int bytesReceived = recv(serverSocket, (char*)buffer.data() + totalReceived, msgSize - totalReceived, 0);
+        if (bytesReceived <= 0) return false;
+        totalReceived += bytesReceived;
+    }
+    return true;
 }
 
 void Client::sendMessage(const BaseMessage& msg) {
     std::vector<uint8_t> buffer;
     BaseMessage::serializeMessage(msg, buffer);
+
+    if (msg.messageType == SNAPSHOT_MESSAGE && meshSocket != INVALID_SOCKET) {
+        auto now = std::chrono::steady_clock::now();
+        if (sendMeshSnapshot(buffer) && now - lastRelayedSnapshot < MESH_RELAY_INTERVAL)
+            return;
+        lastRelayedSnapshot = now;
+    }
+
+    // The update thread and the receive thread (list requests) both send
+    std::lock_guard<std::mutex> lock(sendMutex);
+    if (localChannel) {
+        localChannel->toServer.pushWait(std::move(buffer));
+        return;
+    }
+    SOCKET socket = serverSocket;
+    if (socket == INVALID_SOCKET)
+        return;
+    // Length prefix and body in one send, so they leave in one segment
+    std::vector<uint8_t> frame(sizeof(uint32_t) + buffer.size());
     uint32_t msgSize = htonl(buffer.size());
-    send(serverSocket, (char*)&msgSize, sizeof(msgSize), 0);
-    send(serverSocket, (char*)buffer.data(), buffer.size(), 0);
-}
-
-void Client::sortMessageByType(BaseMessage* msg) {
-    std::lock_guard<std::mutex> lock(messageMutex);
-    switch (msg->messageType) {
-    case TEXT_MESSAGE:
-        textMessages.push_back(*msg);
-        break;
-    case EVENT_MESSAGE:
-        eventMessages.push_back(*msg);
-        break;
-    case SNAPSHOT_MESSAGE:
-        snapshotMessages[msg->senderID] = *msg;
-        break;
-    case CLIENT_ID_MESSAGE:
-        clientID = msg->senderID;
-        logOption_->LogMessage(LogLevel::Log_Debug, "", "Assigned client ID: ", int(clientID));
-        break;
-    }
-}
-
-void Client::updateClientList(const std::queue<uint8_t>& data) {
-    std::queue<uint8_t> temp = data;
-    std::vector<ClientInfo> clientInfos;
-
-    while (!temp.empty()) {
-        ClientInfo info;
-        if (temp.empty()) break;
-        info.clientID = temp.front();
-        temp.pop();
-
-        if (temp.empty()) break;
-        uint8_t ipLen = temp.front();
-        temp.pop();
-
-        std::string ip;
-        for (int i = 0; i < ipLen; ++i) {
-            if (temp.empty()) break;
-            ip += static_cast<char>(temp.front());
-            temp.pop();
-        }
-        info.ipAddress = ip;
+    std::memcpy(frame.data(), &msgSize, sizeof(msgSize));
+    std::memcpy(frame.data() + sizeof(msgSize), buffer.data(), buffer.size());
 
-        if (temp.size() < 2) break;
-        uint8_t b1 = temp.front(); temp.pop();
-        uint8_t b2 = temp.front(); temp.pop();
-        info.port = ntohs((b1 << 8) | b2);
+    size_t totalSent = 0;
+    while (totalSent < frame.size()) {
+        int bytesSent = send(socket, (char*)frame.data() + totalSent, frame.size() - totalSent, MSG_NOSIGNAL);
+        if (bytesSent <= 0) return;
+        totalSent += bytesSent;
+    }
+}
+
+bool Client::openMesh() {
+    SOCKET newSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (newSocket == INVALID_SOCKET)
+        return false;
 
-        clientInfos.push_back(info);
+    sockaddr_in hint{};
+    hint.sin_family = AF_INET;
+    hint.sin_port = 0;
+    hint.sin_addr.s_addr = INADDR_ANY;
+    socklen_t hintSize = sizeof(hint);
+    if (bind(newSocket, (sockaddr*)&hint, sizeof(hint)) == SOCKET_ERROR ||
+        getsockname(newSocket, (sockaddr*)&hint, &hintSize) == SOCKET_ERROR) {
+        closesocket(newSocket);
+        return false;
     }
 
-    std::lock_guard<std::mutex> lock(messageMutex);
-    connectedClientsInfo.clear();
-    for (const auto& info : clientInfos) {
-        connectedClientsInfo[info.clientID] = info;
+    {
+        std::lock_guard<std::mutex> lock(meshMutex);
+        meshLastAcked.clear();
+        meshSocket = newSocket;
     }
+    meshPort = ntohs(hint.sin_port);
+    meshThread = std::thread(&Client::receiveMeshMessages, this, newSocket);
+    logOption_->LogMessage(LogLevel::Log_Info, "", "Snapshot mesh on UDP port", meshPort);
+    return true;
+}
 
-    std::queue<uint8_t> clientIDs;
-    for (const auto& pair : connectedClientsInfo) {
-        clientIDs.push(pair.first);
+void Client::closeMesh() {
+    SOCKET socket;
+    {
+        std::lock_guard<std::mutex> lock(meshMutex);
+        socket = meshSocket.exchange(INVALID_SOCKET);
+        if (socket != INVALID_SOCKET)
+            shutdown(socket, 2);
     }
-    for (const auto& listener : listeners) {
-        listener(clientIDs);
+    // Closed once the receive thread is gone, so it never reads a reused descriptor
+    if (meshThread.joinable())
+        meshThread.join();
+    if (socket != INVALID_SOCKET)
+        closesocket(socket);
+    meshPort = 0;
+}
+
+void Client::receiveMeshMessages(SOCKET socket) {
+    std::vector<uint8_t> buffer(MESH_MAX_DATAGRAM);
+    while (!stopRequested) {
+        sockaddr_in from{};
+        socklen_t fromSize = sizeof(from);
+        int bytesReceived = recvfrom(socket, (char*)buffer.data(), buffer.size(), 0, (sockaddr*)&from, &fromSize);
+        if (bytesReceived <= 0)
+            break;
+
+        // Only snapshots and acks from peers in the client list, at the endpoint the server gave us
+        BaseMessage* msg = BaseMessage::deserializeMessage(std::vector<uint8_t>(buffer.begin(), buffer.begin() + bytesReceived));
+        if (!msg)
+            continue;
+        char fromIP[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &from.sin_addr, fromIP, INET_ADDRSTRLEN);
+        bool known = false;
+        for (const ClientInfo& peer : getPeers()) {
+            if (peer.clientID == msg->senderID && peer.udpPort == ntohs(from.sin_port) && peer.ipAddress == fromIP) {
+                known = true;
+                break;
+            }
+        }
+
+        if (known && msg->messageType == SNAPSHOT_MESSAGE) {
+            std::vector<uint8_t> ack;
+            BaseMessage::serializeMessage(BaseMessage(MESH_ACK_MESSAGE, clientID), ack);
+            sendto(socket, (const char*)ack.data(), ack.size(), 0, (sockaddr*)&from, fromSize);
+            dispatchMessage(msg);
+        }
+        else if (known && msg->messageType == MESH_ACK_MESSAGE) {
+            std::lock_guard<std::mutex> lock(meshMutex);
+            meshLastAcked[msg->senderID] = std::chrono::steady_clock::now();
+        }
+        delete msg;
     }
 }
 
-void Client::addListener(std::function<void(const std::queue<uint8_t>&)> listener) {
-    listeners.push_back(listener);
+bool Client::sendMeshSnapshot(const std::vector<uint8_t>& buffer) {
+    if (buffer.size() > MESH_MAX_DATAGRAM)
+        return false;
+    auto now = std::chrono::steady_clock::now();
+    bool allDirect = true;
+    std::vector<ClientInfo> peers = getPeers();
+    std::lock_guard<std::mutex> lock(meshMutex);
+    SOCKET socket = meshSocket;
+    if (socket == INVALID_SOCKET)
+        return false;
+    for (const ClientInfo& peer : peers) {
+        if (peer.udpPort == 0) {
+            allDirect = false;
+            continue;
+        }
+
+        sockaddr_in peerHint{};
+        peerHint.sin_family = AF_INET;
+        peerHint.sin_port = htons(peer.udpPort);
+        inet_pton(AF_INET, peer.ipAddress.c_str(), &peerHint.sin_addr);
+        sendto(socket, (const char*)buffer.data(), buffer.size(), 0, (sockaddr*)&peerHint, sizeof(peerHint));
+
+        // Hearing their snapshots isn't enough: the path to them may be blocked
+        auto acked = meshLastAcked.find(peer.clientID);
+        if (acked == meshLastAcked.end() || now - acked->second > MESH_PEER_TIMEOUT)
+            allDirect = false;
+    }
+    return allDirect;
 }
 
 void Client::notifyServerDown() {
     isConnected = false;
+    if (localChannel)
+        localChannel->close();
+    else
+        closeServerSocket();
     logOption_->LogMessage(LogLevel::Log_Info, "", "Disconnected from server. Please check the server status.");
     updateClientList(std::queue<uint8_t>());
 }
\ No newline at end of file
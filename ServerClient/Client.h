@@ -16,13 +16,26 @@
 #include <cassert>
 #include <memory>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 
 #include "platform-specific.h"
 #include "Message.h"
+#include "ClientMessageHandler.h"
+#include "LocalChannel.h"
 #include "../LogSystem/LogManager.h"
 #define PORT 54000
 
-class Client {
+// How long a client keeps trying to resume its session after the link drops
+const std::chrono::milliseconds RESUME_TIMEOUT(8000);
+// Snapshot mesh: a peer counts as directly reachable while it acks our snapshots this often
+const std::chrono::milliseconds MESH_PEER_TIMEOUT(1000);
+// Largest UDP payload; bigger snapshots always go through the server
+const size_t MESH_MAX_DATAGRAM = 65507;
+// Even with every peer direct, a snapshot goes through the server this often for its keyframe
+const std::chrono::milliseconds MESH_RELAY_INTERVAL(1000);
+
+class Client : public ClientMessageHandler {
 public:
 	Client();
 	Client(std::string serverIP);
@@ -33,50 +46,49 @@ public:
 	void stop();
 
 	bool connectToServer(const std::string& serverIP);
+	// Joins a server in the same process through the channel from Server::attachLocalClient
+	bool connectLocal(std::shared_ptr<LocalChannel> channel);
 	void disconnect();
 
-	void updateClientList(const std::queue<uint8_t>& data);
-	void addListener(std::function<void(const std::queue<uint8_t>&)> listener);
-
-	void sendMessage(const BaseMessage& msg);
-
-	BaseMessage frontTextMessage() {
-		if (textMessages.size() > 0)
-			return textMessages.front();
-		else
-			return BaseMessage(-1, -1);
-	}
-	BaseMessage frontEventMessage() {
-		if (eventMessages.size() > 0)
-			return eventMessages.front();
-		else
-			return BaseMessage(-1, -1);
-	}
-	std::map<uint8_t, BaseMessage> snapMessage() { return snapshotMessages; }
-
-	void popFrontTextMessage() { textMessages.pop_front(); }
-	void popFrontEventMessage() { eventMessages.pop_front(); }
-	uint32_t eventMessagesSize() { return eventMessages.size(); }
-	void clearSnapMessage() { snapshotMessages.clear(); }
-
-	uint8_t getClientID() { return clientID; }
-	const std::map<uint8_t, ClientInfo>& getConnectedClients() const { return connectedClientsInfo; }
+	void sendMessage(const BaseMessage& msg) override;
 
 	void notifyServerDown();
 
+	// Optional snapshot mesh, set before connecting: snapshots go straight to
+	// peers over UDP, events stay on the server. Snapshots still go through the
+	// server while any peer hasn't been heard from directly.
+	void enableMesh(bool enable) { meshEnabled = enable; }
+	// TCP port of the server, set before connecting (dedicated servers can run on another one)
+	void setServerPort(uint16_t port) { serverPort = port; }
+
 private:
-	LogOption::Ptr logOption_;
-	SOCKET serverSocket = 0;
+	std::string serverIP;
+	uint16_t serverPort = PORT;
+	std::atomic<SOCKET> serverSocket = INVALID_SOCKET;
 	std::thread receiveThread;
-	std::mutex messageMutex;
-	bool isConnected;
-	uint8_t clientID = -1;
-	std::map<uint8_t, ClientInfo> connectedClientsInfo;
-	std::deque<BaseMessage> textMessages;
-	std::deque<BaseMessage> eventMessages;
-	std::map<uint8_t, BaseMessage> snapshotMessages;
-	std::vector<std::function<void(const std::queue<uint8_t>&)>> listeners;
+	std::atomic<bool> isConnected;
+	std::atomic<bool> stopRequested = false;
+	std::shared_ptr<LocalChannel> localChannel;
+	std::mutex sendMutex;
+	bool socketsStarted = false;
+
+	bool meshEnabled = false;
+	// Swapped out and closed under meshMutex, so a send never goes to a closed socket
+	std::atomic<SOCKET> meshSocket = INVALID_SOCKET;
+	std::thread meshThread;
+	std::mutex meshMutex;
+	std::map<uint8_t, std::chrono::steady_clock::time_point> meshLastAcked;
+	std::chrono::steady_clock::time_point lastRelayedSnapshot;
 
+	bool openConnection();
+	// Under sendMutex, so a send never goes to a socket being closed or reused
+	void closeServerSocket();
+	bool openMesh();
+	void closeMesh();
+	void receiveMeshMessages(SOCKET socket);
+	// Returns true if every peer is reachable directly
+	bool sendMeshSnapshot(const std::vector<uint8_t>& buffer);
+	bool resumeConnection();
 	void receiveMessages();
-	void sortMessageByType(BaseMessage* msg);
+	bool receiveFrame(std::vector<uint8_t>& buffer);
 };
\ No newline at end of file
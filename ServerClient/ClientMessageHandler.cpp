@@ -0,0 +1,172 @@
+#include "ClientMessageHandler.h"
+
+void ClientMessageHandler::dispatchMessage(BaseMessage* msg) {
+    if (msg->messageType == CLIENT_LIST_MESSAGE) {
+        updateClientList(std::move(msg->message));
+    }
+    else if (msg->messageType == CLIENT_JOIN_MESSAGE) {
+        applyClientJoin(msg->message);
+    }
+    else if (msg->messageType == CLIENT_LEAVE_MESSAGE) {
+        applyClientLeave(msg->message);
+    }
+    else {
+        bool gameMessage = msg->messageType == TEXT_MESSAGE || msg->messageType == EVENT_MESSAGE || msg->messageType == SNAPSHOT_MESSAGE;
+        if (!gameMessage || !takeGameMessage(*msg))
+            sortMessageByType(msg);
+    }
+}
+
+void ClientMessageHandler::sortMessageByType(BaseMessage* msg) {
+    std::lock_guard<std::mutex> lock(messageMutex);
+    switch (msg->messageType) {
+    case TEXT_MESSAGE:
+        textMessages.push_back(*msg);
+        break;
+    case EVENT_MESSAGE:
+    case KEYFRAME_MESSAGE:
+        // A keyframe's enemy totals count the events before it, so it stays in line with them
+        eventMessages.push_back(*msg);
+        break;
+    case SNAPSHOT_MESSAGE:
+        snapshotMessages[msg->senderID] = *msg;
+        break;
+    case CLIENT_ID_MESSAGE: {
+        clientID = msg->senderID;
+        popUint64(msg->message, resumeToken);
+        bool resumed = !msg->message.empty() && msg->message.front() != 0;
+        logOption_->LogMessage(LogLevel::Log_Debug, "", resumed ? "Resumed session with client ID: " : "Assigned client ID: ", int(clientID));
+        clientsChanged.notify_all();
+        break;
+    }
+    }
+}
+
+BaseMessage ClientMessageHandler::helloMessage() {
+    std::lock_guard<std::mutex> lock(messageMutex);
+    BaseMessage hello(CLIENT_HELLO_MESSAGE, clientID);
+    pushUint16(hello.message, meshPort);
+    if (resumeToken != 0)
+        pushUint64(hello.message, resumeToken);
+    return hello;
+}
+
+bool ClientMessageHandler::readClientEntry(std::queue<uint8_t>& data, ClientInfo& info) {
+    if (data.empty()) return false;
+    info.clientID = data.front();
+    data.pop();
+
+    if (data.empty()) return false;
+    uint8_t ipLen = data.front();
+    data.pop();
+
+    if (data.size() < ipLen) return false;
+    std::string ip;
+    for (int i = 0; i < ipLen; ++i) {
+        ip += static_cast<char>(data.front());
+        data.pop();
+    }
+    info.ipAddress = ip;
+
+    if (data.size() < 2) return false;
+    uint8_t b1 = data.front(); data.pop();
+    uint8_t b2 = data.front(); data.pop();
+    info.port = ntohs((b1 << 8) | b2);
+
+    return popUint16(data, info.udpPort);
+}
+
+void ClientMessageHandler::updateClientList(std::queue<uint8_t> data) {
+    std::lock_guard<std::mutex> lock(messageMutex);
+    connectedClientsInfo.clear();
+
+    // An empty list means we lost the server, the next full list starts over
+    uint32_t version = 0;
+    hasClientList = popUint32(data, version);
+    clientListVersion = version;
+    clientListRequested = false;
+
+    ClientInfo info;
+    while (readClientEntry(data, info)) {
+        connectedClientsInfo[info.clientID] = info;
+    }
+
+    notifyListeners();
+}
+
+void ClientMessageHandler::applyClientJoin(std::queue<uint8_t>& data) {
+    std::lock_guard<std::mutex> lock(messageMutex);
+
+    uint32_t version = 0;
+    ClientInfo info;
+    if (!popUint32(data, version) || !readClientEntry(data, info))
+        return;
+
+    if (!hasClientList || version != clientListVersion + 1) {
+        logOption_->LogMessage(LogLevel::Log_Debug, "", "Client list out of date, have", clientListVersion, "got", version);
+        requestClientList();
+        return;
+    }
+
+    clientListVersion = version;
+    connectedClientsInfo[info.clientID] = info;
+    notifyListeners();
+}
+
+void ClientMessageHandler::applyClientLeave(std::queue<uint8_t>& data) {
+    std::lock_guard<std::mutex> lock(messageMutex);
+
+    uint32_t version = 0;
+    if (!popUint32(data, version) || data.empty())
+        return;
+    uint8_t leftID = data.front();
+
+    if (!hasClientList || version != clientListVersion + 1) {
+        logOption_->LogMessage(LogLevel::Log_Debug, "", "Client list out of date, have", clientListVersion, "got", version);
+        requestClientList();
+        return;
+    }
+
+    clientListVersion = version;
+    connectedClientsInfo.erase(leftID);
+    notifyListeners();
+}
+
+void ClientMessageHandler::requestClientList() {
+    if (clientListRequested)
+        return;
+    clientListRequested = true;
+    sendMessage(BaseMessage(CLIENT_LIST_REQUEST_MESSAGE, clientID));
+}
+
+void ClientMessageHandler::notifyListeners() {
+    std::queue<uint8_t> clientIDs;
+    for (const auto& pair : connectedClientsInfo) {
+        clientIDs.push(pair.first);
+    }
+    for (const auto& listener : listeners) {
+        listener(clientIDs);
+    }
+    clientsChanged.notify_all();
+}
+
+bool ClientMessageHandler::waitForClients(size_t count, std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(messageMutex);
+    return clientsChanged.wait_until(lock, deadline, [&] {
+        return clientID != static_cast<uint8_t>(-1) && connectedClientsInfo.size() >= count;
+    });
+}
+
+void ClientMessageHandler::addListener(std::function<void(const std::queue<uint8_t>&)> listener) {
+    listeners.push_back(listener);
+}
+
+std::vector<ClientInfo> ClientMessageHandler::getPeers() {
+    std::lock_guard<std::mutex> lock(messageMutex);
+    std::vector<ClientInfo> peers;
+    for (const auto& pair : connectedClientsInfo) {
+        if (pair.first != clientID)
+            peers.push_back(pair.second);
+    }
+    return peers;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include <deque>
+#include <memory>
+
+#include "platform-specific.h"
+#include "Message.h"
+#include "../LogSystem/LogManager.h"
+
+// Client side of the protocol that does not depend on the transport:
+// incoming message queues, the assigned client ID and the versioned client list.
+// Client (blocking sockets + receive thread) and AsyncClient (asio coroutines)
+// only move frames and hand every received message to dispatchMessage().
+class ClientMessageHandler {
+public:
+	virtual ~ClientMessageHandler() {}
+
+	virtual void sendMessage(const BaseMessage& msg) = 0;
+
+	void updateClientList(std::queue<uint8_t> data);
+	void addListener(std::function<void(const std::queue<uint8_t>&)> listener);
+
+	BaseMessage frontTextMessage() {
+		std::lock_guard<std::mutex> lock(messageMutex);
+		if (textMessages.size() > 0)
+			return textMessages.front();
+		else
+			return BaseMessage(-1, -1);
+	}
+	// Event messages, and room keyframes (KEYFRAME_MESSAGE) in the order they arrived between them
+	BaseMessage frontEventMessage() {
+		std::lock_guard<std::mutex> lock(messageMutex);
+		if (eventMessages.size() > 0)
+			return eventMessages.front();
+		else
+			return BaseMessage(-1, -1);
+	}
+	std::map<uint8_t, BaseMessage> snapMessage() {
+		std::lock_guard<std::mutex> lock(messageMutex);
+		return snapshotMessages;
+	}
+
+	void popFrontTextMessage() { std::lock_guard<std::mutex> lock(messageMutex); textMessages.pop_front(); }
+	void popFrontEventMessage() { std::lock_guard<std::mutex> lock(messageMutex); eventMessages.pop_front(); }
+	uint32_t eventMessagesSize() { std::lock_guard<std::mutex> lock(messageMutex); return eventMessages.size(); }
+	void clearSnapMessage() { std::lock_guard<std::mutex> lock(messageMutex); snapshotMessages.clear(); }
+
+	uint8_t getClientID() { return clientID; }
+	const std::map<uint8_t, ClientInfo>& getConnectedClients() const { return connectedClientsInfo; }
+	// Blocks until the server has given us our ID and a client list of at least
+	// count clients, us included; false if the deadline passes first
+	bool waitForClients(size_t count, std::chrono::steady_clock::time_point deadline);
+
+protected:
+	ClientMessageHandler(const std::string& logName) : logOption_(LogManager::Instance().CreateLogOption(logName)) {}
+
+	// Routes a received message to the client list or to the message queues
+	void dispatchMessage(BaseMessage* msg);
+	// First frame on every connection, carries the resume token once we have one
+	BaseMessage helloMessage();
+	// Everyone in the client list but us
+	std::vector<ClientInfo> getPeers();
+	// Sees every text, event and snapshot message before it is queued; return true to
+	// consume it instead (tools that count messages rather than play them)
+	virtual bool takeGameMessage(const BaseMessage&) { return false; }
+
+	LogOption::Ptr logOption_;
+	std::mutex messageMutex;
+	uint8_t clientID = -1;
+	uint64_t resumeToken = 0;
+	uint16_t meshPort = 0;	// announced in the hello, 0 without a snapshot mesh
+
+private:
+	std::map<uint8_t, ClientInfo> connectedClientsInfo;
+	std::condition_variable clientsChanged;	// ID assigned or client list changed
+	uint32_t clientListVersion = 0;
+	bool hasClientList = false;
+	bool clientListRequested = false;
+	std::deque<BaseMessage> textMessages;
+	std::deque<BaseMessage> eventMessages;
+	std::map<uint8_t, BaseMessage> snapshotMessages;
+	std::vector<std::function<void(const std::queue<uint8_t>&)>> listeners;
+
+	void sortMessageByType(BaseMessage* msg);
+
+	void applyClientJoin(std::queue<uint8_t>& data);
+	void applyClientLeave(std::queue<uint8_t>& data);
+	void requestClientList();
+	void notifyListeners();
+	static bool readClientEntry(std::queue<uint8_t>& data, ClientInfo& info);
+};
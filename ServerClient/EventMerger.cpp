@@ -0,0 +1,61 @@
+#include "EventMerger.h"
+
+void EventMerger::add(uint8_t senderID, const GameRecords& records) {
+    if (!records.enemies.empty()) {
+        auto& sender = enemyChanges[senderID];
+        for (const auto& enemy : records.enemies) {
+            sender[enemy.guid] += enemy.healthChange;
+        }
+    }
+    for (const auto& item : records.inventory) {
+        inventory.merge(item);
+        replicaSenders[item.replicaID] = senderID;
+    }
+}
+
+std::vector<BaseMessage> EventMerger::buildFor(uint8_t receiverID) const {
+    std::map<uint64_t, float> enemyTotals;
+    for (const auto& sender : enemyChanges) {
+        if (sender.first == receiverID)
+            continue;
+        for (const auto& enemy : sender.second) {
+            enemyTotals[enemy.first] += enemy.second;
+        }
+    }
+
+    // The receiver's own counters are never older than ours
+    std::vector<InventoryCounterEntry> inventoryEntries;
+    for (const auto& item : inventory.entries()) {
+        auto sender = replicaSenders.find(item.replicaID);
+        if (sender == replicaSenders.end() || sender->second != receiverID)
+            inventoryEntries.push_back(item);
+    }
+
+    // One message per label, the same split the clients use when sending
+    std::vector<BaseMessage> messages;
+    std::vector<uint8_t> body;
+    if (!enemyTotals.empty()) {
+        std::vector<EnemyHealthChange> enemies;
+        for (const auto& enemy : enemyTotals) {
+            enemies.push_back({ enemy.first, enemy.second });
+        }
+        writeEnemiesHealthRecord(body, enemies);
+
+        BaseMessage msg(EVENT_MESSAGE, 0);
+        for (uint8_t byte : body) {
+            msg.message.push(byte);
+        }
+        messages.push_back(std::move(msg));
+    }
+    if (!inventoryEntries.empty()) {
+        body.clear();
+        writeInventoryRecord(body, inventoryEntries);
+
+        BaseMessage msg(EVENT_MESSAGE, 0);
+        for (uint8_t byte : body) {
+            msg.message.push(byte);
+        }
+        messages.push_back(std::move(msg));
+    }
+    return messages;
+}
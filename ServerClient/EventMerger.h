@@ -0,0 +1,33 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "Message.h"
+#include "GameData.h"
+#include "InventoryCounters.h"
+
+// Collects the enemy health and inventory changes the server receives during
+// one tick. Enemy health is summed per sender, inventory counters are merged.
+// At the end of the tick every client gets one consolidated event per label
+// with what everyone but itself did, instead of every sender's event relayed
+// one by one.
+class EventMerger {
+public:
+    void add(uint8_t senderID, const GameRecords& records);
+    bool empty() const { return enemyChanges.empty() && inventory.empty(); }
+    void clear() { enemyChanges.clear(); inventory.clear(); replicaSenders.clear(); }
+
+    // Consolidated events for one receiver; keys only it touched are left out
+    std::vector<BaseMessage> buildFor(uint8_t receiverID) const;
+
+    // sender ID -> GUID -> summed health change
+    const std::map<uint8_t, std::map<uint64_t, float>>& getEnemyChanges() const { return enemyChanges; }
+    // Counters that grew during the tick
+    const InventoryCounters& getInventory() const { return inventory; }
+
+private:
+    std::map<uint8_t, std::map<uint64_t, float>> enemyChanges;
+    InventoryCounters inventory;
+    std::map<uint64_t, uint8_t> replicaSenders;    // replica ID -> client ID that sent its counters this tick
+};
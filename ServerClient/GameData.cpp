@@ -0,0 +1,104 @@
+#include "GameData.h"
+
+#include <algorithm>
+
+bool parseGameRecords(const std::vector<uint8_t>& body, GameRecords& records) {
+    size_t offset = 0;
+    while (offset < body.size()) {
+        size_t recordStart = offset;
+        uint8_t label, size;
+        if (!readRaw(body, offset, label) || !readRaw(body, offset, size))
+            return false;
+        records.labels.push_back(label);
+
+        switch (static_cast<DataLabel>(label)) {
+        case DataLabel::CONNECTED_PLAYER_SNAP:
+            if (offset + PLAYER_SNAP_SIZE > body.size())
+                return false;
+            records.hasPlayerSnap = true;
+            records.playerLevel = body[offset];
+            offset += PLAYER_SNAP_SIZE;
+            break;
+        case DataLabel::ENEMIES_HEALTH: {
+            uint32_t count;
+            if (!readRaw(body, offset, count))
+                return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                EnemyHealthChange enemy;
+                if (!readRaw(body, offset, enemy.guid) || !readRaw(body, offset, enemy.healthChange))
+                    return false;
+                records.enemies.push_back(enemy);
+            }
+            break;
+        }
+        case DataLabel::INVENTORY: {
+            uint32_t count;
+            if (!readRaw(body, offset, count))
+                return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                InventoryCounterEntry item;
+                if (!readRaw(body, offset, item.slot) || !readRaw(body, offset, item.replicaID) ||
+                    !readRaw(body, offset, item.increments) || !readRaw(body, offset, item.decrements))
+                    return false;
+                records.inventory.push_back(item);
+            }
+            break;
+        }
+        default:
+            if (offset + size > body.size())
+                return false;
+            offset += size;
+            records.otherRecords.insert(records.otherRecords.end(), body.begin() + recordStart, body.begin() + offset);
+            break;
+        }
+    }
+    return true;
+}
+
+bool parseGameRecords(const std::queue<uint8_t>& body, GameRecords& records) {
+    std::vector<uint8_t> data;
+    data.reserve(body.size());
+    std::queue<uint8_t> temp = body;
+    while (!temp.empty()) {
+        data.push_back(temp.front());
+        temp.pop();
+    }
+    return parseGameRecords(data, records);
+}
+
+namespace {
+
+// Writes the entries as records of one label, as many as it takes for each
+// record's size byte to hold its real size
+template <typename Entry, typename WriteEntry>
+void writeCountedRecords(std::vector<uint8_t>& body, DataLabel label, const std::vector<Entry>& entries, size_t entrySize, WriteEntry writeEntry) {
+    const size_t perRecord = (MAX_RECORD_SIZE - sizeof(uint32_t)) / entrySize;
+    size_t next = 0;
+    do {
+        size_t count = (std::min)(perRecord, entries.size() - next);
+        body.push_back(static_cast<uint8_t>(label));
+        body.push_back(static_cast<uint8_t>(sizeof(uint32_t) + count * entrySize));
+        appendRaw(body, static_cast<uint32_t>(count));
+        for (size_t i = next; i < next + count; ++i)
+            writeEntry(entries[i]);
+        next += count;
+    } while (next < entries.size());
+}
+
+} // namespace
+
+void writeEnemiesHealthRecord(std::vector<uint8_t>& body, const std::vector<EnemyHealthChange>& enemies) {
+    writeCountedRecords(body, DataLabel::ENEMIES_HEALTH, enemies, sizeof(uint64_t) + sizeof(float), [&body](const EnemyHealthChange& enemy) {
+        appendRaw(body, enemy.guid);
+        appendRaw(body, enemy.healthChange);
+    });
+}
+
+void writeInventoryRecord(std::vector<uint8_t>& body, const std::vector<InventoryCounterEntry>& inventory) {
+    writeCountedRecords(body, DataLabel::INVENTORY, inventory, sizeof(uint8_t) + sizeof(uint64_t) + 2 * sizeof(float), [&body](const InventoryCounterEntry& item) {
+        appendRaw(body, item.slot);
+        appendRaw(body, item.replicaID);
+        appendRaw(body, item.increments);
+        appendRaw(body, item.decrements);
+    });
+}
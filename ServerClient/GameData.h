@@ -0,0 +1,75 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <cstdint>
+#include <cstring>
+
+// Game payload carried inside SNAPSHOT_MESSAGE and EVENT_MESSAGE bodies.
+// The body is a sequence of records: label (uint8), size (uint8), data.
+// Values inside the data are in the sender's (little endian) byte order.
+//
+//   CONNECTED_PLAYER_SNAP - level (uint8), animation (uint32), anim frame,
+//                           last anim frame, x, y, z, rotation y (float), weapon (int8)
+//   ENEMIES_HEALTH        - count (uint32), then count x (GUID (uint64), health change (float))
+//   INVENTORY             - count (uint32), then count x (slot (uint8), replica ID (uint64),
+//                           increments (float), decrements (float)), see InventoryCounters.h
+//
+// A record's size byte always holds its real size, so a reader can skip labels
+// it doesn't handle. Longer enemy and inventory lists go out as several
+// records of their label.
+
+// Enum for data labels
+enum class DataLabel {
+	SERVER = 0,
+	CONNECTED_PLAYER_SNAP = 1,
+	CONNECTED_PLAYER_LEVEL = 2,
+	ENEMIES_HEALTH = 3,
+	INVENTORY = 4
+};
+
+const size_t PLAYER_SNAP_SIZE = 30;
+// Largest record body the size byte can hold
+const size_t MAX_RECORD_SIZE = 0xFF;
+
+struct EnemyHealthChange {
+	uint64_t guid;
+	float healthChange;
+};
+struct InventoryCounterEntry {
+	uint8_t slot;
+	uint64_t replicaID;
+	float increments;
+	float decrements;
+};
+
+// Everything a server needs out of one message body
+struct GameRecords {
+	bool hasPlayerSnap = false;
+	uint8_t playerLevel = 0;
+	std::vector<EnemyHealthChange> enemies;
+	std::vector<InventoryCounterEntry> inventory;
+	std::vector<uint8_t> otherRecords;	// records with any other label, unchanged
+	std::vector<uint8_t> labels;		// label of every record, in order
+};
+
+// Returns false if the body is truncated; records read before that are kept
+bool parseGameRecords(const std::vector<uint8_t>& body, GameRecords& records);
+bool parseGameRecords(const std::queue<uint8_t>& body, GameRecords& records);
+
+// Split into as many records as the size byte needs
+void writeEnemiesHealthRecord(std::vector<uint8_t>& body, const std::vector<EnemyHealthChange>& enemies);
+// Split the same way
+void writeInventoryRecord(std::vector<uint8_t>& body, const std::vector<InventoryCounterEntry>& inventory);
+
+template <typename T>
+void appendRaw(std::vector<uint8_t>& body, const T& value) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+	body.insert(body.end(), bytes, bytes + sizeof(T));
+}
+template <typename T>
+bool readRaw(const std::vector<uint8_t>& body, size_t& offset, T& value) {
+	if (offset + sizeof(T) > body.size()) return false;
+	std::memcpy(&value, body.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
@@ -1,16 +1,20 @@
 #include "IPv4.h"
 
 std::string getLocalIPv4Address() {
+#ifdef _WIN32
     // Initialize Winsock
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
         return "WSAStartup failed";
     }
+#endif
 
     // Get the host name
     char hostname[256];
     if (gethostname(hostname, sizeof(hostname)) == SOCKET_ERROR) {
+#ifdef _WIN32
         WSACleanup();
+#endif
         return "Error getting hostname";
     }
 
@@ -21,7 +25,9 @@ std::string getLocalIPv4Address() {
     hints.ai_protocol = IPPROTO_TCP;
 
     if (getaddrinfo(hostname, nullptr, &hints, &result) != 0) {
+#ifdef _WIN32
         WSACleanup();
+#endif
         return "getaddrinfo failed";
     }
 
@@ -37,7 +43,9 @@ std::string getLocalIPv4Address() {
 
     // Clean up
     freeaddrinfo(result);
+#ifdef _WIN32
     WSACleanup();
+#endif
 
     return ipAddress.empty() ? "IP Address not found" : ipAddress;
 }
\ No newline at end of file
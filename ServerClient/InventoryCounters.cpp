@@ -0,0 +1,67 @@
+#include "InventoryCounters.h"
+
+#include <random>
+
+uint64_t InventoryCounters::newReplicaID() {
+    std::random_device device;
+    std::mt19937_64 generator((static_cast<uint64_t>(device()) << 32) ^ device());
+    return generator();
+}
+
+void InventoryCounters::add(uint64_t replicaID, uint8_t slot, float change) {
+    Counter& counter = counters[slot][replicaID];
+    if (change > 0)
+        counter.increments += change;
+    else
+        counter.decrements -= change;
+}
+
+bool InventoryCounters::merge(const InventoryCounterEntry& entry) {
+    Counter& counter = counters[entry.slot][entry.replicaID];
+    bool grew = false;
+    if (entry.increments > counter.increments) {
+        counter.increments = entry.increments;
+        grew = true;
+    }
+    if (entry.decrements > counter.decrements) {
+        counter.decrements = entry.decrements;
+        grew = true;
+    }
+    return grew;
+}
+
+float InventoryCounters::valueExcept(uint8_t slot, uint64_t replicaID) const {
+    auto slotCounters = counters.find(slot);
+    if (slotCounters == counters.end())
+        return 0.0f;
+
+    float value = 0.0f;
+    for (const auto& counter : slotCounters->second) {
+        if (counter.first != replicaID)
+            value += counter.second.increments - counter.second.decrements;
+    }
+    return value;
+}
+
+InventoryCounterEntry InventoryCounters::entry(uint8_t slot, uint64_t replicaID) const {
+    InventoryCounterEntry result{ slot, replicaID, 0.0f, 0.0f };
+    auto slotCounters = counters.find(slot);
+    if (slotCounters != counters.end()) {
+        auto counter = slotCounters->second.find(replicaID);
+        if (counter != slotCounters->second.end()) {
+            result.increments = counter->second.increments;
+            result.decrements = counter->second.decrements;
+        }
+    }
+    return result;
+}
+
+std::vector<InventoryCounterEntry> InventoryCounters::entries() const {
+    std::vector<InventoryCounterEntry> result;
+    for (const auto& slotCounters : counters) {
+        for (const auto& counter : slotCounters.second) {
+            result.push_back({ slotCounters.first, counter.first, counter.second.increments, counter.second.decrements });
+        }
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "GameData.h"
+
+// Inventory slots as PN-counters: every client only ever grows its own
+// increments and decrements, and merging takes the maximum per replica. Merges
+// are idempotent and order independent, so clients, the server and the room
+// keyframe all converge on the same state without arbitration or resends.
+//
+// A replica is one client for as long as its game runs. It picks a random
+// 64-bit ID once and keeps it across reconnects, so its counters never mix
+// with those of a later client the server hands the same client ID.
+//
+// The value a client adds to its game for a slot is the sum over all other
+// replicas; its own changes are already in its game memory.
+class InventoryCounters {
+public:
+	static uint64_t newReplicaID();
+
+	// A change made by this replica's own player
+	void add(uint64_t replicaID, uint8_t slot, float change);
+	// Returns true if the entry grew anything
+	bool merge(const InventoryCounterEntry& entry);
+
+	float valueExcept(uint8_t slot, uint64_t replicaID) const;
+	InventoryCounterEntry entry(uint8_t slot, uint64_t replicaID) const;
+	std::vector<InventoryCounterEntry> entries() const;
+	bool empty() const { return counters.empty(); }
+	void clear() { counters.clear(); }
+
+private:
+	struct Counter {
+		float increments = 0.0f;
+		float decrements = 0.0f;
+	};
+	std::map<uint8_t, std::map<uint64_t, Counter>> counters;   // slot -> replica ID -> counter
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Bounded single-producer/single-consumer queue of frames. Slots are reused,
+// so a frame's buffer moves in and out without copying or locking. Several
+// producer threads are fine as long as something else serializes them
+// (the server only writes under clientsMutex, the client under its send mutex).
+class FrameQueue {
+public:
+    explicit FrameQueue(size_t capacity = 4096) : slots(roundUpPow2(capacity)), mask(slots.size() - 1) {}
+
+    // Never waits: returns false if the queue is full or closed. The server
+    // pushes under clientsMutex, where waiting on one client would stall the room.
+    bool push(std::vector<uint8_t> frame) {
+        if (closed.load(std::memory_order_acquire))
+            return false;
+        return place(frame);
+    }
+    // Waits while the queue is full; returns false once closed
+    bool pushWait(std::vector<uint8_t> frame) {
+        while (true) {
+            if (closed.load(std::memory_order_acquire))
+                return false;
+            uint32_t seen = space.load(std::memory_order_acquire);
+            producerWaiting.store(true, std::memory_order_seq_cst);
+            if (place(frame)) {
+                producerWaiting.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            space.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    // Blocks until a frame arrives; returns false once closed and drained
+    bool pop(std::vector<uint8_t>& frame) {
+        while (true) {
+            uint32_t seen = signal.load(std::memory_order_acquire);
+            size_t h = head.load(std::memory_order_relaxed);
+            if (h != tail.load(std::memory_order_acquire)) {
+                frame = std::move(slots[h & mask]);
+                // seq_cst pairs with pushWait: either it sees the new head, or we see it waiting
+                head.store(h + 1, std::memory_order_seq_cst);
+                if (producerWaiting.load(std::memory_order_seq_cst)) {
+                    space.fetch_add(1, std::memory_order_release);
+                    space.notify_one();
+                }
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire))
+                return false;
+            signal.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_all();
+        space.fetch_add(1, std::memory_order_release);
+        space.notify_all();
+    }
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+    size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+    size_t capacity() const { return slots.size(); }
+
+private:
+    std::vector<std::vector<uint8_t>> slots;
+    const size_t mask;
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+    std::atomic<uint32_t> signal{ 0 };        // bumped by push, waited on by pop
+    std::atomic<uint32_t> space{ 0 };         // bumped by pop while a producer waits
+    std::atomic<bool> producerWaiting{ false };
+    std::atomic<bool> closed{ false };
+
+    bool place(std::vector<uint8_t>& frame) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_seq_cst) == slots.size())
+            return false;
+        slots[t & mask] = std::move(frame);
+        tail.store(t + 1, std::memory_order_release);
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+        return true;
+    }
+
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+};
+
+// In-process connection between a Server and a Client in the same program
+// ("Server & Client" mode). Carries the same frames as a socket, minus the
+// length prefix, so both sides keep the semantics of a remote connection.
+struct LocalChannel {
+    FrameQueue toServer;
+    FrameQueue toClient;
+
+    void close() {
+        toServer.close();
+        toClient.close();
+    }
+};
@@ -14,15 +14,50 @@ const uint8_t EVENT_MESSAGE = 2;
 const uint8_t SNAPSHOT_MESSAGE = 3;
 const uint8_t CLIENT_LIST_MESSAGE = 4;
 const uint8_t CLIENT_ID_MESSAGE = 5;
+const uint8_t CLIENT_JOIN_MESSAGE = 6;
+const uint8_t CLIENT_LEAVE_MESSAGE = 7;
+const uint8_t CLIENT_LIST_REQUEST_MESSAGE = 8;
+const uint8_t CLIENT_HELLO_MESSAGE = 9;
+const uint8_t KEYFRAME_MESSAGE = 10;
+const uint8_t MESH_ACK_MESSAGE = 11;
+
+// Client entries: ID (uint8), IP length (uint8), IP, TCP port (uint16), mesh UDP port (uint16)
+//
+// Client list messages start with the list version (uint32):
+//   CLIENT_LIST_MESSAGE  - version, then every client entry
+//   CLIENT_JOIN_MESSAGE  - version, then the entry of the client that joined
+//   CLIENT_LEAVE_MESSAGE - version, then the ID of the client that left. A client
+//                          sends it with an empty body when it leaves on purpose
+// Each join/leave bumps the version by one, so a client that sees a gap
+// sends CLIENT_LIST_REQUEST_MESSAGE and gets the full list back.
+//
+// Session handshake:
+//   CLIENT_HELLO_MESSAGE - first frame a client sends: its snapshot mesh UDP port
+//                          (uint16, 0 if off), then for a resume the token (uint64)
+//                          with the old ID as sender
+//   CLIENT_ID_MESSAGE    - the ID as sender, then the resume token (uint64) and
+//                          whether the old session was resumed (uint8)
+//
+// MESH_ACK_MESSAGE - empty, only on the snapshot mesh: sent back to the peer whose
+//   snapshot just arrived, so it knows its snapshots get through and not only ours
+//
+// KEYFRAME_MESSAGE - room state sent to a new client after the client list, and again
+//   to one that lost frames (resume past the window, overflowed queue):
+//   snapshot count (uint8), then per player: ID (uint8), size (uint32), snapshot body
+//   level count (uint8), then per level: level (uint8), size (uint32), ENEMIES_HEALTH record
+//     with the total change of every enemy by everyone but the receiver; a client
+//     applies it minus the remote changes it already applied on that level
+//   size (uint32), then the INVENTORY record (empty if nothing changed)
 
 // Client Information Structure
 struct ClientInfo {
     uint8_t clientID;
     std::string ipAddress;
     uint16_t port;
+    uint16_t udpPort;   // snapshot mesh, 0 if the client doesn't take direct snapshots
 
-    ClientInfo() : clientID(0), ipAddress(""), port(0) {}
-    ClientInfo(uint8_t id, const std::string& ip, uint16_t p) : clientID(id), ipAddress(ip), port(p) {}
+    ClientInfo() : clientID(0), ipAddress(""), port(0), udpPort(0) {}
+    ClientInfo(uint8_t id, const std::string& ip, uint16_t p, uint16_t udp = 0) : clientID(id), ipAddress(ip), port(p), udpPort(udp) {}
 };
 
 // Base class for messages
@@ -39,4 +74,45 @@ public:
     static BaseMessage* deserializeMessage(const std::vector<uint8_t>& buffer);
 
     virtual ~BaseMessage() {}
-};
\ No newline at end of file
+};
+
+// Helpers for fixed-size fields inside a message body (network byte order)
+inline void pushUint16(std::queue<uint8_t>& data, uint16_t value) {
+    data.push(static_cast<uint8_t>((value >> 8) & 0xFF));
+    data.push(static_cast<uint8_t>(value & 0xFF));
+}
+inline bool popUint16(std::queue<uint8_t>& data, uint16_t& value) {
+    if (data.size() < 2) return false;
+    value = static_cast<uint16_t>(data.front() << 8);
+    data.pop();
+    value |= data.front();
+    data.pop();
+    return true;
+}
+inline void pushUint32(std::queue<uint8_t>& data, uint32_t value) {
+    data.push(static_cast<uint8_t>((value >> 24) & 0xFF));
+    data.push(static_cast<uint8_t>((value >> 16) & 0xFF));
+    data.push(static_cast<uint8_t>((value >> 8) & 0xFF));
+    data.push(static_cast<uint8_t>(value & 0xFF));
+}
+inline bool popUint32(std::queue<uint8_t>& data, uint32_t& value) {
+    if (data.size() < 4) return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value = (value << 8) | data.front();
+        data.pop();
+    }
+    return true;
+}
+inline void pushUint64(std::queue<uint8_t>& data, uint64_t value) {
+    pushUint32(data, static_cast<uint32_t>(value >> 32));
+    pushUint32(data, static_cast<uint32_t>(value & 0xFFFFFFFF));
+}
+inline bool popUint64(std::queue<uint8_t>& data, uint64_t& value) {
+    uint32_t high = 0, low = 0;
+    if (data.size() < 8) return false;
+    popUint32(data, high);
+    popUint32(data, low);
+    value = (static_cast<uint64_t>(high) << 32) | low;
+    return true;
+}
\ No newline at end of file
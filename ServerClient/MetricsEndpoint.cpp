@@ -0,0 +1,108 @@
+// Requires C++20 (asio awaitables)
+#include <asio.hpp>
+
+#include <thread>
+
+#include "MetricsEndpoint.h"
+
+namespace {
+
+// Scrape requests are a few hundred bytes; anything bigger is not Prometheus
+const size_t MAX_REQUEST_SIZE = 8192;
+const std::chrono::seconds REQUEST_TIMEOUT(5);
+
+std::string httpResponse(const char* status, const char* contentType, const std::string& body) {
+    return std::string("HTTP/1.1 ") + status + "\r\n"
+        + "Content-Type: " + contentType + "\r\n"
+        + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        + "Connection: close\r\n\r\n" + body;
+}
+
+}
+
+struct MetricsEndpoint::Impl {
+    asio::io_context ioContext{ 1 };
+    asio::ip::tcp::acceptor acceptor{ ioContext };
+    std::thread thread;
+    Render render;
+    uint16_t port = 0;
+
+    asio::awaitable<void> acceptLoop() {
+        while (true) {
+            auto [ec, socket] = co_await acceptor.async_accept(asio::as_tuple(asio::use_awaitable));
+            if (ec == asio::error::operation_aborted)
+                co_return;
+            if (!ec)
+                asio::co_spawn(ioContext, answer(std::make_shared<asio::ip::tcp::socket>(std::move(socket))), asio::detached);
+        }
+    }
+
+    asio::awaitable<void> answer(std::shared_ptr<asio::ip::tcp::socket> socket) {
+        // A client that never finishes its request is cut off
+        asio::steady_timer timeout(ioContext, REQUEST_TIMEOUT);
+        timeout.async_wait([socket](const asio::error_code& ec) {
+            if (!ec)
+                socket->close();
+        });
+
+        std::string request;
+        auto [ec, n] = co_await asio::async_read_until(*socket, asio::dynamic_buffer(request, MAX_REQUEST_SIZE), "\r\n\r\n",
+            asio::as_tuple(asio::use_awaitable));
+        if (ec) {
+            timeout.cancel();
+            co_return;
+        }
+
+        std::string requestLine = request.substr(0, request.find("\r\n"));
+        std::string response;
+        if (requestLine.rfind("GET /metrics ", 0) == 0 || requestLine.rfind("GET /metrics?", 0) == 0)
+            response = httpResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", render());
+        else
+            response = httpResponse("404 Not Found", "text/plain", "Try /metrics\n");
+
+        co_await asio::async_write(*socket, asio::buffer(response), asio::as_tuple(asio::use_awaitable));
+        timeout.cancel();
+        asio::error_code ignored;
+        socket->shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+    }
+};
+
+MetricsEndpoint::MetricsEndpoint() : impl(std::make_unique<Impl>()) {}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    stop();
+}
+
+bool MetricsEndpoint::start(const std::string& address, uint16_t port, Render render) {
+    if (impl->thread.joinable())
+        return false;
+    try {
+        asio::ip::tcp::endpoint endpoint(asio::ip::make_address(address), port);
+        impl->acceptor.open(endpoint.protocol());
+        impl->acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        impl->acceptor.bind(endpoint);
+        impl->acceptor.listen();
+        impl->port = impl->acceptor.local_endpoint().port();
+    }
+    catch (const std::exception&) {
+        asio::error_code ignored;
+        impl->acceptor.close(ignored);
+        return false;
+    }
+
+    impl->render = std::move(render);
+    asio::co_spawn(impl->ioContext, impl->acceptLoop(), asio::detached);
+    impl->thread = std::thread([this] { impl->ioContext.run(); });
+    return true;
+}
+
+void MetricsEndpoint::stop() {
+    if (!impl->thread.joinable())
+        return;
+    impl->ioContext.stop();
+    impl->thread.join();
+}
+
+uint16_t MetricsEndpoint::getPort() const {
+    return impl->port;
+}
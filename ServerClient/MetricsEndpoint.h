@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+// Small HTTP server for Prometheus: GET /metrics answers with whatever the
+// render callback returns, anything else gets a 404. Runs on its own thread
+// with asio, which stays out of this header so the server's socket includes
+// don't have to meet it.
+class MetricsEndpoint {
+public:
+    using Render = std::function<std::string()>;
+
+    MetricsEndpoint();
+    ~MetricsEndpoint();
+
+    // port 0 picks a free one, see getPort()
+    bool start(const std::string& address, uint16_t port, Render render);
+    void stop();
+    uint16_t getPort() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
@@ -0,0 +1,100 @@
+#include "RoomKeyframe.h"
+
+void RoomKeyframe::applySnapshot(const BaseMessage& msg) {
+    GameRecords records;
+    parseGameRecords(msg.message, records);
+    if (!records.hasPlayerSnap)
+        return;
+
+    snapshots[msg.senderID] = msg.message;
+    clientLevels[msg.senderID] = records.playerLevel;
+}
+
+void RoomKeyframe::applyEvents(const EventMerger& merger) {
+    for (const auto& item : merger.getInventory().entries()) {
+        inventory.merge(item);
+    }
+
+    // Enemy GUIDs are only unique within a level, so they go under the sender's level
+    for (const auto& sender : merger.getEnemyChanges()) {
+        auto level = clientLevels.find(sender.first);
+        if (level == clientLevels.end())
+            continue;
+        auto& levelEnemies = enemyHealth[level->second];
+        for (const auto& enemy : sender.second) {
+            levelEnemies[enemy.first][sender.first] += enemy.second;
+        }
+    }
+}
+
+void RoomKeyframe::removeClient(uint8_t clientID) {
+    // The inventory counters stay: they are keyed by replica, not by the client ID that gets reused
+    snapshots.erase(clientID);
+    clientLevels.erase(clientID);
+
+    // Its damage stays too, but no longer belongs to the ID the next client gets
+    for (auto& level : enemyHealth) {
+        for (auto& enemy : level.second) {
+            auto contribution = enemy.second.find(clientID);
+            if (contribution == enemy.second.end())
+                continue;
+            enemy.second[0] += contribution->second;
+            enemy.second.erase(contribution);
+        }
+    }
+}
+
+BaseMessage RoomKeyframe::buildMessage(uint8_t receiverID) const {
+    BaseMessage keyframe(KEYFRAME_MESSAGE, 0);
+
+    keyframe.message.push(static_cast<uint8_t>(snapshots.size()));
+    for (const auto& snapshot : snapshots) {
+        keyframe.message.push(snapshot.first);
+        pushUint32(keyframe.message, static_cast<uint32_t>(snapshot.second.size()));
+        std::queue<uint8_t> body = snapshot.second;
+        while (!body.empty()) {
+            keyframe.message.push(body.front());
+            body.pop();
+        }
+    }
+
+    std::map<uint8_t, std::vector<EnemyHealthChange>> levels;
+    for (const auto& level : enemyHealth) {
+        for (const auto& enemy : level.second) {
+            float total = 0.0f;
+            bool others = false;
+            for (const auto& contribution : enemy.second) {
+                if (contribution.first == receiverID)
+                    continue;
+                total += contribution.second;
+                others = true;
+            }
+            if (others)
+                levels[level.first].push_back({ enemy.first, total });
+        }
+    }
+
+    std::vector<uint8_t> record;
+    keyframe.message.push(static_cast<uint8_t>(levels.size()));
+    for (const auto& level : levels) {
+        record.clear();
+        writeEnemiesHealthRecord(record, level.second);
+
+        keyframe.message.push(level.first);
+        pushUint32(keyframe.message, static_cast<uint32_t>(record.size()));
+        for (uint8_t byte : record) {
+            keyframe.message.push(byte);
+        }
+    }
+
+    std::vector<InventoryCounterEntry> items = inventory.entries();
+    record.clear();
+    if (!items.empty())
+        writeInventoryRecord(record, items);
+    pushUint32(keyframe.message, static_cast<uint32_t>(record.size()));
+    for (uint8_t byte : record) {
+        keyframe.message.push(byte);
+    }
+
+    return keyframe;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <map>
+#include <vector>
+#include <cstdint>
+
+#include "Message.h"
+#include "GameData.h"
+#include "EventMerger.h"
+#include "InventoryCounters.h"
+
+// Compact state of the room, kept by the server from the game messages it relays:
+// the last snapshot of every player, the merged inventory counters and the summed
+// enemy health changes per GUID for every level. A client that joins late gets
+// it in one KEYFRAME_MESSAGE instead of waiting for the deltas to trickle in.
+//
+// Enemy health is kept per client, so a keyframe holds what everyone but its
+// receiver did: the totals of the same deltas the receiver gets live. A client
+// that already applied some of them (resume, overflowed queue) applies only the
+// difference, so getting the keyframe again never hurts an enemy twice.
+class RoomKeyframe {
+public:
+    // Snapshot messages with the sender already set
+    void applySnapshot(const BaseMessage& msg);
+    // The changes of one server tick, applied when they are sent out
+    void applyEvents(const EventMerger& merger);
+    void removeClient(uint8_t clientID);
+
+    bool empty() const { return snapshots.empty() && inventory.empty() && enemyHealth.empty(); }
+    // Enemy totals leave out what receiverID did itself
+    BaseMessage buildMessage(uint8_t receiverID) const;
+
+private:
+    std::map<uint8_t, std::queue<uint8_t>> snapshots;           // client ID -> last snapshot body
+    std::map<uint8_t, uint8_t> clientLevels;                    // client ID -> level of its last snapshot
+    InventoryCounters inventory;
+    // level -> GUID -> client ID -> summed change; ID 0 holds clients that left
+    std::map<uint8_t, std::map<uint64_t, std::map<uint8_t, float>>> enemyHealth;
+};
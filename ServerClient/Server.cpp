@@ -1,6 +1,8 @@
 #include "Server.h"
 
-void Server::start() {
+#include <sstream>
+
+bool Server::start() {
 #ifdef _WIN32
     WSADATA wsData;
     WSAStartup(MAKEWORD(2, 2), &wsData);
@@ -9,23 +11,55 @@ void Server::start() {
     listeningSocket = socket(AF_INET, SOCK_STREAM, 0);
     if (listeningSocket == INVALID_SOCKET) {
         logOption_->LogMessage(LogLevel::Log_Error, "Error creating socket");
-        return;
+        return false;
     }
 
+#ifndef _WIN32
+    // Lets a restarted dedicated server bind again while old connections sit in TIME_WAIT
+    int reuse = 1;
+    setsockopt(listeningSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+
     sockaddr_in serverHint{};
     serverHint.sin_family = AF_INET;
-    serverHint.sin_port = htons(PORT);
+    serverHint.sin_port = htons(config.port);
     serverHint.sin_addr.s_addr = INADDR_ANY;
 
     if (bind(listeningSocket, (sockaddr*)&serverHint, sizeof(serverHint)) == SOCKET_ERROR) {
         logOption_->LogMessage(LogLevel::Log_Error, "Error binding socket");
-        return;
+        return false;
     }
 
     listen(listeningSocket, SOMAXCONN);
-    logOption_->LogMessage(LogLevel::Log_Info, "Server is listening on port ", PORT);
+    logOption_->LogMessage(LogLevel::Log_Info, "Server is listening on port ", config.port);
+
+    if (!config.capturePath.empty()) {
+        capture = std::make_unique<CaptureWriter>();
+        if (!capture->open(config.capturePath)) {
+            logOption_->LogMessage(LogLevel::Log_Error, "Can't open capture file", config.capturePath);
+            capture.reset();
+        }
+        else {
+            logOption_->LogMessage(LogLevel::Log_Info, "Capturing received frames to", config.capturePath);
+        }
+    }
+
+    if (config.metricsPort != 0) {
+        metricsEndpoint = std::make_unique<MetricsEndpoint>();
+        if (metricsEndpoint->start(config.metricsAddress, config.metricsPort, [this] { return renderMetrics(); })) {
+            logOption_->LogMessage(LogLevel::Log_Info, "Metrics on http://" + config.metricsAddress + ":" + std::to_string(config.metricsPort) + "/metrics");
+        }
+        else {
+            logOption_->LogMessage(LogLevel::Log_Error, "Can't open the metrics endpoint on", config.metricsAddress, config.metricsPort);
+            metricsEndpoint.reset();
+        }
+    }
 
-    std::thread(&Server::acceptClients, this).detach();
+    for (size_t i = 0; i < config.workerThreads; ++i)
+        sendWorkers.emplace_back(&Server::runSendWorker, this);
+    acceptThread = std::thread(&Server::acceptClients, this);
+    tickThread = std::thread(&Server::runTicks, this);
+    return true;
 }
 
 void Server::acceptClients() {
@@ -39,118 +73,760 @@ void Server::acceptClients() {
             inet_ntop(AF_INET, &clientHint.sin_addr, ipStr, INET_ADDRSTRLEN);
             std::string ipAddress(ipStr);
             uint16_t port = ntohs(clientHint.sin_port);
+            // Frames are small and latency bound; don't let Nagle hold them for the peer's delayed ACK
+            int noDelay = 1;
+            setsockopt(clientSocket, IPPROTO_TCP, TCP_NODELAY, (const char*)&noDelay, sizeof(noDelay));
 
-            uint8_t clientID = nextClientID++;
-            ClientHandler* clientHandler = new ClientHandler{ clientSocket, clientID, ipAddress, port, std::thread() };
-
+            // The handshake happens on the client's own thread, so a slow client can't stall accept
             {
                 std::lock_guard<std::mutex> lock(clientsMutex);
-                clients.push_back(clientHandler);
+                ++servingThreads;
             }
+            std::thread(&Server::handleClient, this, clientSocket, ipAddress, port).detach();
+        }
+    }
+}
 
-            BaseMessage idMessage(CLIENT_ID_MESSAGE, clientID);
-            std::vector<uint8_t> buffer;
-            BaseMessage::serializeMessage(idMessage, buffer);
+void Server::handleClient(SOCKET clientSocket, std::string ipAddress, uint16_t port) {
+    // The socket is closed once the last reference to its outbox is gone
+    serveClient(clientSocket, std::make_shared<Outbox>(clientSocket), nullptr, ipAddress, port);
 
-            uint32_t msgSize = htonl(buffer.size());
-            send(clientSocket, (char*)&msgSize, sizeof(msgSize), 0);
-            send(clientSocket, (char*)buffer.data(), buffer.size(), 0);
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    --servingThreads;
+    servingDone.notify_all();
+}
 
-            notifyClients();
+std::shared_ptr<LocalChannel> Server::attachLocalClient(const std::string& ipAddress) {
+    auto local = std::make_shared<LocalChannel>();
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        ++servingThreads;
+    }
+    std::thread(&Server::handleLocalClient, this, local, ipAddress).detach();
+    return local;
+}
 
-            clientHandler->thread = std::thread(&Server::handleClient, this, clientHandler);
-            clientHandler->thread.detach();
+void Server::handleLocalClient(std::shared_ptr<LocalChannel> local, std::string ipAddress) {
+    serveClient(INVALID_SOCKET, nullptr, local, ipAddress, 0);
+    local->close();
 
-            logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientID, "connected.");
-        }
-    }
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    --servingThreads;
+    servingDone.notify_all();
 }
 
-void Server::handleClient(ClientHandler* clientHandler) {
-    SOCKET clientSocket = clientHandler->socket;
-    uint8_t clientID = clientHandler->clientID;
+void Server::serveClient(SOCKET clientSocket, std::shared_ptr<Outbox> outbox, std::shared_ptr<LocalChannel> local, const std::string& ipAddress, uint16_t port) {
+    std::vector<uint8_t> buffer;
+    if (!receiveFrame(clientSocket, local.get(), buffer))
+        return;
 
-    while (isRunning) {
-        uint32_t msgSize;
-        int bytesReceived = recv(clientSocket, (char*)&msgSize, sizeof(msgSize), 0);
-        if (bytesReceived <= 0) break;
-        msgSize = ntohl(msgSize);
+    // Clients open with a hello; anything else is treated as a new session and processed normally
+    BaseMessage* first = BaseMessage::deserializeMessage(buffer);
+    bool isHello = first && first->messageType == CLIENT_HELLO_MESSAGE;
 
-        std::vector<uint8_t> buffer(msgSize);
-        size_t totalReceived = 0;
-        while (totalReceived < msgSize) {
-            bytesReceived = recv(clientSocket, (char*)buffer.data() + totalReceived, msgSize - totalReceived, 0);
-            if (bytesReceived <= 0) break;
-            totalReceived += bytesReceived;
-        }
-        if (bytesReceived <= 0) break;
+    SlotHandle handle;
+    uint8_t clientID;
+    if (!registerClient(clientSocket, outbox, local, ipAddress, port, isHello ? first : nullptr, handle, clientID)) {
+        delete first;
+        return;
+    }
+    std::shared_ptr<ConnectionMetrics> metrics;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        metrics = (*clients.get(handle))->metrics;
+    }
+    countReceived(*metrics, buffer);
+    if (capture)
+        capture->record(clientID, buffer);
+    if (first && !isHello)
+        processMessage(handle, clientID, first);
+    delete first;
 
+    while (isRunning && receiveFrame(clientSocket, local.get(), buffer)) {
+        auto receivedAt = std::chrono::steady_clock::now();
+        countReceived(*metrics, buffer);
+        if (capture)
+            capture->record(clientID, buffer);
         BaseMessage* msg = BaseMessage::deserializeMessage(buffer);
+        if (msg && msg->messageType == CLIENT_LEAVE_MESSAGE) {
+            // A clean leave: the slot is freed now instead of kept for a resume,
+            // unless a newer connection has already taken the session over
+            delete msg;
+            std::lock_guard<std::mutex> lock(clientsMutex);
+            auto* entry = clients.get(handle);
+            if (entry && (*entry)->socket == clientSocket && (*entry)->local == local) {
+                dropOutbox(entry->get());
+                removeClient(handle);
+            }
+            break;
+        }
         if (msg) {
-            msg->senderID = clientID;
-            broadcastMessage(*msg, clientID);
+            bool relayed = msg->messageType != CLIENT_LIST_REQUEST_MESSAGE && msg->messageType != CLIENT_HELLO_MESSAGE;
+            processMessage(handle, clientID, msg);
             delete msg;
+            if (relayed)
+                roomMetrics.relayLatency.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - receivedAt).count());
         }
     }
 
-    {
+    suspendClient(handle, clientSocket, local.get());
+}
+
+size_t Server::getClientCount() {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    size_t count = 0;
+    for (const auto& clientHandler : clients) {
+        count += clientHandler->connected;
+    }
+    return count;
+}
+
+void Server::countReceived(ConnectionMetrics& metrics, const std::vector<uint8_t>& buffer) {
+    size_t bytes = sizeof(uint32_t) + buffer.size();
+    metrics.framesIn.fetch_add(1, std::memory_order_relaxed);
+    metrics.bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+    if (!buffer.empty())
+        roomMetrics.framesInByType[std::min<size_t>(buffer[0], RoomMetrics::MESSAGE_TYPES - 1)].fetch_add(1, std::memory_order_relaxed);
+    roomMetrics.bytesIn.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Server::processMessage(SlotHandle handle, uint8_t clientID, BaseMessage* msg) {
+    if (msg->messageType == CLIENT_LIST_REQUEST_MESSAGE) {
         std::lock_guard<std::mutex> lock(clientsMutex);
-        clients.erase(std::remove_if(clients.begin(), clients.end(),
-            [clientID](ClientHandler* ch) { return ch->clientID == clientID; }), clients.end());
+        if (auto* clientHandler = clients.get(handle))
+            sendClientList(clientHandler->get());
+    }
+    else if (msg->messageType == CLIENT_HELLO_MESSAGE) {
+        logOption_->LogMessage(LogLevel::Log_Warning, "Client", (int)clientID, "sent a second hello, ignored");
+    }
+    else {
+        msg->senderID = clientID;
+        relayMessage(*msg);
+    }
+}
+
+void Server::relayMessage(const BaseMessage& msg) {
+    std::vector<uint8_t> buffer;
+    GameRecords records;
+    bool hasRecords = msg.messageType == EVENT_MESSAGE || msg.messageType == SNAPSHOT_MESSAGE;
+    bool parsed = hasRecords && parseGameRecords(msg.message, records);
+    bool merge = msg.messageType == EVENT_MESSAGE && parsed;
+    for (uint8_t label : records.labels) {
+        roomMetrics.recordsByLabel[label].fetch_add(1, std::memory_order_relaxed);
+    }
+    if (merge) {
+        // Enemy health and inventory wait for the tick, anything else in the event goes out now
+        if (!records.otherRecords.empty()) {
+            BaseMessage rest(EVENT_MESSAGE, msg.senderID);
+            for (uint8_t byte : records.otherRecords) {
+                rest.message.push(byte);
+            }
+            BaseMessage::serializeMessage(rest, buffer);
+        }
+    }
+    else {
+        BaseMessage::serializeMessage(msg, buffer);
+    }
+
+    // Same lock as registerClient, so a joiner gets each change either in its keyframe or live, never both
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    if (merge)
+        tickEvents.add(msg.senderID, records);
+    else if (msg.messageType == SNAPSHOT_MESSAGE)
+        keyframe.applySnapshot(msg);
+
+    if (buffer.empty())
+        return;
+    for (const auto& clientHandler : clients) {
+        if (clientHandler->clientID != msg.senderID) {
+            deliverFrame(clientHandler.get(), buffer);
+        }
+    }
+}
+
+void Server::runTicks() {
+    auto nextTick = std::chrono::steady_clock::now();
+    while (isRunning) {
+        nextTick += config.tickInterval;
+        std::this_thread::sleep_until(nextTick);
+        flushTickEvents();
+        expireSuspendedClients();
+    }
+}
+
+void Server::flushTickEvents() {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    if (tickEvents.empty())
+        return;
+    auto startedAt = std::chrono::steady_clock::now();
+
+    for (const auto& clientHandler : clients) {
+        for (const auto& msg : tickEvents.buildFor(clientHandler->clientID)) {
+            deliverFrame(clientHandler.get(), msg);
+        }
+    }
+    keyframe.applyEvents(tickEvents);
+    tickEvents.clear();
+    roomMetrics.ticks.fetch_add(1, std::memory_order_relaxed);
+    roomMetrics.tickDuration.record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt).count());
+}
+
+bool Server::registerClient(SOCKET clientSocket, std::shared_ptr<Outbox> outbox, std::shared_ptr<LocalChannel> local, const std::string& ipAddress, uint16_t port,
+    const BaseMessage* hello, SlotHandle& handle, uint8_t& clientID) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+
+    std::queue<uint8_t> helloData = hello ? hello->message : std::queue<uint8_t>();
+    uint16_t udpPort = 0;
+    popUint16(helloData, udpPort);
+
+    // Resume the session the token belongs to, dropped or not
+    uint64_t token = 0;
+    if (popUint64(helloData, token)) {
+        for (const auto& entry : clients) {
+            ClientHandler* clientHandler = entry.get();
+            if (clientHandler->clientID != hello->senderID || clientHandler->resumeToken != token)
+                continue;
+
+            bool stale = clientHandler->connected;
+            if (stale) {
+                // Half-open: the client gave up on a link we haven't seen drop yet.
+                // Its thread stops once the old link is shut down, and whatever
+                // was still on the way is lost, so the client gets a full resync.
+                logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientHandler->clientID, "reconnected over a stale link, taking it over.");
+                if (clientHandler->local)
+                    clientHandler->local->close();
+                else if (clientHandler->socket != INVALID_SOCKET)
+                    shutdown(clientHandler->socket, SHUT_RDWR);
+                dropOutbox(clientHandler);
+            }
+
+            clientHandler->socket = clientSocket;
+            clientHandler->outbox = outbox;
+            clientHandler->local = local;
+            clientHandler->connected = true;
+            clientHandler->ipAddress = ipAddress;
+            clientHandler->port = port;
+            clientHandler->udpPort = udpPort;
+
+            BaseMessage idMessage(CLIENT_ID_MESSAGE, clientHandler->clientID);
+            pushUint64(idMessage.message, clientHandler->resumeToken);
+            idMessage.message.push(1);
+            deliverFrame(clientHandler, idMessage);
+            if (stale)
+                clientHandler->missedOverflow = true;
+            flushMissedFrames(clientHandler);
+
+            handle = clientHandler->handle;
+            clientID = clientHandler->clientID;
+            logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientID, "resumed.");
+            return true;
+        }
+        logOption_->LogMessage(LogLevel::Log_Info, "Unknown or expired session from", ipAddress, "starting a new one");
+    }
+
+    if (clients.size() >= (std::min)(config.maxClients, MAX_CLIENTS)) {
+        logOption_->LogMessage(LogLevel::Log_Warning, "Server is full, refused", ipAddress);
+        return false;
+    }
+
+    handle = clients.insert(std::make_unique<ClientHandler>());
+    ClientHandler* clientHandler = clients.get(handle)->get();
+    clientHandler->socket = clientSocket;
+    clientHandler->outbox = outbox;
+    clientHandler->local = local;
+    clientHandler->clientID = static_cast<uint8_t>(handle.index + 1);
+    clientHandler->ipAddress = ipAddress;
+    clientHandler->port = port;
+    clientHandler->udpPort = udpPort;
+    clientHandler->handle = handle;
+    clientHandler->resumeToken = tokenGenerator();
+    clientID = clientHandler->clientID;
+
+    BaseMessage idMessage(CLIENT_ID_MESSAGE, clientID);
+    pushUint64(idMessage.message, clientHandler->resumeToken);
+    idMessage.message.push(0);
+    deliverFrame(clientHandler, idMessage);
+
+    // The newcomer gets the whole list once, everyone else only the join
+    broadcastClientJoin(clientHandler);
+    sendClientList(clientHandler);
+    if (!keyframe.empty())
+        deliverFrame(clientHandler, keyframe.buildMessage(clientHandler->clientID));
+
+    logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientID, "connected.");
+    return true;
+}
+
+void Server::suspendClient(SlotHandle handle, SOCKET clientSocket, const LocalChannel* local) {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto* entry = clients.get(handle);
+    // A newer connection may already have resumed this session
+    if (!entry || (*entry)->socket != clientSocket || (*entry)->local.get() != local)
+        return;
+
+    ClientHandler* clientHandler = entry->get();
+    clientHandler->connected = false;
+    clientHandler->socket = INVALID_SOCKET;
+    dropOutbox(clientHandler);
+    clientHandler->local.reset();
+    clientHandler->disconnectedAt = std::chrono::steady_clock::now();
+    clientHandler->missedFrames.clear();
+    clientHandler->missedSnapshots.clear();
+    clientHandler->missedOverflow = false;
+
+    logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientHandler->clientID, "dropped, keeping its slot for resume.");
+}
+
+void Server::dropOutbox(ClientHandler* clientHandler) {
+    if (clientHandler->outbox) {
+        // A worker may still hold the outbox; whatever it hasn't written yet is dropped
+        std::lock_guard<std::mutex> outboxLock(clientHandler->outbox->mutex);
+        clientHandler->outbox->closed = true;
+        clientHandler->metrics->dropped += clientHandler->outbox->frames.size();
+        roomMetrics.dropped += clientHandler->outbox->frames.size();
+        clientHandler->outbox->frames.clear();
+    }
+    clientHandler->outbox.reset();
+}
+
+void Server::expireSuspendedClients() {
+    std::lock_guard<std::mutex> lock(clientsMutex);
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<SlotHandle> expired;
+    for (const auto& clientHandler : clients) {
+        if (!clientHandler->connected && now - clientHandler->disconnectedAt > RESUME_GRACE_PERIOD)
+            expired.push_back(clientHandler->handle);
     }
 
-    notifyClients();
-    closesocket(clientSocket);
+    for (SlotHandle handle : expired) {
+        removeClient(handle);
+    }
+}
+
+void Server::removeClient(SlotHandle handle) {
+    uint8_t clientID = (*clients.get(handle))->clientID;
+    clients.remove(handle);
+    keyframe.removeClient(clientID);
+    broadcastClientLeave(clientID);
     logOption_->LogMessage(LogLevel::Log_Info, "Client", (int)clientID, "disconnected.");
 }
 
+void Server::flushMissedFrames(ClientHandler* clientHandler) {
+    // Taken out first, since the frames below go through deliverFrame again
+    bool overflow = clientHandler->missedOverflow;
+    std::vector<std::vector<uint8_t>> frames;
+    std::map<uint8_t, std::vector<uint8_t>> snapshots;
+    frames.swap(clientHandler->missedFrames);
+    snapshots.swap(clientHandler->missedSnapshots);
+    clientHandler->missedOverflow = false;
+
+    if (overflow) {
+        // Too much happened while away: the client list and the room state are
+        // rebuilt from scratch, the same way a late joiner gets them
+        logOption_->LogMessage(LogLevel::Log_Warning, "Client", (int)clientHandler->clientID, "missed too many frames, sending full client list and keyframe");
+        sendClientList(clientHandler);
+        if (!keyframe.empty())
+            deliverFrame(clientHandler, keyframe.buildMessage(clientHandler->clientID));
+    }
+    else {
+        for (const auto& frame : frames)
+            deliverFrame(clientHandler, frame);
+    }
+    for (const auto& snapshot : snapshots)
+        deliverFrame(clientHandler, snapshot.second);
+
+    logOption_->LogMessage(LogLevel::Log_Debug, "Resent", frames.size(), "frames and",
+        snapshots.size(), "snapshots to client", (int)clientHandler->clientID);
+}
+
 void Server::broadcastMessage(const BaseMessage& msg, uint8_t excludeID) {
     std::vector<uint8_t> buffer;
     BaseMessage::serializeMessage(msg, buffer);
-    uint32_t msgSize = htonl(buffer.size());
 
     std::lock_guard<std::mutex> lock(clientsMutex);
-    for (ClientHandler* clientHandler : clients) {
+    for (const auto& clientHandler : clients) {
         if (clientHandler->clientID != excludeID) {
-            send(clientHandler->socket, (char*)&msgSize, sizeof(msgSize), 0);
-            send(clientHandler->socket, (char*)buffer.data(), buffer.size(), 0);
+            deliverFrame(clientHandler.get(), buffer);
         }
     }
 }
 
-void Server::notifyClients() {
-    std::lock_guard<std::mutex> lock(clientsMutex);
+void Server::pushClientEntry(BaseMessage& msg, const ClientHandler* clientHandler) {
+    msg.message.push(clientHandler->clientID);
 
+    const std::string& ip = clientHandler->ipAddress;
+    msg.message.push(static_cast<uint8_t>(ip.size()));
+    for (char c : ip) {
+        msg.message.push(static_cast<uint8_t>(c));
+    }
+
+    uint16_t netPort = htons(clientHandler->port);
+    msg.message.push(static_cast<uint8_t>((netPort >> 8) & 0xFF));
+    msg.message.push(static_cast<uint8_t>(netPort & 0xFF));
+
+    pushUint16(msg.message, clientHandler->udpPort);
+}
+
+void Server::sendClientList(ClientHandler* clientHandler) {
     BaseMessage clientListMessage(CLIENT_LIST_MESSAGE, 0);
-    for (ClientHandler* clientHandler : clients) {
-        clientListMessage.message.push(clientHandler->clientID);
+    pushUint32(clientListMessage.message, clientListVersion);
+    for (const auto& ch : clients) {
+        pushClientEntry(clientListMessage, ch.get());
+    }
 
-        std::string ip = clientHandler->ipAddress;
-        clientListMessage.message.push(static_cast<uint8_t>(ip.size()));
-        for (char c : ip) {
-            clientListMessage.message.push(static_cast<uint8_t>(c));
+    deliverFrame(clientHandler, clientListMessage);
+    logOption_->LogMessage(LogLevel::Log_Debug, "Sent client list version", clientListVersion, "to client", (int)clientHandler->clientID);
+}
+
+void Server::broadcastClientJoin(ClientHandler* joined) {
+    ++clientListVersion;
+
+    BaseMessage joinMessage(CLIENT_JOIN_MESSAGE, 0);
+    pushUint32(joinMessage.message, clientListVersion);
+    pushClientEntry(joinMessage, joined);
+
+    std::vector<uint8_t> buffer;
+    BaseMessage::serializeMessage(joinMessage, buffer);
+    for (const auto& clientHandler : clients) {
+        if (clientHandler.get() != joined) {
+            deliverFrame(clientHandler.get(), buffer);
         }
+    }
+    logOption_->LogMessage(LogLevel::Log_Debug, "Notified clients about join of", (int)joined->clientID);
+}
 
-        uint16_t netPort = htons(clientHandler->port);
-        clientListMessage.message.push(static_cast<uint8_t>((netPort >> 8) & 0xFF));
-        clientListMessage.message.push(static_cast<uint8_t>(netPort & 0xFF));
+void Server::broadcastClientLeave(uint8_t clientID) {
+    ++clientListVersion;
+
+    BaseMessage leaveMessage(CLIENT_LEAVE_MESSAGE, 0);
+    pushUint32(leaveMessage.message, clientListVersion);
+    leaveMessage.message.push(clientID);
+
+    std::vector<uint8_t> buffer;
+    BaseMessage::serializeMessage(leaveMessage, buffer);
+    for (const auto& clientHandler : clients) {
+        deliverFrame(clientHandler.get(), buffer);
     }
+    logOption_->LogMessage(LogLevel::Log_Debug, "Notified clients about leave of", (int)clientID);
+}
+
+void Server::deliverFrame(ClientHandler* clientHandler, const std::vector<uint8_t>& buffer) {
+    if (clientHandler->connected) {
+        // A local client that fell behind misses everything until its queue has
+        // drained, then gets the same resync as a client resuming after an overflow.
+        // The keyframe's enemy totals leave out its own damage, so the client can
+        // apply them on top of what it got before the drop (see RoomKeyframe.h)
+        if (clientHandler->missedOverflow && clientHandler->local) {
+            const FrameQueue& queue = clientHandler->local->toClient;
+            if (queue.size() > queue.capacity() / 2) {
+                ++clientHandler->metrics->dropped;
+                ++roomMetrics.dropped;
+                return;
+            }
+            flushMissedFrames(clientHandler);
+        }
+        if (!sendFrame(clientHandler, buffer)) {
+            clientHandler->missedOverflow = true;
+            ++clientHandler->metrics->dropped;
+            ++roomMetrics.dropped;
+            return;
+        }
+        size_t bytes = sizeof(uint32_t) + buffer.size();
+        clientHandler->metrics->framesOut.fetch_add(1, std::memory_order_relaxed);
+        clientHandler->metrics->bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+        roomMetrics.framesOut.fetch_add(1, std::memory_order_relaxed);
+        roomMetrics.bytesOut.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    else if (buffer.size() >= 2 && buffer[0] == SNAPSHOT_MESSAGE) {
+        clientHandler->missedSnapshots[buffer[1]] = buffer;
+    }
+    else if (clientHandler->missedFrames.size() < MAX_MISSED_FRAMES) {
+        clientHandler->missedFrames.push_back(buffer);
+    }
+    else {
+        clientHandler->missedOverflow = true;
+        ++clientHandler->metrics->dropped;
+        ++roomMetrics.dropped;
+    }
+}
 
+void Server::deliverFrame(ClientHandler* clientHandler, const BaseMessage& msg) {
     std::vector<uint8_t> buffer;
-    BaseMessage::serializeMessage(clientListMessage, buffer);
+    BaseMessage::serializeMessage(msg, buffer);
+    deliverFrame(clientHandler, buffer);
+}
+
+bool Server::receiveFrame(SOCKET socket, LocalChannel* local, std::vector<uint8_t>& buffer) {
+    if (local)
+        return local->toServer.pop(buffer);
+
+    uint32_t msgSize;
+    size_t totalReceived = 0;
+    while (totalReceived < sizeof(msgSize)) {
+        int bytesReceived = recv(socket, (char*)&msgSize + totalReceived, sizeof(msgSize) - totalReceived, 0);
+        if (bytesReceived <= 0) return false;
+        totalReceived += bytesReceived;
+    }
+    msgSize = ntohl(msgSize);
+
+    buffer.resize(msgSize);
+    totalReceived = 0;
+    while (totalReceived < msgSize) {
+        int bytesReceived = recv(socket, (char*)buffer.data() + totalReceived, msgSize - totalReceived, 0);
+        if (bytesReceived <= 0) return false;
+        totalReceived += bytesReceived;
+    }
+    return true;
+}
+
+bool Server::sendFrame(const ClientHandler* clientHandler, const std::vector<uint8_t>& buffer) {
+    if (clientHandler->local) {
+        // Full means the client stopped reading; a closed queue is handled by its serve thread
+        return clientHandler->local->toClient.push(buffer) || clientHandler->local->toClient.isClosed();
+    }
+    if (sendWorkers.empty() || !clientHandler->outbox) {
+        writeFrame(clientHandler->socket, buffer);
+        return true;
+    }
+
+    // Hand the frame to a worker so a slow client can't hold up clientsMutex
+    const auto& outbox = clientHandler->outbox;
+    {
+        std::lock_guard<std::mutex> lock(outbox->mutex);
+        outbox->frames.push_back(buffer);
+        if (outbox->scheduled)
+            return true;
+        outbox->scheduled = true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        sendQueue.push_back(outbox);
+    }
+    sendReady.notify_one();
+    return true;
+}
+
+void Server::writeFrame(SOCKET socket, const std::vector<uint8_t>& buffer) {
+    // Length prefix and body in one send, so they leave in one segment
+    std::vector<uint8_t> frame(sizeof(uint32_t) + buffer.size());
     uint32_t msgSize = htonl(buffer.size());
+    std::memcpy(frame.data(), &msgSize, sizeof(msgSize));
+    std::memcpy(frame.data() + sizeof(msgSize), buffer.data(), buffer.size());
 
-    for (ClientHandler* clientHandler : clients) {
-        send(clientHandler->socket, (char*)&msgSize, sizeof(msgSize), 0);
-        send(clientHandler->socket, (char*)buffer.data(), buffer.size(), 0);
+    size_t totalSent = 0;
+    while (totalSent < frame.size()) {
+        int bytesSent = send(socket, (char*)frame.data() + totalSent, frame.size() - totalSent, MSG_NOSIGNAL);
+        if (bytesSent <= 0) return;
+        totalSent += bytesSent;
+    }
+}
+
+void Server::runSendWorker() {
+    while (true) {
+        std::shared_ptr<Outbox> outbox;
+        {
+            std::unique_lock<std::mutex> lock(sendMutex);
+            sendReady.wait(lock, [this] { return !sendQueue.empty() || !isRunning; });
+            if (sendQueue.empty())
+                return;
+            outbox = std::move(sendQueue.front());
+            sendQueue.pop_front();
+        }
+
+        // Only one worker drains an outbox at a time, which keeps its frames in order
+        std::deque<std::vector<uint8_t>> frames;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(outbox->mutex);
+                if (outbox->frames.empty() || outbox->closed) {
+                    outbox->scheduled = false;
+                    break;
+                }
+                frames.swap(outbox->frames);
+            }
+            for (const auto& frame : frames)
+                writeFrame(outbox->socket, frame);
+            frames.clear();
+        }
     }
-    logOption_->LogMessage(LogLevel::Log_Debug, "Notified all clients about current client list");
 }
 
 void Server::stop() {
     isRunning = false;
-    closesocket(listeningSocket);
+    if (listeningSocket != INVALID_SOCKET) {
+#ifndef _WIN32
+        // Closing alone doesn't wake a thread blocked in accept on Linux
+        shutdown(listeningSocket, SHUT_RDWR);
+#endif
+        closesocket(listeningSocket);
+        listeningSocket = INVALID_SOCKET;
+    }
+    if (acceptThread.joinable())
+        acceptThread.join();
+    if (tickThread.joinable())
+        tickThread.join();
+    {
+        std::unique_lock<std::mutex> lock(clientsMutex);
+        for (const auto& clientHandler : clients) {
+            if (clientHandler->local)
+                clientHandler->local->close();
+            else if (clientHandler->connected)
+                shutdown(clientHandler->socket, SHUT_RDWR);
+        }
+        // Client threads leave once their connection is shut down
+        servingDone.wait_for(lock, std::chrono::seconds(2), [this] { return servingThreads == 0; });
+    }
+    {
+        std::lock_guard<std::mutex> lock(sendMutex);
+        sendQueue.clear();
+    }
+    sendReady.notify_all();
+    for (auto& worker : sendWorkers) {
+        if (worker.joinable())
+            worker.join();
+    }
+    sendWorkers.clear();
+    if (metricsEndpoint) {
+        metricsEndpoint->stop();
+        metricsEndpoint.reset();
+    }
+    if (capture) {
+        capture->close();
+        logOption_->LogMessage(LogLevel::Log_Info, "Captured", capture->getFrames(), "frames,", capture->getDropped(), "dropped");
+        capture.reset();
+    }
 #ifdef _WIN32
     WSACleanup();
 #endif
-}
\ No newline at end of file
+}
+namespace {
+
+const char* messageTypeName(size_t type) {
+    static const char* names[] = { "base", "text", "event", "snapshot", "client_list", "client_id", "client_join",
+        "client_leave", "client_list_request", "client_hello", "keyframe" };
+    return type < sizeof(names) / sizeof(names[0]) ? names[type] : "other";
+}
+
+std::string dataLabelName(size_t label) {
+    switch (static_cast<DataLabel>(label)) {
+    case DataLabel::SERVER: return "SERVER";
+    case DataLabel::CONNECTED_PLAYER_SNAP: return "CONNECTED_PLAYER_SNAP";
+    case DataLabel::CONNECTED_PLAYER_LEVEL: return "CONNECTED_PLAYER_LEVEL";
+    case DataLabel::ENEMIES_HEALTH: return "ENEMIES_HEALTH";
+    case DataLabel::INVENTORY: return "INVENTORY";
+    default: return std::to_string(label);
+    }
+}
+
+}
+
+std::string Server::renderMetrics() {
+    std::ostringstream out;
+
+    // Per connection, read under the lock so the set of clients is consistent
+    struct ConnectionRow {
+        std::string labels;
+        std::shared_ptr<ConnectionMetrics> metrics;
+        bool connected;
+        size_t queued;
+    };
+    std::vector<ConnectionRow> rows;
+    size_t clientThreads;
+    {
+        std::lock_guard<std::mutex> lock(clientsMutex);
+        clientThreads = servingThreads;
+        for (const auto& clientHandler : clients) {
+            ConnectionRow row;
+            row.labels = "client=\"" + std::to_string(clientHandler->clientID) + "\",address=\"" + clientHandler->ipAddress + "\"";
+            row.metrics = clientHandler->metrics;
+            row.connected = clientHandler->connected;
+            if (!clientHandler->connected) {
+                row.queued = clientHandler->missedFrames.size() + clientHandler->missedSnapshots.size();
+            }
+            else if (clientHandler->local) {
+                row.queued = clientHandler->local->toClient.size();
+            }
+            else if (clientHandler->outbox) {
+                std::lock_guard<std::mutex> outboxLock(clientHandler->outbox->mutex);
+                row.queued = clientHandler->outbox->frames.size();
+            }
+            else {
+                row.queued = 0;
+            }
+            rows.push_back(row);
+        }
+    }
+
+    size_t connected = std::count_if(rows.begin(), rows.end(), [](const ConnectionRow& row) { return row.connected; });
+    writeMetricHeader(out, "hobbit_room_clients", "gauge", "Clients in the room, connected or waiting to resume.");
+    writeMetric(out, "hobbit_room_clients", "state=\"connected\"", connected);
+    writeMetric(out, "hobbit_room_clients", "state=\"suspended\"", rows.size() - connected);
+
+    struct Counter {
+        const char* name;
+        std::atomic<uint64_t> ConnectionMetrics::* value;
+        const char* help;
+    };
+    const Counter counters[] = {
+        { "frames_in", &ConnectionMetrics::framesIn, "Frames received from the client." },
+        { "bytes_in", &ConnectionMetrics::bytesIn, "Bytes received from the client, length prefix included." },
+        { "frames_out", &ConnectionMetrics::framesOut, "Frames handed to the client's socket or queue." },
+        { "bytes_out", &ConnectionMetrics::bytesOut, "Bytes handed to the client's socket or queue." },
+        { "dropped_frames", &ConnectionMetrics::dropped, "Frames the client never got." },
+    };
+    for (const auto& counter : counters) {
+        std::string name = std::string("hobbit_connection_") + counter.name + "_total";
+        writeMetricHeader(out, name, "counter", counter.help);
+        for (const auto& row : rows)
+            writeMetric(out, name, row.labels, ((*row.metrics).*counter.value).load());
+    }
+    writeMetricHeader(out, "hobbit_connection_send_queue_frames", "gauge",
+        "Frames waiting to be written to the client, or kept for it while it is dropped.");
+    for (const auto& row : rows)
+        writeMetric(out, "hobbit_connection_send_queue_frames", row.labels, row.queued);
+
+    writeMetricHeader(out, "hobbit_room_frames_in_total", "counter", "Frames received, by message type.");
+    for (size_t type = 0; type < RoomMetrics::MESSAGE_TYPES; ++type) {
+        uint64_t frames = roomMetrics.framesInByType[type].load();
+        if (frames > 0)
+            writeMetric(out, "hobbit_room_frames_in_total", std::string("type=\"") + messageTypeName(type) + "\"", frames);
+    }
+    writeMetricHeader(out, "hobbit_room_records_total", "counter", "Game records in relayed snapshots and events, by DataLabel.");
+    for (size_t label = 0; label < roomMetrics.recordsByLabel.size(); ++label) {
+        uint64_t records = roomMetrics.recordsByLabel[label].load();
+        if (records > 0)
+            writeMetric(out, "hobbit_room_records_total", "label=\"" + dataLabelName(label) + "\"", records);
+    }
+    writeMetricHeader(out, "hobbit_room_bytes_in_total", "counter", "Bytes received, length prefix included.");
+    writeMetric(out, "hobbit_room_bytes_in_total", "", roomMetrics.bytesIn.load());
+    writeMetricHeader(out, "hobbit_room_frames_out_total", "counter", "Frames handed to client sockets or queues.");
+    writeMetric(out, "hobbit_room_frames_out_total", "", roomMetrics.framesOut.load());
+    writeMetricHeader(out, "hobbit_room_bytes_out_total", "counter", "Bytes handed to client sockets or queues.");
+    writeMetric(out, "hobbit_room_bytes_out_total", "", roomMetrics.bytesOut.load());
+    writeMetricHeader(out, "hobbit_room_dropped_frames_total", "counter", "Frames a client never got.");
+    writeMetric(out, "hobbit_room_dropped_frames_total", "", roomMetrics.dropped.load());
+    writeMetricHeader(out, "hobbit_room_ticks_total", "counter", "Ticks that sent out merged events.");
+    writeMetric(out, "hobbit_room_ticks_total", "", roomMetrics.ticks.load());
+
+    writeMetricHeader(out, "hobbit_room_relay_latency_seconds", "histogram", "From a frame received to it handed to every recipient.");
+    roomMetrics.relayLatency.write(out, "hobbit_room_relay_latency_seconds");
+    writeMetricHeader(out, "hobbit_room_tick_duration_seconds", "histogram", "Merging and sending out the events of one tick.");
+    roomMetrics.tickDuration.write(out, "hobbit_room_tick_duration_seconds");
+
+    writeMetricHeader(out, "hobbit_server_threads", "gauge", "Threads the server is running, by job.");
+    writeMetric(out, "hobbit_server_threads", "kind=\"client\"", clientThreads);
+    writeMetric(out, "hobbit_server_threads", "kind=\"send_worker\"", sendWorkers.size());
+    writeMetric(out, "hobbit_server_threads", "kind=\"accept\"", acceptThread.joinable());
+    writeMetric(out, "hobbit_server_threads", "kind=\"tick\"", tickThread.joinable());
+    writeMetric(out, "hobbit_server_threads", "kind=\"metrics\"", metricsEndpoint != nullptr);
+    writeMetric(out, "hobbit_server_threads", "kind=\"capture\"", capture != nullptr);
+
+    if (capture) {
+        writeMetricHeader(out, "hobbit_capture_frames_total", "counter", "Frames written to the capture file.");
+        writeMetric(out, "hobbit_capture_frames_total", "", capture->getFrames());
+        writeMetricHeader(out, "hobbit_capture_dropped_frames_total", "counter", "Frames the capture writer couldn't keep up with.");
+        writeMetric(out, "hobbit_capture_dropped_frames_total", "", capture->getDropped());
+    }
+    return out.str();
+}
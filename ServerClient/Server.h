@@ -8,42 +8,168 @@
 #include <cstring>
 #include <cstdint>
 #include <string>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <deque>
+#include <condition_variable>
+#include <algorithm>
 
 #include "platform-specific.h"
 #include "Message.h"
+#include "SlotMap.h"
+#include "RoomKeyframe.h"
+#include "EventMerger.h"
+#include "LocalChannel.h"
+#include "SessionCapture.h"
+#include "ServerMetrics.h"
+#include "MetricsEndpoint.h"
 #include "../LogSystem/LogManager.h"
 #define PORT 54000
 
+// Client IDs are derived from the slot index, so they are recycled with the slots
+const size_t MAX_CLIENTS = 255;
+// How long a dropped client keeps its ID and slot while it tries to resume
+const std::chrono::milliseconds RESUME_GRACE_PERIOD(10000);
+// Frames kept for a dropped client; past this it gets a full client list instead
+const size_t MAX_MISSED_FRAMES = 512;
+// Enemy health and inventory changes are merged and sent out once per tick
+const std::chrono::milliseconds SERVER_TICK(50);
+
+// Settings a dedicated server can override from its command line or config file
+struct ServerConfig {
+    uint16_t port = PORT;
+    std::chrono::milliseconds tickInterval = SERVER_TICK;
+    // Threads that write queued frames to client sockets; 0 sends on the relaying thread
+    size_t workerThreads = 0;
+    // Clients in the room, at most MAX_CLIENTS
+    size_t maxClients = MAX_CLIENTS;
+    // Records every received frame to this file (see SessionCapture.h), empty for none
+    std::string capturePath;
+    // Prometheus endpoint (GET /metrics), 0 for none. Local only unless the address says otherwise
+    uint16_t metricsPort = 0;
+    std::string metricsAddress = "127.0.0.1";
+};
+
+// Frames waiting to be written to one client socket. Owns the socket, so a
+// worker still writing after the client dropped never touches a reused handle.
+struct Outbox {
+    SOCKET socket;
+    std::mutex mutex;
+    std::deque<std::vector<uint8_t>> frames;
+    bool scheduled = false;     // queued for (or being drained by) a worker
+    bool closed = false;
+
+    explicit Outbox(SOCKET s) : socket(s) {}
+    ~Outbox() { closesocket(socket); }
+};
+
 struct ClientHandler {
     SOCKET socket;
     uint8_t clientID;
     std::string ipAddress;
     uint16_t port;
+    uint16_t udpPort = 0;
+    std::shared_ptr<LocalChannel> local;    // set for an in-process client instead of socket
+    std::shared_ptr<Outbox> outbox;         // set for a socket client
     std::thread thread;
+    SlotHandle handle;
+    std::shared_ptr<ConnectionMetrics> metrics = std::make_shared<ConnectionMetrics>();
+
+    // Session resumption
+    uint64_t resumeToken = 0;
+    bool connected = true;
+    std::chrono::steady_clock::time_point disconnectedAt;
+    std::vector<std::vector<uint8_t>> missedFrames;              // everything but snapshots, in order
+    std::map<uint8_t, std::vector<uint8_t>> missedSnapshots;     // only the latest snapshot per sender
+    bool missedOverflow = false;                                 // also set while a local client's queue is full
 };
 
 class Server {
     LogOption::Ptr logOption_;
 
 public:
-    Server() : nextClientID(1), isRunning(true), logOption_(LogManager::Instance().CreateLogOption("SERVER")) {}
+    explicit Server(const ServerConfig& config = ServerConfig()) : logOption_(LogManager::Instance().CreateLogOption("SERVER")), config(config), isRunning(true) {}
     ~Server() { stop(); }
 
-    void start();
+    // Returns false if the listening socket couldn't be set up
+    bool start();
     void stop();
     bool getIsRunning() { return isRunning; };
     void broadcastMessage(const BaseMessage& msg, uint8_t excludeID = 0);
+    // Connects a client in the same process without a socket (see Client::connectLocal).
+    // ipAddress is what other clients see for it, e.g. for the snapshot mesh
+    std::shared_ptr<LocalChannel> attachLocalClient(const std::string& ipAddress = "127.0.0.1");
+    // Connected clients, not counting dropped ones waiting to resume
+    size_t getClientCount();
+    // Everything the metrics endpoint serves, in the Prometheus text format
+    std::string renderMetrics();
 
 private:
-    SOCKET listeningSocket;
-    std::vector<ClientHandler*> clients;
-    uint8_t nextClientID;
+    ServerConfig config;
+    SOCKET listeningSocket = INVALID_SOCKET;
+    SlotMap<std::unique_ptr<ClientHandler>> clients;
     std::mutex clientsMutex;
     bool isRunning;
+    uint32_t clientListVersion = 0;
+    RoomKeyframe keyframe;
+    EventMerger tickEvents;
+    std::unique_ptr<CaptureWriter> capture;
+    RoomMetrics roomMetrics;
+    std::unique_ptr<MetricsEndpoint> metricsEndpoint;
+
+    std::mt19937_64 tokenGenerator{ std::random_device{}() };
+
+    // Joined by stop(), so nothing touches the server after it is destroyed
+    std::thread acceptThread;
+    std::thread tickThread;
+    size_t servingThreads = 0;      // client threads still running (clientsMutex)
+    std::condition_variable servingDone;
+
+    // Send workers
+    std::vector<std::thread> sendWorkers;
+    std::mutex sendMutex;
+    std::condition_variable sendReady;
+    std::deque<std::shared_ptr<Outbox>> sendQueue;
 
     void acceptClients();
-    void handleClient(ClientHandler* clientHandler);
-    void notifyClients();
+    void handleClient(SOCKET clientSocket, std::string ipAddress, uint16_t port);
+    void handleLocalClient(std::shared_ptr<LocalChannel> local, std::string ipAddress);
+    // Handshake and message loop shared by socket and local clients
+    void serveClient(SOCKET clientSocket, std::shared_ptr<Outbox> outbox, std::shared_ptr<LocalChannel> local, const std::string& ipAddress, uint16_t port);
+    void processMessage(SlotHandle handle, uint8_t clientID, BaseMessage* msg);
+    void countReceived(ConnectionMetrics& metrics, const std::vector<uint8_t>& buffer);
+    // Broadcasts a game message, or queues its changes for the tick, and updates the keyframe in one step
+    void relayMessage(const BaseMessage& msg);
+    void runTicks();
+    void flushTickEvents();
+
+    // Sessions
+    bool registerClient(SOCKET clientSocket, std::shared_ptr<Outbox> outbox, std::shared_ptr<LocalChannel> local, const std::string& ipAddress, uint16_t port,
+        const BaseMessage* hello, SlotHandle& handle, uint8_t& clientID);
+    void suspendClient(SlotHandle handle, SOCKET clientSocket, const LocalChannel* local);
+    // Closes the outbox of a connection that is gone, counting what it still held as dropped
+    void dropOutbox(ClientHandler* clientHandler);
+    void expireSuspendedClients();
+    // Frees the slot and tells everyone (clientsMutex must be held)
+    void removeClient(SlotHandle handle);
+    void flushMissedFrames(ClientHandler* clientHandler);
+
+    // Client list sync (clientsMutex must be held)
+    void sendClientList(ClientHandler* clientHandler);
+    void broadcastClientJoin(ClientHandler* joined);
+    void broadcastClientLeave(uint8_t clientID);
+    static void pushClientEntry(BaseMessage& msg, const ClientHandler* clientHandler);
+
+    // Sends to a connected client, or keeps the frame for a dropped one (clientsMutex must be held)
+    void deliverFrame(ClientHandler* clientHandler, const std::vector<uint8_t>& buffer);
+    void deliverFrame(ClientHandler* clientHandler, const BaseMessage& msg);
+
+    static bool receiveFrame(SOCKET socket, LocalChannel* local, std::vector<uint8_t>& buffer);
+    // False if a local client's queue was full and the frame was dropped
+    bool sendFrame(const ClientHandler* clientHandler, const std::vector<uint8_t>& buffer);
+    static void writeFrame(SOCKET socket, const std::vector<uint8_t>& buffer);
+    void runSendWorker();
 };
 
 #endif // SERVER_H
\ No newline at end of file
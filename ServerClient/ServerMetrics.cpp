@@ -0,0 +1,37 @@
+#include "ServerMetrics.h"
+
+void MetricsHistogram::record(uint64_t micros) {
+    size_t bucket = 0;
+    while (bucket < BOUNDS_US.size() && micros > BOUNDS_US[bucket])
+        ++bucket;
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sumUs.fetch_add(micros, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MetricsHistogram::write(std::ostream& out, const std::string& name, const std::string& labels) const {
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    // Prometheus buckets are cumulative
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < BOUNDS_US.size(); ++i) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+        out << name << "_bucket{" << prefix << "le=\"" << BOUNDS_US[i] / 1e6 << "\"} " << cumulative << "\n";
+    }
+    cumulative += buckets.back().load(std::memory_order_relaxed);
+    out << name << "_bucket{" << prefix << "le=\"+Inf\"} " << cumulative << "\n";
+    std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << braces << " " << sumUs.load(std::memory_order_relaxed) / 1e6 << "\n";
+    out << name << "_count" << braces << " " << cumulative << "\n";
+}
+
+void writeMetricHeader(std::ostream& out, const std::string& name, const char* type, const char* help) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+void writeMetric(std::ostream& out, const std::string& name, const std::string& labels, uint64_t value) {
+    out << name;
+    if (!labels.empty())
+        out << "{" << labels << "}";
+    out << " " << value << "\n";
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <array>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+// Latency histogram with fixed buckets, written in the Prometheus histogram
+// layout. Any thread can record into it without a lock.
+class MetricsHistogram {
+public:
+    // Upper bounds of the buckets in microseconds; anything slower lands in +Inf
+    static constexpr std::array<uint64_t, 14> BOUNDS_US = {
+        10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000,
+    };
+
+    void record(uint64_t micros);
+    // Writes name_bucket, name_sum and name_count in seconds; labels is "" or `key="value",...`
+    void write(std::ostream& out, const std::string& name, const std::string& labels = "") const;
+
+private:
+    std::array<std::atomic<uint64_t>, BOUNDS_US.size() + 1> buckets{};
+    std::atomic<uint64_t> sumUs{ 0 };
+    std::atomic<uint64_t> count{ 0 };
+};
+
+// Counters of one client session, kept across resumes. Updated by the
+// client's own thread (in) and by whoever delivers to it (out).
+struct ConnectionMetrics {
+    std::atomic<uint64_t> framesIn{ 0 };
+    std::atomic<uint64_t> bytesIn{ 0 };
+    std::atomic<uint64_t> framesOut{ 0 };
+    std::atomic<uint64_t> bytesOut{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };    // frames it never got: missed-frame overflow, outbox discarded on drop
+};
+
+// Counters of the whole room
+struct RoomMetrics {
+    static const size_t MESSAGE_TYPES = 16;    // higher types are counted under the last one
+
+    std::array<std::atomic<uint64_t>, MESSAGE_TYPES> framesInByType{};
+    std::array<std::atomic<uint64_t>, 256> recordsByLabel{};    // game records relayed, per DataLabel
+    std::atomic<uint64_t> bytesIn{ 0 };
+    std::atomic<uint64_t> framesOut{ 0 };
+    std::atomic<uint64_t> bytesOut{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> ticks{ 0 };
+    MetricsHistogram relayLatency;      // frame received to handed to every recipient
+    MetricsHistogram tickDuration;      // merging and sending out one tick's events
+};
+
+// Prometheus text format helpers
+void writeMetricHeader(std::ostream& out, const std::string& name, const char* type, const char* help);
+void writeMetric(std::ostream& out, const std::string& name, const std::string& labels, uint64_t value);
@@ -0,0 +1,151 @@
+#include "SessionCapture.h"
+
+#include <algorithm>
+
+namespace {
+
+const size_t HEADER_SIZE = 16;
+
+void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+template<typename T>
+void appendLittleEndian(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i)
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+}
+
+}
+
+bool CaptureWriter::open(const std::string& path) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        return false;
+
+    uint64_t wallClockMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<uint8_t> header(CAPTURE_MAGIC, CAPTURE_MAGIC + sizeof(CAPTURE_MAGIC));
+    appendLittleEndian(header, CAPTURE_VERSION);
+    appendLittleEndian(header, uint16_t(0));
+    appendLittleEndian(header, wallClockMs);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+    startedAt = std::chrono::steady_clock::now();
+    closing = false;
+    writerThread = std::thread(&CaptureWriter::writeFrames, this);
+    return true;
+}
+
+void CaptureWriter::record(uint8_t senderID, const std::vector<uint8_t>& body) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!writerThread.joinable() || closing)
+        return;
+    if (queuedBytes + body.size() > CAPTURE_MAX_PENDING_BYTES) {
+        ++dropped;
+        return;
+    }
+    // Stamped under the lock, so the queue is in time order across client threads
+    uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startedAt).count();
+    queue.push_back({ micros, senderID, body });
+    queuedBytes += body.size();
+    pending.notify_one();
+}
+
+void CaptureWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closing = true;
+    }
+    pending.notify_one();
+    if (writerThread.joinable())
+        writerThread.join();
+    if (file.is_open())
+        file.close();
+}
+
+void CaptureWriter::writeFrames() {
+    std::vector<uint8_t> out;
+    while (true) {
+        std::deque<CapturedFrame> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            pending.wait(lock, [this] { return closing || !queue.empty(); });
+            if (queue.empty())
+                return;
+            batch.swap(queue);
+            queuedBytes = 0;
+        }
+
+        out.clear();
+        for (const auto& frame : batch) {
+            appendVarint(out, frame.micros - lastMicros);
+            lastMicros = frame.micros;
+            out.push_back(frame.senderID);
+            appendVarint(out, frame.body.size());
+            out.insert(out.end(), frame.body.begin(), frame.body.end());
+        }
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+        file.flush();
+        frames += batch.size();
+    }
+}
+
+bool CaptureReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    uint8_t header[HEADER_SIZE];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+    if (!std::equal(CAPTURE_MAGIC, CAPTURE_MAGIC + sizeof(CAPTURE_MAGIC), header))
+        return false;
+    uint16_t version = header[4] | (header[5] << 8);
+    if (version != CAPTURE_VERSION)
+        return false;
+
+    startedAtMs = 0;
+    for (size_t i = 0; i < sizeof(startedAtMs); ++i)
+        startedAtMs |= static_cast<uint64_t>(header[8 + i]) << (8 * i);
+    firstRecord = file.tellg();
+    micros = 0;
+    return true;
+}
+
+bool CaptureReader::next(CapturedFrame& frame) {
+    uint64_t delta, size;
+    char senderID;
+    if (!readVarint(delta) || !file.get(senderID) || !readVarint(size))
+        return false;
+    // The writer never queues a bigger frame; a size past it is a corrupt file
+    if (size > CAPTURE_MAX_PENDING_BYTES)
+        return false;
+    frame.body.resize(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(frame.body.data()), size))
+        return false;
+    micros += delta;
+    frame.micros = micros;
+    frame.senderID = static_cast<uint8_t>(senderID);
+    return true;
+}
+
+void CaptureReader::rewind() {
+    file.clear();
+    file.seekg(firstRecord);
+    micros = 0;
+}
+
+bool CaptureReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        char byte;
+        if (!file.get(byte))
+            return false;
+        value |= static_cast<uint64_t>(static_cast<uint8_t>(byte) & 0x7F) << shift;
+        if (!(static_cast<uint8_t>(byte) & 0x80))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Capture file: every frame the server received, in arrival order.
+//   header: "HCAP", u16 version, u16 reserved, u64 wall clock start (ms since the epoch)
+//   record: varint microseconds since the previous record, u8 sender ID,
+//           varint body size, body ([type][sender][payload] as received)
+// Integers in the header are little-endian.
+const char CAPTURE_MAGIC[4] = { 'H', 'C', 'A', 'P' };
+const uint16_t CAPTURE_VERSION = 1;
+// Frames waiting for the disk; past this new ones are dropped (and counted) instead of stalling the relay
+const size_t CAPTURE_MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+struct CapturedFrame {
+    uint64_t micros = 0;        // since the start of the capture
+    uint8_t senderID = 0;
+    std::vector<uint8_t> body;
+};
+
+// Append-only writer. record() only timestamps the frame and queues it;
+// a thread of its own writes the queue out.
+class CaptureWriter {
+public:
+    ~CaptureWriter() { close(); }
+
+    bool open(const std::string& path);
+    void record(uint8_t senderID, const std::vector<uint8_t>& body);
+    // Writes what is queued and closes the file
+    void close();
+
+    uint64_t getFrames() const { return frames; }
+    uint64_t getDropped() const { return dropped; }
+
+private:
+    std::ofstream file;
+    std::thread writerThread;
+    std::mutex mutex;
+    std::condition_variable pending;
+    std::deque<CapturedFrame> queue;
+    size_t queuedBytes = 0;
+    bool closing = false;
+    std::chrono::steady_clock::time_point startedAt;
+    uint64_t lastMicros = 0;    // writer thread only
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+
+    void writeFrames();
+};
+
+class CaptureReader {
+public:
+    bool open(const std::string& path);
+    // Returns false at the end of the file or on a truncated record
+    bool next(CapturedFrame& frame);
+    void rewind();
+
+    uint64_t getStartedAtMs() const { return startedAtMs; }
+
+private:
+    std::ifstream file;
+    std::streampos firstRecord;
+    uint64_t startedAtMs = 0;
+    uint64_t micros = 0;
+
+    bool readVarint(uint64_t& value);
+};
@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <utility>
+#include <cstddef>
+
+// Handle to an element of a SlotMap. The generation changes every time a slot
+// is reused, so a handle kept after its element was removed never matches the
+// element that later took the same slot.
+struct SlotHandle {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != UINT32_MAX; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Generational slot map
+// - insert, remove and lookup by handle are O(1)
+// - values are kept densely packed, so iteration touches only live elements
+// - removal moves the last value into the hole, iteration order is not kept
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            // Reuse the oldest free slot first, which delays ID recycling as long as possible
+            index = freeSlots.front();
+            freeSlots.pop_front();
+        }
+        else {
+            index = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+
+        Slot& slot = slots[index];
+        slot.denseIndex = static_cast<uint32_t>(values.size());
+        slot.occupied = true;
+
+        values.push_back(std::move(value));
+        denseToSlot.push_back(index);
+
+        return SlotHandle{ index, slot.generation };
+    }
+
+    bool remove(SlotHandle handle) {
+        if (!contains(handle))
+            return false;
+
+        Slot& slot = slots[handle.index];
+        uint32_t hole = slot.denseIndex;
+        uint32_t last = static_cast<uint32_t>(values.size() - 1);
+
+        if (hole != last) {
+            values[hole] = std::move(values[last]);
+            denseToSlot[hole] = denseToSlot[last];
+            slots[denseToSlot[hole]].denseIndex = hole;
+        }
+        values.pop_back();
+        denseToSlot.pop_back();
+
+        slot.occupied = false;
+        ++slot.generation;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots.size()
+            && slots[handle.index].occupied
+            && slots[handle.index].generation == handle.generation;
+    }
+
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+    }
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values[slots[handle.index].denseIndex] : nullptr;
+    }
+
+    // Handle of the value at a dense position, useful while iterating
+    SlotHandle handleAt(size_t denseIndex) const {
+        uint32_t index = denseToSlot[denseIndex];
+        return SlotHandle{ index, slots[index].generation };
+    }
+
+    size_t size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    // Number of slots ever created, live or free
+    size_t capacity() const { return slots.size(); }
+
+    void clear() {
+        for (uint32_t index : denseToSlot) {
+            slots[index].occupied = false;
+            ++slots[index].generation;
+            freeSlots.push_back(index);
+        }
+        values.clear();
+        denseToSlot.clear();
+    }
+
+    iterator begin() { return values.begin(); }
+    iterator end() { return values.end(); }
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end() const { return values.end(); }
+
+private:
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t denseIndex = 0;
+        bool occupied = false;
+    };
+
+    std::vector<T> values;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::deque<uint32_t> freeSlots;
+};
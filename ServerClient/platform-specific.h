@@ -5,13 +5,22 @@
 #include <ws2tcpip.h> // Include this header for InetPton
 #pragma comment(lib, "ws2_32.lib")
 typedef int socklen_t;
+#define SHUT_RDWR SD_BOTH
 #else
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <netdb.h>
 #define SOCKET int
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
+inline int closesocket(SOCKET socket) { return close(socket); }
+#endif
+
+// Keeps a send to a peer that already hung up from raising SIGPIPE on Linux
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
 #endif
 
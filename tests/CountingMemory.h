@@ -0,0 +1,58 @@
+#pragma once
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "../HobbitGameManager/FakeRemoteMemory.h"
+
+// A faked address space that counts the calls reaching it, for the tests of
+// the caches and batches between the analyzer and the game. A batch is one
+// call, whatever it holds.
+namespace test {
+
+class CountingMemory : public FakeRemoteMemory {
+public:
+    uint64_t reads = 0;             // single reads
+    uint64_t batches = 0;           // read batches
+    uint64_t requests = 0;          // requests in those batches
+    uint64_t writeBatches = 0;
+    std::vector<std::pair<uint64_t, size_t>> written;   // address and size of every write, batched or not
+
+    bool read(uint64_t address, void* buffer, size_t size) override {
+        ++reads;
+        return FakeRemoteMemory::read(address, buffer, size);
+    }
+    size_t readBatch(ReadRequest* batch, size_t count) override {
+        ++batches;
+        requests += count;
+        size_t succeeded = 0;
+        for (size_t i = 0; i < count; ++i) {
+            batch[i].ok = FakeRemoteMemory::read(batch[i].address, batch[i].buffer, batch[i].size);
+            succeeded += batch[i].ok;
+        }
+        return succeeded;
+    }
+    bool write(uint64_t address, const void* data, size_t size) override {
+        written.push_back({ address, size });
+        return FakeRemoteMemory::write(address, data, size);
+    }
+    size_t writeBatch(WriteRequest* batch, size_t count) override {
+        ++writeBatches;
+        return FakeRemoteMemory::writeBatch(batch, count);
+    }
+    uint64_t calls() const { return reads + batches; }
+
+    // What the game has at the address, bypassing the counters
+    template <typename T>
+    void set(uint64_t address, T value) {
+        std::memcpy(data(address), &value, sizeof(value));
+    }
+    template <typename T>
+    T get(uint64_t address) {
+        T value{};
+        std::memcpy(&value, data(address), sizeof(value));
+        return value;
+    }
+};
+
+} // namespace test
@@ -0,0 +1,142 @@
+// EventMerger: how the changes of one server tick are combined into the
+// consolidated events each client gets.
+
+#include <map>
+#include <vector>
+
+#include "../ServerClient/EventMerger.h"
+#include "TestCheck.h"
+
+namespace {
+
+GameRecords enemyRecords(const std::vector<EnemyHealthChange>& enemies) {
+    GameRecords records;
+    records.enemies = enemies;
+    return records;
+}
+GameRecords inventoryRecords(const std::vector<InventoryCounterEntry>& inventory) {
+    GameRecords records;
+    records.inventory = inventory;
+    return records;
+}
+
+// Everything the events for one receiver carry, by label
+GameRecords receivedBy(const EventMerger& merger, uint8_t receiverID) {
+    GameRecords all;
+    for (const BaseMessage& msg : merger.buildFor(receiverID)) {
+        CHECK(msg.messageType == EVENT_MESSAGE);
+        GameRecords records;
+        CHECK(parseGameRecords(msg.message, records));
+        CHECK(records.labels.size() == 1);
+        all.enemies.insert(all.enemies.end(), records.enemies.begin(), records.enemies.end());
+        all.inventory.insert(all.inventory.end(), records.inventory.begin(), records.inventory.end());
+    }
+    return all;
+}
+// Walks a body by the size bytes alone, the way a client skips labels it has turned off;
+// false unless every record ends where its size byte says
+bool walkBySize(const std::queue<uint8_t>& message, std::vector<uint8_t>& labels) {
+    std::vector<uint8_t> body;
+    for (std::queue<uint8_t> data = message; !data.empty(); data.pop())
+        body.push_back(data.front());
+    size_t offset = 0;
+    while (offset < body.size()) {
+        uint8_t label, size;
+        uint32_t count;
+        size_t dataStart = offset + 2;
+        if (!readRaw(body, offset, label) || !readRaw(body, offset, size) || !readRaw(body, offset, count))
+            return false;
+        size_t entrySize = label == static_cast<uint8_t>(DataLabel::ENEMIES_HEALTH) ? 12 : 17;
+        if (size != sizeof(uint32_t) + count * entrySize || dataStart + size > body.size())
+            return false;
+        offset = dataStart + size;
+        labels.push_back(label);
+    }
+    return true;
+}
+std::map<uint64_t, float> byGuid(const std::vector<EnemyHealthChange>& enemies) {
+    std::map<uint64_t, float> totals;
+    for (const auto& enemy : enemies)
+        totals[enemy.guid] += enemy.healthChange;
+    return totals;
+}
+
+void enemyChangesSumAcrossSenders() {
+    EventMerger merger;
+    merger.add(1, enemyRecords({ { 100, -5.0f }, { 200, -1.0f } }));
+    merger.add(1, enemyRecords({ { 100, -2.0f } }));
+    merger.add(2, enemyRecords({ { 100, -3.0f } }));
+
+    // A third client gets the total of both, in one entry per GUID
+    GameRecords third = receivedBy(merger, 3);
+    CHECK(third.enemies.size() == 2);
+    CHECK(byGuid(third.enemies) == (std::map<uint64_t, float>{ { 100, -10.0f }, { 200, -1.0f } }));
+
+    // A sender only gets what the others did, and nothing for keys only it touched
+    GameRecords first = receivedBy(merger, 1);
+    CHECK(byGuid(first.enemies) == (std::map<uint64_t, float>{ { 100, -3.0f } }));
+    GameRecords second = receivedBy(merger, 2);
+    CHECK(byGuid(second.enemies) == (std::map<uint64_t, float>{ { 100, -7.0f }, { 200, -1.0f } }));
+}
+
+void inventoryMergesByMaximum() {
+    const uint64_t replicaA = 0xA;
+    const uint64_t replicaB = 0xB;
+    EventMerger merger;
+    // Counters only grow; an older entry arriving late changes nothing
+    merger.add(1, inventoryRecords({ { 7, replicaA, 3.0f, 1.0f } }));
+    merger.add(1, inventoryRecords({ { 7, replicaA, 2.0f, 0.0f } }));
+    merger.add(2, inventoryRecords({ { 7, replicaB, 1.0f, 0.0f } }));
+
+    GameRecords third = receivedBy(merger, 3);
+    CHECK(third.inventory.size() == 2);
+    CHECK(merger.getInventory().entry(7, replicaA).increments == 3.0f);
+    CHECK(merger.getInventory().entry(7, replicaA).decrements == 1.0f);
+
+    // Its own counters aren't sent back to the client that sent them
+    GameRecords first = receivedBy(merger, 1);
+    CHECK(first.inventory.size() == 1 && first.inventory[0].replicaID == replicaB);
+}
+
+void longEnemyListKeepsSizeByte() {
+    std::vector<EnemyHealthChange> enemies;
+    for (uint64_t guid = 1; guid <= 50; ++guid)
+        enemies.push_back({ guid, -1.0f });
+    EventMerger merger;
+    merger.add(1, enemyRecords(enemies));
+
+    // Too long for one size byte, so it goes out as several records
+    std::vector<BaseMessage> messages = merger.buildFor(2);
+    CHECK(messages.size() == 1);
+    std::vector<uint8_t> labels;
+    CHECK(!messages.empty() && walkBySize(messages[0].message, labels));
+    CHECK(labels.size() == 3);
+    GameRecords records;
+    CHECK(!messages.empty() && parseGameRecords(messages[0].message, records));
+    CHECK(byGuid(records.enemies) == byGuid(enemies));
+}
+
+void emptyTickSendsNothing() {
+    EventMerger merger;
+    CHECK(merger.empty());
+    CHECK(merger.buildFor(1).empty());
+
+    merger.add(1, enemyRecords({ { 100, -1.0f } }));
+    CHECK(!merger.empty());
+    // Only the sender touched anything, so it gets nothing
+    CHECK(merger.buildFor(1).empty());
+
+    merger.clear();
+    CHECK(merger.empty());
+    CHECK(merger.buildFor(2).empty());
+}
+
+} // namespace
+
+int main() {
+    enemyChangesSumAcrossSenders();
+    inventoryMergesByMaximum();
+    longEnemyListKeepsSizeByte();
+    emptyTickSendsNothing();
+    return test::result();
+}
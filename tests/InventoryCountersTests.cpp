@@ -0,0 +1,164 @@
+// InventoryCounters: the PN-counters behind the shared inventory, and how a
+// room converges on them through the server tick and the keyframe when
+// clients leave, come back and have their client IDs reused.
+
+#include <vector>
+
+#include "../ServerClient/InventoryCounters.h"
+#include "../ServerClient/EventMerger.h"
+#include "../ServerClient/RoomKeyframe.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint8_t SLOT = 10;
+
+// One client: its own replica and its view of everyone's counters
+struct Replica {
+    uint64_t id = InventoryCounters::newReplicaID();
+    InventoryCounters counters;
+
+    InventoryCounterEntry change(float amount) {
+        counters.add(id, SLOT, amount);
+        return counters.entry(SLOT, id);
+    }
+    void receive(const std::vector<InventoryCounterEntry>& entries) {
+        for (const auto& entry : entries)
+            counters.merge(entry);
+    }
+    // What its game has on top of its own changes
+    float remote() const { return counters.valueExcept(SLOT, id); }
+    float total() const { return remote() + counters.entry(SLOT, id).increments - counters.entry(SLOT, id).decrements; }
+};
+
+// The server side: one tick through the merger into the keyframe
+void tick(RoomKeyframe& keyframe, uint8_t senderID, const InventoryCounterEntry& entry) {
+    GameRecords records;
+    records.inventory.push_back(entry);
+    EventMerger merger;
+    merger.add(senderID, records);
+    keyframe.applyEvents(merger);
+}
+
+// The inventory counters a late joiner gets from the keyframe
+std::vector<InventoryCounterEntry> keyframeInventory(const RoomKeyframe& keyframe) {
+    const uint8_t joinerID = 9;
+    std::queue<uint8_t> body = keyframe.buildMessage(joinerID).message;
+    CHECK(!body.empty() && body.front() == 0);      // no snapshots
+    body.pop();
+    CHECK(!body.empty() && body.front() == 0);      // no enemy levels
+    body.pop();
+    uint32_t size = 0;
+    CHECK(popUint32(body, size) && size == body.size());
+
+    GameRecords records;
+    CHECK(parseGameRecords(body, records));
+    return records.inventory;
+}
+
+void mergeIsIdempotentAndOrderIndependent() {
+    InventoryCounterEntry a{ SLOT, 1, 3.0f, 1.0f };
+    InventoryCounterEntry b{ SLOT, 2, 2.0f, 0.0f };
+    InventoryCounterEntry olderA{ SLOT, 1, 1.0f, 0.0f };
+
+    InventoryCounters forward;
+    CHECK(forward.merge(a));
+    CHECK(forward.merge(b));
+    CHECK(!forward.merge(olderA));
+    CHECK(!forward.merge(a));
+
+    InventoryCounters backward;
+    backward.merge(b);
+    backward.merge(olderA);
+    backward.merge(a);
+
+    CHECK(forward.valueExcept(SLOT, 0) == 4.0f);
+    CHECK(backward.valueExcept(SLOT, 0) == 4.0f);
+    CHECK(forward.valueExcept(SLOT, 1) == 2.0f);
+    CHECK(forward.entries().size() == 2 && backward.entries().size() == 2);
+}
+
+void ownChangesSplitIntoIncrementsAndDecrements() {
+    InventoryCounters counters;
+    counters.add(1, SLOT, 5.0f);
+    counters.add(1, SLOT, -2.0f);
+    counters.add(1, SLOT, 1.0f);
+    InventoryCounterEntry entry = counters.entry(SLOT, 1);
+    CHECK(entry.increments == 6.0f && entry.decrements == 2.0f);
+    // Its own changes are never part of what it applies
+    CHECK(counters.valueExcept(SLOT, 1) == 0.0f);
+}
+
+void replicaIDsDiffer() {
+    CHECK(InventoryCounters::newReplicaID() != InventoryCounters::newReplicaID());
+}
+
+void convergesAfterReconnectAndIDReuse() {
+    RoomKeyframe keyframe;
+    Replica first;
+    Replica second;
+
+    // The first player picks up 3 as client 1, then leaves
+    tick(keyframe, 1, first.change(3.0f));
+    keyframe.removeClient(1);
+
+    // Client ID 1 goes to a newcomer, which picks up 1; its counters must not replace the first's
+    second.receive(keyframeInventory(keyframe));
+    CHECK(second.remote() == 3.0f);
+    tick(keyframe, 1, second.change(1.0f));
+
+    // The first player comes back under another ID with the same replica and uses 2
+    first.receive(keyframeInventory(keyframe));
+    CHECK(first.remote() == 1.0f);
+    tick(keyframe, 2, first.change(-2.0f));
+
+    // Everyone, and a late joiner going by the keyframe alone, ends on 3 + 1 - 2
+    second.receive(keyframeInventory(keyframe));
+    Replica late;
+    late.receive(keyframeInventory(keyframe));
+    CHECK(first.total() == 2.0f);
+    CHECK(second.total() == 2.0f);
+    CHECK(late.total() == 2.0f);
+    CHECK(late.remote() == 2.0f);
+    CHECK(keyframeInventory(keyframe).size() == 2);
+}
+
+void longInventoryKeepsSizeByte() {
+    std::vector<InventoryCounterEntry> entries;
+    for (uint8_t slot = 0; slot < 30; ++slot)
+        entries.push_back({ slot, 1, 1.0f, 0.0f });
+    std::vector<uint8_t> body;
+    writeInventoryRecord(body, entries);
+
+    // Skipped by the size bytes alone, as a client does with a label it turned off,
+    // every record ends where the next begins
+    size_t offset = 0;
+    int records = 0;
+    while (offset + 2 + sizeof(uint32_t) <= body.size()) {
+        uint8_t size = body[offset + 1];
+        size_t countOffset = offset + 2;
+        uint32_t count = 0;
+        readRaw(body, countOffset, count);
+        CHECK(body[offset] == static_cast<uint8_t>(DataLabel::INVENTORY));
+        CHECK(size == sizeof(uint32_t) + count * (sizeof(uint8_t) + sizeof(uint64_t) + 2 * sizeof(float)));
+        offset += 2 + size;
+        ++records;
+    }
+    CHECK(offset == body.size());
+    CHECK(records == 3);
+
+    GameRecords parsed;
+    CHECK(parseGameRecords(body, parsed));
+    CHECK(parsed.inventory.size() == entries.size());
+}
+
+} // namespace
+
+int main() {
+    mergeIsIdempotentAndOrderIndependent();
+    ownChangesSplitIntoIncrementsAndDecrements();
+    replicaIDsDiffer();
+    convergesAfterReconnectAndIDReuse();
+    longInventoryKeepsSizeByte();
+    return test::result();
+}
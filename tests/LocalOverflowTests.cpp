@@ -0,0 +1,155 @@
+// Server: a local client whose queue overflows misses frames until it has
+// drained, then gets the client list and a keyframe. Enemy damage it missed
+// must come back exactly once, whatever it had already applied live.
+
+#include <map>
+#include <vector>
+
+#include "LocalServer.h"
+#include "TestCheck.h"
+
+namespace {
+
+using test::send;
+using test::receive;
+using test::join;
+using test::settle;
+
+const uint8_t LEVEL = 3;
+const uint64_t ENEMY = 100;
+
+BaseMessage snapshot() {
+    BaseMessage msg(SNAPSHOT_MESSAGE, 0);
+    msg.message.push(static_cast<uint8_t>(DataLabel::CONNECTED_PLAYER_SNAP));
+    msg.message.push(static_cast<uint8_t>(PLAYER_SNAP_SIZE));
+    msg.message.push(LEVEL);
+    for (size_t i = 1; i < PLAYER_SNAP_SIZE; ++i)
+        msg.message.push(0);
+    return msg;
+}
+BaseMessage damage(float healthChange) {
+    std::vector<uint8_t> body;
+    writeEnemiesHealthRecord(body, { { ENEMY, healthChange } });
+    BaseMessage msg(EVENT_MESSAGE, 0);
+    for (uint8_t byte : body)
+        msg.message.push(byte);
+    return msg;
+}
+
+// What a game client on LEVEL has done to its enemies so far
+struct Receiver {
+    LocalChannel& channel;
+    std::map<uint64_t, float> applied;
+    int keyframes = 0;
+
+    // Reads everything queued, applying events as deltas and keyframes as totals
+    void drain() {
+        while (channel.toClient.size() > 0) {
+            auto msg = receive(channel);
+            if (msg && msg->messageType == EVENT_MESSAGE)
+                applyEvent(*msg);
+            else if (msg && msg->messageType == KEYFRAME_MESSAGE)
+                applyKeyframe(*msg);
+        }
+    }
+    void applyEvent(const BaseMessage& msg) {
+        GameRecords records;
+        CHECK(parseGameRecords(msg.message, records));
+        for (const auto& enemy : records.enemies)
+            applied[enemy.guid] += enemy.healthChange;
+    }
+    void applyKeyframe(BaseMessage& msg) {
+        ++keyframes;
+        std::queue<uint8_t>& data = msg.message;
+        uint8_t snapshotCount = data.front();
+        data.pop();
+        for (int i = 0; i < snapshotCount; ++i) {
+            data.pop();
+            takeBlock(data);
+        }
+        uint8_t levelCount = data.front();
+        data.pop();
+        for (int i = 0; i < levelCount; ++i) {
+            uint8_t level = data.front();
+            data.pop();
+            std::vector<uint8_t> block = takeBlock(data);
+            GameRecords records;
+            CHECK(parseGameRecords(block, records));
+            for (const auto& enemy : records.enemies) {
+                if (level == LEVEL)
+                    applied[enemy.guid] += enemy.healthChange - applied[enemy.guid];
+            }
+        }
+    }
+    static std::vector<uint8_t> takeBlock(std::queue<uint8_t>& data) {
+        uint32_t size = 0;
+        CHECK(popUint32(data, size) && data.size() >= size);
+        std::vector<uint8_t> block;
+        for (uint32_t i = 0; i < size && !data.empty(); ++i) {
+            block.push_back(data.front());
+            data.pop();
+        }
+        return block;
+    }
+};
+
+// Fills the receiver's queue past its capacity, so frames to it are dropped
+void overflow(LocalChannel& sender, const LocalChannel& receiver) {
+    for (size_t i = 0; i < receiver.toClient.capacity() + 16; ++i)
+        send(sender, snapshot());
+    settle();
+}
+
+void missedDamageIsAppliedOnce() {
+    Server server(test::localServerConfig());
+    CHECK(server.start());
+
+    auto slow = server.attachLocalClient();
+    join(*slow);
+    auto hitter = server.attachLocalClient();
+    join(*hitter);
+    Receiver receiver{ *slow };
+
+    // Applied live; the receiver's own damage is already in its game and never comes back
+    send(*slow, snapshot());
+    send(*slow, damage(-1.0f));
+    send(*hitter, snapshot());
+    send(*hitter, damage(-5.0f));
+    settle();
+    receiver.drain();
+    CHECK(receiver.applied[ENEMY] == -5.0f);
+
+    // Dropped while the queue is full
+    overflow(*hitter, *slow);
+    for (int i = 0; i < 3; ++i)
+        send(*hitter, damage(-2.0f));
+    settle();
+    receiver.drain();
+    CHECK(receiver.applied[ENEMY] == -5.0f);
+
+    // The next frame after draining brings the keyframe with the missed part only
+    send(*hitter, snapshot());
+    settle();
+    receiver.drain();
+    CHECK(receiver.keyframes == 1);
+    CHECK(receiver.applied[ENEMY] == -11.0f);
+
+    // Another resync with nothing missed changes nothing
+    overflow(*hitter, *slow);
+    receiver.drain();
+    send(*hitter, snapshot());
+    settle();
+    receiver.drain();
+    CHECK(receiver.keyframes == 2);
+    CHECK(receiver.applied[ENEMY] == -11.0f);
+
+    server.stop();
+}
+
+} // namespace
+
+int main() {
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    missedDamageIsAppliedOnce();
+    return test::result();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../ServerClient/Server.h"
+
+// Talking to a Server through raw frames on a LocalChannel, for the tests
+// that check what the server sends rather than what a Client makes of it.
+namespace test {
+
+inline void send(LocalChannel& channel, const BaseMessage& msg) {
+    std::vector<uint8_t> buffer;
+    BaseMessage::serializeMessage(msg, buffer);
+    channel.toServer.pushWait(buffer);
+}
+// Null once the server closed the channel and it is drained
+inline std::unique_ptr<BaseMessage> receive(LocalChannel& channel) {
+    std::vector<uint8_t> buffer;
+    if (!channel.toClient.pop(buffer))
+        return nullptr;
+    return std::unique_ptr<BaseMessage>(BaseMessage::deserializeMessage(buffer));
+}
+// Reads up to the next message of this type, null if the channel closed first
+inline std::unique_ptr<BaseMessage> receiveType(LocalChannel& channel, uint8_t messageType) {
+    while (auto msg = receive(channel)) {
+        if (msg->messageType == messageType)
+            return msg;
+    }
+    return nullptr;
+}
+
+// Sends the hello, optionally resuming a session, and returns the CLIENT_ID_MESSAGE
+inline std::unique_ptr<BaseMessage> hello(LocalChannel& channel, uint8_t clientID = 0, uint64_t resumeToken = 0, uint16_t meshPort = 0) {
+    BaseMessage msg(CLIENT_HELLO_MESSAGE, clientID);
+    pushUint16(msg.message, meshPort);
+    if (resumeToken != 0)
+        pushUint64(msg.message, resumeToken);
+    send(channel, msg);
+    return receiveType(channel, CLIENT_ID_MESSAGE);
+}
+inline uint8_t join(LocalChannel& channel) {
+    auto id = hello(channel);
+    return id ? id->senderID : 0;
+}
+
+// Lets the server relay what was sent and run a few ticks
+inline void settle() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
+
+// A server on an ephemeral port with fast ticks, for in-process clients
+inline ServerConfig localServerConfig() {
+    ServerConfig config;
+    config.port = 0;
+    config.tickInterval = std::chrono::milliseconds(1);
+    return config;
+}
+
+} // namespace test
@@ -0,0 +1,72 @@
+// MemoryScanner: matches found by the thread pool against an address space
+// faked in memory, whichever instruction set and however many workers.
+
+#include <cstring>
+#include <vector>
+
+#include "../HobbitGameManager/MemoryScanner.h"
+#include "../HobbitGameManager/FakeRemoteMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint64_t BASE = 0x10000000;
+const uint64_t CHUNK = MemoryScanner::CHUNK_SIZE;
+const std::vector<uint8_t> PATTERN = { 0xDE, 0xAD, 0xBE, 0xEF, 0x01, 0x02, 0x03, 0x04 };
+
+void place(FakeRemoteMemory& memory, uint64_t address) {
+    std::memcpy(memory.data(address), PATTERN.data(), PATTERN.size());
+}
+
+void matchesAcrossChunksAndRegions() {
+    FakeRemoteMemory memory;
+    memory.map(BASE, 3 * CHUNK);
+    memory.map(BASE + 8 * CHUNK, 0x100);
+    std::vector<uint64_t> expected = {
+        BASE,
+        BASE + CHUNK - 3,                           // straddles the first two chunks
+        BASE + 3 * CHUNK - PATTERN.size(),          // ends the region
+        BASE + 8 * CHUNK + 0x10,
+    };
+    for (uint64_t address : expected)
+        place(memory, address);
+    // Half a match at the end of a region doesn't continue into the next one
+    std::memcpy(memory.data(BASE + 8 * CHUNK + 0x100 - 4), PATTERN.data(), 4);
+
+    for (ScanInstructionSet set : { ScanInstructionSet::Scalar, ScanInstructionSet::SSE2, ScanInstructionSet::AVX2 }) {
+        MemoryScanner scanner(4);
+        scanner.setInstructionSet(set);
+        CHECK(scanner.search(memory, PATTERN) == expected);
+    }
+}
+
+void laterSearchAddsWorkers() {
+    FakeRemoteMemory small;
+    small.map(BASE, 2 * CHUNK);
+    place(small, BASE + CHUNK + 0x40);
+
+    FakeRemoteMemory large;
+    large.map(BASE, 8 * CHUNK);
+    std::vector<uint64_t> expected;
+    for (uint64_t i = 0; i < 8; ++i) {
+        expected.push_back(BASE + i * CHUNK + 0x40);
+        place(large, expected.back());
+    }
+
+    // The second search starts workers the first didn't need; they must wait
+    // for it like the rest and hand in their matches
+    for (int round = 0; round < 20; ++round) {
+        MemoryScanner scanner(8);
+        CHECK(scanner.search(small, PATTERN) == std::vector<uint64_t>{ BASE + CHUNK + 0x40 });
+        CHECK(scanner.search(large, PATTERN) == expected);
+        CHECK(scanner.search(large, PATTERN) == expected);
+    }
+}
+
+} // namespace
+
+int main() {
+    matchesAcrossChunksAndRegions();
+    laterSearchAddsWorkers();
+    return test::result();
+}
@@ -0,0 +1,164 @@
+// Client snapshot mesh: snapshots go straight to a peer only while that peer
+// acks them, and through the server otherwise. The peer here is raw frames on
+// an in-process connection plus a UDP socket, so either direction can be cut.
+
+#include "../ServerClient/Client.h"
+#include "LocalServer.h"
+#include "TestCheck.h"
+
+namespace {
+
+BaseMessage snapshot(uint8_t senderID) {
+    BaseMessage msg(SNAPSHOT_MESSAGE, senderID);
+    msg.message.push(static_cast<uint8_t>(DataLabel::CONNECTED_PLAYER_SNAP));
+    msg.message.push(static_cast<uint8_t>(PLAYER_SNAP_SIZE));
+    for (size_t i = 0; i < PLAYER_SNAP_SIZE; ++i)
+        msg.message.push(0);
+    return msg;
+}
+
+struct RawPeer {
+    std::shared_ptr<LocalChannel> channel;
+    SOCKET socket = INVALID_SOCKET;
+    uint16_t udpPort = 0;
+    uint8_t clientID = 0;
+
+    explicit RawPeer(Server& server) : channel(server.attachLocalClient()) {
+        socket = ::socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in hint{};
+        hint.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &hint.sin_addr);
+        socklen_t hintSize = sizeof(hint);
+        CHECK(bind(socket, (sockaddr*)&hint, sizeof(hint)) == 0);
+        CHECK(getsockname(socket, (sockaddr*)&hint, &hintSize) == 0);
+        udpPort = ntohs(hint.sin_port);
+        timeval timeout{ 0, 200000 };
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+
+        auto id = test::hello(*channel, 0, 0, udpPort);
+        CHECK(id != nullptr);
+        clientID = id ? id->senderID : 0;
+    }
+    ~RawPeer() { closesocket(socket); }
+
+    void sendTo(uint16_t port, const BaseMessage& msg) {
+        std::vector<uint8_t> buffer;
+        BaseMessage::serializeMessage(msg, buffer);
+        sockaddr_in to{};
+        to.sin_family = AF_INET;
+        to.sin_port = htons(port);
+        inet_pton(AF_INET, "127.0.0.1", &to.sin_addr);
+        sendto(socket, (const char*)buffer.data(), buffer.size(), 0, (sockaddr*)&to, sizeof(to));
+    }
+    // Reads up to the next datagram of this type, acked back if asked; false on timeout
+    bool receiveDirect(uint8_t messageType, bool ack) {
+        std::vector<uint8_t> buffer(MESH_MAX_DATAGRAM);
+        sockaddr_in from{};
+        socklen_t fromSize = sizeof(from);
+        int bytesReceived;
+        while ((bytesReceived = recvfrom(socket, (char*)buffer.data(), buffer.size(), 0, (sockaddr*)&from, &fromSize)) > 0) {
+            std::unique_ptr<BaseMessage> msg(BaseMessage::deserializeMessage(std::vector<uint8_t>(buffer.begin(), buffer.begin() + bytesReceived)));
+            if (!msg || msg->messageType != messageType)
+                continue;
+            if (ack)
+                sendTo(ntohs(from.sin_port), BaseMessage(MESH_ACK_MESSAGE, clientID));
+            return true;
+        }
+        return false;
+    }
+    // Snapshots relayed by the server since the last call
+    int relayedSnapshots() {
+        int count = 0;
+        while (channel->toClient.size() > 0) {
+            auto msg = test::receive(*channel);
+            count += msg && msg->messageType == SNAPSHOT_MESSAGE;
+        }
+        return count;
+    }
+};
+
+// The client's mesh port, from the join the peer was told about
+uint16_t joinedMeshPort(RawPeer& peer) {
+    auto join = test::receiveType(*peer.channel, CLIENT_JOIN_MESSAGE);
+    CHECK(join != nullptr);
+    if (!join)
+        return 0;
+    uint32_t version;
+    uint16_t tcpPort, udpPort = 0;
+    popUint32(join->message, version);
+    join->message.pop();
+    uint8_t ipLength = join->message.front();
+    join->message.pop();
+    for (int i = 0; i < ipLength; ++i)
+        join->message.pop();
+    popUint16(join->message, tcpPort);
+    popUint16(join->message, udpPort);
+    return udpPort;
+}
+
+void unackedPeerGetsRelay() {
+    Server server(test::localServerConfig());
+    CHECK(server.start());
+
+    RawPeer peer(server);
+    Client client;
+    client.enableMesh(true);
+    CHECK(client.connectLocal(server.attachLocalClient()));
+    uint16_t clientPort = joinedMeshPort(peer);
+    CHECK(clientPort != 0);
+    test::settle();
+    peer.relayedSnapshots();
+
+    // The client hears the peer directly, but its own snapshots never get acked:
+    // as far as it can tell they are lost, so every one also goes through the server
+    peer.sendTo(clientPort, snapshot(peer.clientID));
+    test::settle();
+    for (int i = 0; i < 3; ++i) {
+        client.sendMessage(snapshot(client.getClientID()));
+        CHECK(peer.receiveDirect(SNAPSHOT_MESSAGE, false));
+    }
+    test::settle();
+    CHECK(peer.relayedSnapshots() == 3);
+
+    // Once acked, the server only gets the occasional one for its keyframe
+    client.sendMessage(snapshot(client.getClientID()));
+    CHECK(peer.receiveDirect(SNAPSHOT_MESSAGE, true));
+    test::settle();
+    peer.relayedSnapshots();
+    for (int i = 0; i < 3; ++i) {
+        client.sendMessage(snapshot(client.getClientID()));
+        CHECK(peer.receiveDirect(SNAPSHOT_MESSAGE, true));
+    }
+    test::settle();
+    CHECK(peer.relayedSnapshots() == 0);
+
+    client.disconnect();
+    server.stop();
+}
+
+void peerAcksSnapshots() {
+    Server server(test::localServerConfig());
+    CHECK(server.start());
+
+    RawPeer peer(server);
+    Client client;
+    client.enableMesh(true);
+    CHECK(client.connectLocal(server.attachLocalClient()));
+    uint16_t clientPort = joinedMeshPort(peer);
+    test::settle();
+
+    peer.sendTo(clientPort, snapshot(peer.clientID));
+    CHECK(peer.receiveDirect(MESH_ACK_MESSAGE, false));
+
+    client.disconnect();
+    server.stop();
+}
+
+} // namespace
+
+int main() {
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    unackedPeerGetsRelay();
+    peerAcksSnapshots();
+    return test::result();
+}
@@ -0,0 +1,141 @@
+// PointerPaths and PointerCache: pointer chains resolved as a trie, one batch
+// per depth, and kept while the guard holds. Runs the analyzer against an
+// address space faked in memory.
+
+#include <memory>
+#include <vector>
+
+#include "../HobbitGameManager/HobbitProcessAnalyzer.h"
+#include "../HobbitGameManager/PointerPaths.h"
+#include "CountingMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint32_t HEAP = 0x01000000;
+const uint32_t ROOT = HEAP;
+const uint32_t FIRST = HEAP + 0x1000;
+const uint32_t SECOND = HEAP + 0x2000;
+const uint32_t THIRD = HEAP + 0x3000;
+const uint32_t GUARD = 0x40;
+
+struct Fixture {
+    std::shared_ptr<test::CountingMemory> memory = std::make_shared<test::CountingMemory>();
+    HobbitProcessAnalyzer analyzer;
+
+    Fixture() {
+        memory->map(HEAP, 0x10000);
+        // root +0x0 -> FIRST, FIRST +0x560 -> SECOND, root +0x10 -> THIRD
+        set(ROOT + 0x0, FIRST);
+        set(FIRST + 0x560, SECOND);
+        set(ROOT + 0x10, THIRD);
+        set(ROOT + GUARD, 0x1234);
+        analyzer.setRemoteMemory(memory);
+    }
+    void set(uint32_t address, uint32_t value) {
+        memory->set(address, value);
+    }
+};
+
+PointerPaths declaredPaths() {
+    PointerPaths paths;
+    paths.add({ 0x0 });
+    paths.add({ 0x0, 0x560 }, 0x8);
+    paths.add({ 0x10 }, 0x4);
+    paths.add({}, 0x20);
+    return paths;
+}
+
+void resolvesEveryPath() {
+    Fixture f;
+    PointerPaths paths = declaredPaths();
+    std::vector<uint32_t> results;
+
+    CHECK(paths.resolve(f.analyzer, ROOT, results));
+    CHECK(results == std::vector<uint32_t>({ FIRST, SECOND + 0x8, THIRD + 0x4, ROOT + 0x20 }));
+
+    // One batch per depth; the hop two paths share is read once
+    CHECK(f.memory->batches == 2);
+    CHECK(f.memory->requests == 3);
+}
+
+void brokenChainIsReported() {
+    Fixture f;
+    f.set(ROOT + 0x0, 0);
+    PointerPaths paths = declaredPaths();
+    std::vector<uint32_t> results;
+
+    CHECK(!paths.resolve(f.analyzer, ROOT, results));
+    // Paths through the null pointer come out as 0, the others still resolve
+    CHECK(results[0] == 0);
+    CHECK(results[1] == 0);
+    CHECK(results[2] == THIRD + 0x4);
+    CHECK(results[3] == ROOT + 0x20);
+}
+
+void cacheWalksOnlyWhenNeeded() {
+    Fixture f;
+    PointerPaths paths = declaredPaths();
+    PointerCache cache(paths, GUARD, sizeof(uint32_t));
+
+    CHECK(cache.get(f.analyzer, ROOT)[1] == SECOND + 0x8);
+    uint64_t batches = f.memory->batches;
+    CHECK(cache.get(f.analyzer, ROOT)[1] == SECOND + 0x8);
+    CHECK(cache.getResolves() == 1);
+    // The guard and every hop are checked in one batch
+    CHECK(f.memory->batches == batches + 1);
+
+    // An object on the way replaced while the guard stays, e.g. the animation
+    // object on a level load: the hop shows it
+    f.set(FIRST + 0x560, THIRD);
+    CHECK(cache.get(f.analyzer, ROOT)[1] == THIRD + 0x8);
+    CHECK(cache.getResolves() == 2);
+
+    // A new object in the same place: the guard changed
+    f.set(ROOT + GUARD, 0x5678);
+    cache.get(f.analyzer, ROOT);
+    CHECK(cache.getResolves() == 3);
+
+    // Explicitly
+    cache.invalidate();
+    cache.get(f.analyzer, ROOT);
+    CHECK(cache.getResolves() == 4);
+
+    // The game opened again
+    f.analyzer.setRemoteMemory(f.memory);
+    cache.get(f.analyzer, ROOT);
+    CHECK(cache.getResolves() == 5);
+
+    // Another root
+    f.set(FIRST + GUARD, 0x1);
+    cache.get(f.analyzer, FIRST);
+    CHECK(cache.getResolves() == 6);
+}
+
+void brokenChainIsNotKept() {
+    Fixture f;
+    f.set(FIRST + 0x560, 0);
+    PointerPaths paths = declaredPaths();
+    PointerCache cache(paths, GUARD, sizeof(uint32_t));
+
+    cache.get(f.analyzer, ROOT);
+    cache.get(f.analyzer, ROOT);
+    CHECK(cache.getResolves() == 2);
+
+    // Once the chain is complete it is kept
+    f.set(FIRST + 0x560, SECOND);
+    CHECK(cache.get(f.analyzer, ROOT)[1] == SECOND + 0x8);
+    cache.get(f.analyzer, ROOT);
+    CHECK(cache.getResolves() == 3);
+}
+
+} // namespace
+
+int main() {
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    resolvesEveryPath();
+    brokenChainIsReported();
+    cacheWalksOnlyWhenNeeded();
+    brokenChainIsNotKept();
+    return test::result();
+}
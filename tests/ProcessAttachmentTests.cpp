@@ -0,0 +1,143 @@
+// ProcessAttachment: when the process list is walked, and what the attach and
+// detach listeners hear, in which order, including from within a listener.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../HobbitGameManager/ProcessAttachment.h"
+#include "../HobbitGameManager/FakeRemoteMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+using Clock = ProcessAttachment::Clock;
+using std::chrono::milliseconds;
+
+const milliseconds RETRY(1000);
+
+// Hands out the game once it is running, a new FakeRemoteMemory per launch
+struct FakeGame {
+    bool running = false;
+    std::shared_ptr<FakeRemoteMemory> process;
+    int launches = 0;
+
+    std::shared_ptr<RemoteMemory> open() {
+        if (!running)
+            return nullptr;
+        if (!process) {
+            process = std::make_shared<FakeRemoteMemory>();
+            ++launches;
+        }
+        return process;
+    }
+    void exit() {
+        running = false;
+        if (process)
+            process->setAlive(false);
+        process = nullptr;
+    }
+};
+
+void searchesOncePerRetryInterval() {
+    FakeGame game;
+    ProcessAttachment attachment([&game] { return game.open(); }, RETRY);
+    Clock::time_point start = Clock::now();
+
+    CHECK(!attachment.update(start));
+    CHECK(!attachment.update(start + milliseconds(999)));
+    CHECK(attachment.getSearches() == 1);
+
+    game.running = true;
+    CHECK(!attachment.update(start + milliseconds(999)));
+    CHECK(attachment.update(start + RETRY));
+    CHECK(attachment.getSearches() == 2);
+
+    // While attached only the handle is asked
+    for (int i = 0; i < 10; ++i)
+        CHECK(attachment.update(start + RETRY * (2 + i)));
+    CHECK(attachment.getSearches() == 2);
+    CHECK(attachment.getProcess() == game.process);
+
+    // After the exit the next update searches right away
+    game.exit();
+    Clock::time_point exited = start + RETRY * 20;
+    CHECK(!attachment.update(exited));
+    CHECK(!attachment.isAttached());
+    CHECK(attachment.getSearches() == 2);
+    game.running = true;
+    CHECK(attachment.update(exited));
+    CHECK(attachment.getSearches() == 3);
+    CHECK(game.launches == 2);
+}
+
+void listenersHearInOrder() {
+    FakeGame game;
+    ProcessAttachment attachment([&game] { return game.open(); }, RETRY);
+    std::vector<std::string> heard;
+    attachment.addListenerAttach([&] { heard.push_back("attach 1"); });
+    attachment.addListenerDetach([&] { heard.push_back("detach 1"); });
+    attachment.addListenerAttach([&] { heard.push_back("attach 2"); });
+    attachment.addListenerDetach([&] { heard.push_back("detach 2"); });
+
+    Clock::time_point now = Clock::now();
+    attachment.update(now);
+    CHECK(heard.empty());
+
+    game.running = true;
+    attachment.update(now += RETRY);
+    attachment.update(now += RETRY);
+    game.exit();
+    attachment.update(now += RETRY);
+    attachment.update(now += RETRY);
+    game.running = true;
+    attachment.update(now += RETRY);
+
+    CHECK(heard == (std::vector<std::string>{ "attach 1", "attach 2", "detach 1", "detach 2", "attach 1", "attach 2" }));
+}
+
+void listenersMayCallBack() {
+    FakeGame game;
+    ProcessAttachment attachment([&game] { return game.open(); }, RETRY);
+    std::vector<std::string> heard;
+    std::shared_ptr<RemoteMemory> seen;
+
+    // The game exits while the attach listener runs; the listener still
+    // sees the process it was told about, and the next update detaches
+    attachment.addListenerAttach([&] {
+        heard.push_back("attach");
+        seen = attachment.getProcess();
+        if (game.launches == 1)
+            game.exit();
+    });
+    // A listener reacting to the exit by looking for the game again gets
+    // the new launch, heard after its own detach
+    attachment.addListenerDetach([&] {
+        heard.push_back("detach");
+        CHECK(!attachment.isAttached());
+        game.running = true;
+        CHECK(attachment.update(Clock::now()));
+        heard.push_back("detach done");
+    });
+
+    Clock::time_point now = Clock::now();
+    game.running = true;
+    CHECK(attachment.update(now));
+    CHECK(seen != nullptr && attachment.isAttached());
+    CHECK(!seen->isAlive());
+
+    attachment.update(now);
+    CHECK(attachment.isAttached());
+    CHECK(attachment.getProcess() == game.process && game.launches == 2);
+    CHECK(seen == game.process);
+    CHECK(heard == (std::vector<std::string>{ "attach", "detach", "attach", "detach done" }));
+}
+
+} // namespace
+
+int main() {
+    searchesOncePerRetryInterval();
+    listenersHearInOrder();
+    listenersMayCallBack();
+    return test::result();
+}
@@ -0,0 +1,229 @@
+// RemoteMemory: the coalesced batch reads of the backends that pay per call,
+// against an address space faked in memory whose ranges stand for regions;
+// and on Linux the real backend, against this process and a forked child.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <filesystem>
+#include "../HobbitGameManager/LinuxRemoteMemory.h"
+#endif
+
+#include "CountingMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint64_t BASE = 0x10000;
+
+// Reads batches the way Win32RemoteMemory does; a read can't cross from one
+// mapped range into the next, like a fast-path read can't cross regions
+class CoalescingMemory : public test::CountingMemory {
+public:
+    size_t readBatch(ReadRequest* requests, size_t count) override {
+        return readCoalesced(requests, count);
+    }
+
+protected:
+    uint64_t regionEnd(uint64_t address) override {
+        for (const MemoryRegion& region : regions()) {
+            if (address >= region.base && address < region.base + region.size)
+                return region.base + region.size;
+        }
+        return address;
+    }
+};
+
+void nearbyReadsShareOneSpan() {
+    CoalescingMemory memory;
+    memory.map(BASE, 0x100);
+    for (int i = 0; i < 4; ++i)
+        memory.data(BASE + 0x10 * i)[0] = static_cast<uint8_t>(i + 1);
+
+    uint8_t values[4] = {};
+    std::vector<ReadRequest> requests(4);
+    for (int i = 0; i < 4; ++i)
+        requests[i] = { BASE + 0x10 * i, &values[i], 1 };
+    CHECK(memory.readBatch(requests.data(), requests.size()) == 4);
+    CHECK(memory.reads == 1);
+    CHECK(values[0] == 1 && values[3] == 4);
+}
+
+void spansStopAtRegionEnd() {
+    CoalescingMemory memory;
+    memory.map(BASE, 0x100);
+    memory.map(BASE + 0x100, 0x100);
+    memory.data(BASE + 0xFC)[0] = 1;
+    memory.data(BASE + 0x100)[0] = 2;
+    memory.data(BASE + 0x108)[0] = 3;
+
+    // One span per region, rather than one over both that fails and falls
+    // back to reading every request on its own
+    uint32_t values[3] = {};
+    std::vector<ReadRequest> requests = {
+        { BASE + 0xFC, &values[0], 4 },
+        { BASE + 0x100, &values[1], 4 },
+        { BASE + 0x108, &values[2], 4 },
+    };
+    CHECK(memory.readBatch(requests.data(), requests.size()) == 3);
+    CHECK(memory.reads == 2);
+    CHECK(values[0] == 1 && values[1] == 2 && values[2] == 3);
+}
+
+#ifdef __linux__
+const size_t PAGE = 0x1000;
+
+// Three pages of this process: writable, read-only, and unmapped, so that
+// reads run off the end of the second
+struct Pages {
+    uint8_t* base = nullptr;
+
+    Pages() {
+        void* mapped = mmap(nullptr, 3 * PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        CHECK(mapped != MAP_FAILED);
+        base = static_cast<uint8_t*>(mapped);
+        for (size_t i = 0; i < 2 * PAGE; ++i)
+            base[i] = static_cast<uint8_t>(i);
+        mprotect(base + PAGE, PAGE, PROT_READ);
+        munmap(base + 2 * PAGE, PAGE);
+    }
+    ~Pages() {
+        munmap(base, 2 * PAGE);
+    }
+    uint64_t address(size_t offset) const {
+        return reinterpret_cast<uintptr_t>(base + offset);
+    }
+};
+
+size_t openFiles() {
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/fd")) {
+        (void)entry;
+        ++count;
+    }
+    return count;
+}
+
+void linuxReadsAndWritesThisProcess() {
+    Pages pages;
+    LinuxRemoteMemory memory(getpid());
+    CHECK(memory.isAlive());
+
+    uint32_t value = 0;
+    CHECK(memory.read(pages.address(0x10), &value, sizeof(value)));
+    CHECK(value == 0x13121110);
+    CHECK(!memory.read(pages.address(2 * PAGE), &value, sizeof(value)));
+    CHECK(memory.lastError() != 0);
+
+    // A read-only page is written through /proc/<pid>/mem
+    value = 0xCAFEF00D;
+    CHECK(memory.write(pages.address(0x10), &value, sizeof(value)));
+    CHECK(memory.write(pages.address(PAGE + 0x10), &value, sizeof(value)));
+    CHECK(pages.base[0x10] == 0x0D && pages.base[PAGE + 0x13] == 0xCA);
+
+    // The batch goes on after a request it can't read
+    uint8_t values[3] = {};
+    ReadRequest requests[3] = {
+        { pages.address(0x20), &values[0], 1 },
+        { pages.address(2 * PAGE + 0x20), &values[1], 1 },
+        { pages.address(PAGE + 0x20), &values[2], 1 },
+    };
+    CHECK(memory.readBatch(requests, 3) == 2);
+    CHECK(requests[0].ok && !requests[1].ok && requests[2].ok);
+    CHECK(values[0] == 0x20 && values[2] == 0x20);
+
+    uint16_t written[2] = { 0xAAAA, 0xBBBB };
+    WriteRequest writes[2] = {
+        { pages.address(0x40), &written[0], 2 },
+        { pages.address(PAGE + 0x40), &written[1], 2 },
+    };
+    CHECK(memory.writeBatch(writes, 2) == 2);
+    CHECK(pages.base[0x40] == 0xAA && pages.base[PAGE + 0x40] == 0xBB);
+
+    bool listed = false;
+    for (const MemoryRegion& region : memory.regions()) {
+        if (region.base <= pages.address(PAGE) && pages.address(PAGE) < region.base + region.size)
+            listed = !region.writable;
+    }
+    CHECK(listed);
+}
+
+// The first protected writes of a new backend, all at once
+void linuxProtectedWritesFromManyThreads() {
+    Pages pages;
+    size_t filesBefore = openFiles();
+    for (int round = 0; round < 50; ++round) {
+        LinuxRemoteMemory memory(getpid());
+        std::atomic<bool> go{ false };
+        std::vector<std::thread> threads;
+        for (uint8_t i = 0; i < 8; ++i) {
+            threads.emplace_back([&memory, &pages, &go, i] {
+                while (!go)
+                    std::this_thread::yield();
+                uint8_t value = i;
+                CHECK(memory.write(pages.address(PAGE + i), &value, 1));
+            });
+        }
+        go = true;
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    // Every descriptor the backends opened was closed with them
+    CHECK(openFiles() == filesBefore);
+    for (uint8_t i = 0; i < 8; ++i)
+        CHECK(pages.base[PAGE + i] == i);
+}
+
+void linuxForkedChild() {
+    uint32_t* shared = static_cast<uint32_t*>(mmap(nullptr, PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    CHECK(shared != MAP_FAILED);
+    shared[0] = 1;
+    int release[2];
+    CHECK(pipe(release) == 0);
+
+    // The child gets a copy of the page at the same address and waits
+    pid_t child = fork();
+    if (child == 0) {
+        close(release[1]);
+        char byte;
+        while (::read(release[0], &byte, 1) < 0) {}
+        _exit(shared[0] == 42 ? 0 : 1);
+    }
+    close(release[0]);
+    uint64_t address = reinterpret_cast<uintptr_t>(shared);
+    {
+        LinuxRemoteMemory memory(child);
+        CHECK(memory.isAlive());
+        shared[0] = 2;      // our copy only
+        uint32_t value = 0;
+        CHECK(memory.read(address, &value, sizeof(value)) && value == 1);
+        value = 42;
+        CHECK(memory.write(address, &value, sizeof(value)));
+
+        close(release[1]);
+        int status = 0;
+        CHECK(waitpid(child, &status, 0) == child);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        CHECK(!memory.isAlive());
+        CHECK(!memory.read(address, &value, sizeof(value)));
+    }
+    munmap(shared, PAGE);
+}
+#endif
+
+} // namespace
+
+int main() {
+    nearbyReadsShareOneSpan();
+    spansStopAtRegionEnd();
+#ifdef __linux__
+    linuxReadsAndWritesThisProcess();
+    linuxProtectedWritesFromManyThreads();
+    linuxForkedChild();
+#endif
+    return test::result();
+}
@@ -0,0 +1,134 @@
+// RoomKeyframe: the room state a late joiner, or a client that lost frames,
+// gets in one message. Enemy totals must line up with the live deltas, so a
+// client that already applied some of them can apply the rest exactly once.
+
+#include <map>
+#include <vector>
+
+#include "../ServerClient/RoomKeyframe.h"
+#include "TestCheck.h"
+
+namespace {
+
+using LevelEnemies = std::map<uint8_t, std::map<uint64_t, float>>;
+
+BaseMessage snapshot(uint8_t senderID, uint8_t level) {
+    BaseMessage msg(SNAPSHOT_MESSAGE, senderID);
+    msg.message.push(static_cast<uint8_t>(DataLabel::CONNECTED_PLAYER_SNAP));
+    msg.message.push(static_cast<uint8_t>(PLAYER_SNAP_SIZE));
+    msg.message.push(level);
+    for (size_t i = 1; i < PLAYER_SNAP_SIZE; ++i)
+        msg.message.push(0);
+    return msg;
+}
+GameRecords enemyRecords(const std::vector<EnemyHealthChange>& enemies) {
+    GameRecords records;
+    records.enemies = enemies;
+    return records;
+}
+
+bool takeBlock(std::queue<uint8_t>& data, std::vector<uint8_t>& block) {
+    uint32_t size;
+    if (!popUint32(data, size) || data.size() < size)
+        return false;
+    for (uint32_t i = 0; i < size; ++i) {
+        block.push_back(data.front());
+        data.pop();
+    }
+    return true;
+}
+
+// Enemy totals per level, the way HobbitClient::applyKeyframe reads them
+LevelEnemies keyframeEnemies(const RoomKeyframe& keyframe, uint8_t receiverID) {
+    BaseMessage msg = keyframe.buildMessage(receiverID);
+    CHECK(msg.messageType == KEYFRAME_MESSAGE);
+    std::queue<uint8_t>& data = msg.message;
+
+    uint8_t snapshotCount = data.front();
+    data.pop();
+    for (int i = 0; i < snapshotCount; ++i) {
+        data.pop();
+        std::vector<uint8_t> body;
+        CHECK(takeBlock(data, body));
+    }
+
+    LevelEnemies levels;
+    uint8_t levelCount = data.front();
+    data.pop();
+    for (int i = 0; i < levelCount; ++i) {
+        uint8_t level = data.front();
+        data.pop();
+        std::vector<uint8_t> body;
+        CHECK(takeBlock(data, body));
+        GameRecords records;
+        CHECK(parseGameRecords(body, records));
+        for (const auto& enemy : records.enemies)
+            levels[level][enemy.guid] += enemy.healthChange;
+    }
+    return levels;
+}
+
+void keyframeLeavesOutReceiversOwnDamage() {
+    RoomKeyframe keyframe;
+    keyframe.applySnapshot(snapshot(1, 3));
+    keyframe.applySnapshot(snapshot(2, 3));
+
+    EventMerger tick;
+    tick.add(1, enemyRecords({ { 100, -5.0f } }));
+    tick.add(2, enemyRecords({ { 100, -3.0f }, { 200, -1.0f } }));
+    keyframe.applyEvents(tick);
+
+    CHECK(keyframeEnemies(keyframe, 1) == (LevelEnemies{ { 3, { { 100, -3.0f }, { 200, -1.0f } } } }));
+    CHECK(keyframeEnemies(keyframe, 2) == (LevelEnemies{ { 3, { { 100, -5.0f } } } }));
+    CHECK(keyframeEnemies(keyframe, 3) == (LevelEnemies{ { 3, { { 100, -8.0f }, { 200, -1.0f } } } }));
+}
+
+void resyncAppliesOnlyMissedDamage() {
+    RoomKeyframe keyframe;
+    keyframe.applySnapshot(snapshot(1, 3));
+    keyframe.applySnapshot(snapshot(2, 3));
+
+    // Client 1 applies the first tick live and misses the second
+    std::map<uint64_t, float> applied;
+    EventMerger first;
+    first.add(1, enemyRecords({ { 100, -5.0f } }));
+    first.add(2, enemyRecords({ { 100, -3.0f } }));
+    for (const BaseMessage& msg : first.buildFor(1)) {
+        GameRecords records;
+        CHECK(parseGameRecords(msg.message, records));
+        for (const auto& enemy : records.enemies)
+            applied[enemy.guid] += enemy.healthChange;
+    }
+    keyframe.applyEvents(first);
+
+    EventMerger second;
+    second.add(2, enemyRecords({ { 100, -4.0f } }));
+    keyframe.applyEvents(second);
+
+    // The keyframe makes up for the missed tick only, and a second one adds nothing
+    std::map<uint64_t, float> totals = keyframeEnemies(keyframe, 1)[3];
+    CHECK(totals[100] - applied[100] == -4.0f);
+    applied[100] = totals[100];
+    CHECK(keyframeEnemies(keyframe, 1)[3][100] - applied[100] == 0.0f);
+}
+
+void departedClientsDamageStays() {
+    RoomKeyframe keyframe;
+    keyframe.applySnapshot(snapshot(2, 3));
+    EventMerger tick;
+    tick.add(2, enemyRecords({ { 100, -3.0f } }));
+    keyframe.applyEvents(tick);
+
+    // The next client with ID 2 finds the enemy already hurt
+    keyframe.removeClient(2);
+    CHECK(keyframeEnemies(keyframe, 2) == (LevelEnemies{ { 3, { { 100, -3.0f } } } }));
+}
+
+} // namespace
+
+int main() {
+    keyframeLeavesOutReceiversOwnDamage();
+    resyncAppliesOnlyMissedDamage();
+    departedClientsDamageStays();
+    return test::result();
+}
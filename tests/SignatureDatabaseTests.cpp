@@ -0,0 +1,217 @@
+// SignatureDatabase: patterns parsed from text, all of them found in one pass
+// by the scanner, and addresses resolved from a PE image faked in memory,
+// kept in the address cache until the exe or the signatures change.
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../HobbitGameManager/SignatureDatabase.h"
+#include "../HobbitGameManager/FakeRemoteMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+const uint32_t MODULE_BASE = 0x00400000;
+const uint32_t IMAGE_SIZE = 0x4000;
+const uint32_t PE_OFFSET = 0x80;
+const uint32_t PLAYER_CODE = MODULE_BASE + 0x1000;
+const uint32_t WEAPON_CODE = MODULE_BASE + 0x1100;
+const uint32_t PLAYER_PTR = MODULE_BASE + 0x3000;
+const uint32_t WEAPON = MODULE_BASE + 0x3010;
+
+const char* SIGNATURES =
+    "# name  operand offset  pattern\n"
+    "PlayerPtr  2  8B 0D ?? ?? ?? ?? 85 C9\n"
+    "Weapon  1  A1 ?? ?? ?? ?? 5E C3   # mov eax, [Weapon]\n";
+
+std::vector<uint8_t> bytes(const std::string& pattern) {
+    Signature signature;
+    CHECK(Signature::parse(pattern, signature));
+    return signature.bytes;
+}
+Signature named(const std::string& name, const std::string& pattern) {
+    Signature signature;
+    signature.name = name;
+    CHECK(Signature::parse(pattern, signature));
+    return signature;
+}
+
+void put(FakeRemoteMemory& memory, uint64_t address, const std::vector<uint8_t>& data) {
+    std::memcpy(memory.data(address), data.data(), data.size());
+}
+void put32(FakeRemoteMemory& memory, uint64_t address, uint32_t value) {
+    std::memcpy(memory.data(address), &value, sizeof(value));
+}
+
+// The headers resolve() checks, and code referring to PLAYER_PTR and WEAPON
+void buildImage(FakeRemoteMemory& memory) {
+    memory.map(MODULE_BASE, IMAGE_SIZE);
+    put(memory, MODULE_BASE, { 'M', 'Z' });
+    put32(memory, MODULE_BASE + 0x3C, PE_OFFSET);
+    put(memory, MODULE_BASE + PE_OFFSET, { 'P', 'E', 0, 0 });
+    put32(memory, MODULE_BASE + PE_OFFSET + 0x50, IMAGE_SIZE);
+
+    put(memory, PLAYER_CODE, bytes("8B 0D 00 00 00 00 85 C9"));
+    put32(memory, PLAYER_CODE + 2, PLAYER_PTR);
+    put(memory, WEAPON_CODE, bytes("A1 00 00 00 00 5E C3"));
+    put32(memory, WEAPON_CODE + 1, WEAPON);
+}
+
+// A directory of its own for the signature file and the cache
+struct TempDirectory {
+    fs::path path;
+
+    TempDirectory() {
+        auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+        path = fs::temp_directory_path() / ("signature-tests-" + std::to_string(stamp));
+        fs::create_directories(path);
+    }
+    ~TempDirectory() {
+        std::error_code error;
+        fs::remove_all(path, error);
+    }
+    std::string write(const std::string& name, const std::string& text) const {
+        std::ofstream(path / name) << text;
+        return (path / name).string();
+    }
+    size_t cacheFiles() const {
+        size_t count = 0;
+        if (fs::exists(path / "cache")) {
+            for (const auto& entry : fs::directory_iterator(path / "cache"))
+                count += entry.is_regular_file();
+        }
+        return count;
+    }
+};
+
+void parsesPatterns() {
+    Signature signature;
+    CHECK(Signature::parse("8B 0D ?? ? 85 c9", signature));
+    CHECK(signature.bytes == (std::vector<uint8_t>{ 0x8B, 0x0D, 0, 0, 0x85, 0xC9 }));
+    CHECK(signature.wildcard == (std::vector<uint8_t>{ 0, 0, 1, 1, 0, 0 }));
+
+    CHECK(!Signature::parse("8B 0G", signature));
+    CHECK(!Signature::parse("8B 123", signature));
+    CHECK(!Signature::parse("8B 1", signature));
+    // Nothing fixed to look for
+    CHECK(!Signature::parse("?? ? ??", signature));
+    CHECK(!Signature::parse("", signature));
+}
+
+void scansAllSignaturesInOnePass() {
+    SignatureScanner scanner;
+    scanner.add(named("long", "AA AA AB"));
+    scanner.add(named("suffix", "AA AB"));              // ends where "long" does
+    scanner.add(named("wild", "?? 11 22 ?? 33"));        // anchored on its first run
+    scanner.add(named("repeated", "55 66"));
+    scanner.add(named("absent", "DE AD"));
+
+    const std::vector<uint8_t> data = {
+        0xAA, 0xAA, 0xAA, 0xAB,         // "long" at 1, "suffix" at 2
+        0x11, 0x22, 0x00, 0x33,         // "wild" at 3
+        0x55, 0x66, 0x55, 0x66, 0x55, 0x66,
+        0x11, 0x22, 0x00,               // "wild" cut off by the end of the buffer
+    };
+    const uint64_t base = 0x1000;
+    auto found = scanner.scan(data.data(), data.size(), base);
+    CHECK(found.size() == 5);
+    CHECK(found[0] == std::vector<uint64_t>{ base + 1 });
+    CHECK(found[1] == std::vector<uint64_t>{ base + 2 });
+    CHECK(found[2] == std::vector<uint64_t>{ base + 3 });
+    // At most two of each, enough to tell that a match isn't unique
+    CHECK(found[3] == (std::vector<uint64_t>{ base + 8, base + 10 }));
+    CHECK(found[4].empty());
+
+    // A wildcard before the anchor can't reach in front of the buffer
+    SignatureScanner leading;
+    leading.add(named("wild", "?? 11 22"));
+    CHECK(leading.scan(data.data() + 4, 2, base)[0].empty());
+}
+
+void resolvesAndCachesAddresses() {
+    TempDirectory directory;
+    FakeRemoteMemory memory;
+    buildImage(memory);
+
+    SignatureDatabase database;
+    CHECK(database.load(directory.write("signatures.txt", SIGNATURES)));
+    CHECK(!database.empty());
+    database.setCacheDirectory((directory.path / "cache").string());
+
+    SignatureDatabase::Addresses addresses;
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses == (SignatureDatabase::Addresses{ { "PlayerPtr", PLAYER_PTR }, { "Weapon", WEAPON } }));
+    CHECK(directory.cacheFiles() == 1);
+
+    // Same headers and signatures: the cache answers, the code isn't looked at
+    std::memset(memory.data(PLAYER_CODE), 0, 0x200);
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses["PlayerPtr"] == PLAYER_PTR && addresses["Weapon"] == WEAPON);
+    CHECK(directory.cacheFiles() == 1);
+
+    // Another build: different headers, a new key and a new scan
+    put32(memory, MODULE_BASE + PE_OFFSET + 0x8, 0x5F000000);     // TimeDateStamp
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses["PlayerPtr"] == 0 && addresses["Weapon"] == 0);
+    CHECK(directory.cacheFiles() == 2);
+
+    // Only the signatures count, not blank lines: still the cached miss
+    buildImage(memory);
+    put32(memory, MODULE_BASE + PE_OFFSET + 0x8, 0x5F000000);
+    CHECK(database.load(directory.write("signatures.txt", std::string(SIGNATURES) + "\n# later\n")));
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses["PlayerPtr"] == 0);
+    // Another signature on the same build is a new key
+    CHECK(database.load(directory.write("signatures.txt", std::string(SIGNATURES) + "Inventory 1 B8 ?? ?? ?? ?? C3\n")));
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses["PlayerPtr"] == PLAYER_PTR && addresses["Weapon"] == WEAPON);
+    CHECK(addresses.count("Inventory") == 1 && addresses["Inventory"] == 0);
+    CHECK(directory.cacheFiles() == 3);
+}
+
+void rejectsDoubtfulMatches() {
+    TempDirectory directory;
+    FakeRemoteMemory memory;
+    buildImage(memory);
+    // A second copy of the player code, and a weapon operand outside the image
+    put(memory, PLAYER_CODE + 0x800, bytes("8B 0D 00 00 00 00 85 C9"));
+    put32(memory, WEAPON_CODE + 1, MODULE_BASE + IMAGE_SIZE);
+
+    SignatureDatabase database;
+    CHECK(database.load(directory.write("signatures.txt", SIGNATURES)));
+    database.setCacheDirectory((directory.path / "cache").string());
+    SignatureDatabase::Addresses addresses;
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses["PlayerPtr"] == 0 && addresses["Weapon"] == 0);
+
+    // Bad lines are skipped; without a PE image nothing resolves
+    CHECK(database.load(directory.write("bad.txt", "Broken x 8B\nShort 0 8B 0D\nWeapon 1 A1 ?? ?? ?? ??\n")));
+    FakeRemoteMemory empty;
+    empty.map(MODULE_BASE, IMAGE_SIZE);
+    CHECK(!database.resolve(empty, MODULE_BASE, addresses));
+    CHECK(addresses.empty());
+    CHECK(database.resolve(memory, MODULE_BASE, addresses));
+    CHECK(addresses.size() == 1 && addresses["Weapon"] == 0);
+
+    // A missing file leaves nothing to resolve
+    CHECK(!database.load((directory.path / "missing.txt").string()));
+    CHECK(database.empty());
+    CHECK(!database.resolve(memory, MODULE_BASE, addresses));
+}
+
+} // namespace
+
+int main() {
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    parsesPatterns();
+    scansAllSignaturesInOnePass();
+    resolvesAndCachesAddresses();
+    rejectsDoubtfulMatches();
+    return test::result();
+}
@@ -0,0 +1,82 @@
+// SlotMap: handles, generations and the order slots are reused in. The
+// server derives client IDs from slot indices, so reuse is what decides
+// when an ID comes back.
+
+#include <algorithm>
+#include <vector>
+
+#include "../ServerClient/SlotMap.h"
+#include "TestCheck.h"
+
+namespace {
+
+void staleHandleAfterReuse() {
+    SlotMap<int> map;
+    SlotHandle first = map.insert(1);
+    CHECK(map.remove(first));
+    SlotHandle second = map.insert(2);
+
+    // Same slot, new generation: the old handle sees nothing, not the new value
+    CHECK(second.index == first.index);
+    CHECK(second.generation != first.generation);
+    CHECK(!map.contains(first));
+    CHECK(map.get(first) == nullptr);
+    CHECK(!map.remove(first));
+    CHECK(map.get(second) != nullptr && *map.get(second) == 2);
+}
+
+void oldestFreeSlotFirst() {
+    SlotMap<int> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < 4; ++i)
+        handles.push_back(map.insert(i));
+    map.remove(handles[2]);
+    map.remove(handles[0]);
+
+    CHECK(map.insert(10).index == handles[2].index);
+    CHECK(map.insert(11).index == handles[0].index);
+    // Only once no slot is free does a new one get created
+    CHECK(map.insert(12).index == 4);
+    CHECK(map.capacity() == 5);
+}
+
+void denseAfterRemove() {
+    SlotMap<int> map;
+    std::vector<SlotHandle> handles;
+    for (int i = 0; i < 5; ++i)
+        handles.push_back(map.insert(i));
+    map.remove(handles[1]);
+    map.remove(handles[3]);
+
+    std::vector<int> values(map.begin(), map.end());
+    std::sort(values.begin(), values.end());
+    CHECK(values == std::vector<int>({ 0, 2, 4 }));
+    CHECK(map.size() == 3);
+
+    // The value moved into the hole is still found by its handle, and handleAt agrees
+    CHECK(*map.get(handles[4]) == 4);
+    for (size_t i = 0; i < map.size(); ++i)
+        CHECK(*map.get(map.handleAt(i)) == *(map.begin() + i));
+}
+
+void clearInvalidatesHandles() {
+    SlotMap<int> map;
+    SlotHandle a = map.insert(1);
+    SlotHandle b = map.insert(2);
+    map.clear();
+
+    CHECK(map.empty());
+    CHECK(!map.contains(a) && !map.contains(b));
+    SlotHandle c = map.insert(3);
+    CHECK(c.index == a.index && c.generation != a.generation);
+}
+
+} // namespace
+
+int main() {
+    staleHandleAfterReuse();
+    oldestFreeSlotFirst();
+    denseAfterRemove();
+    clearInvalidatesHandles();
+    return test::result();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <iostream>
+
+// Checks for the test executables. Unlike assert they stay on in Release
+// builds, and a failed check is reported without stopping the others.
+namespace test {
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool passed, const char* expression, const char* file, int line) {
+    if (passed)
+        return;
+    ++failures();
+    std::cerr << file << ":" << line << ": check failed: " << expression << "\n";
+}
+
+// Exit code for main
+inline int result() {
+    if (failures() == 0)
+        return 0;
+    std::cerr << failures() << " check(s) failed\n";
+    return 1;
+}
+
+} // namespace test
+
+#define CHECK(condition) test::check((condition), #condition, __FILE__, __LINE__)
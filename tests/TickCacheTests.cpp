@@ -0,0 +1,144 @@
+// TickCache: one copy of each page per tick, dropped by writes, against an
+// address space faked in memory.
+
+#include <memory>
+#include <vector>
+
+#include "../HobbitGameManager/TickCache.h"
+#include "CountingMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint64_t BASE = 0x10000;
+const uint64_t PAGE = TickCache::PAGE_SIZE;
+
+struct Fixture {
+    std::shared_ptr<test::CountingMemory> memory = std::make_shared<test::CountingMemory>();
+    TickCache cache{ memory };
+
+    Fixture() {
+        memory->map(BASE, 6 * PAGE);
+    }
+    void set(uint64_t address, uint32_t value) {
+        memory->set(address, value);
+    }
+    uint32_t get(uint64_t address) {
+        uint32_t value = 0;
+        CHECK(cache.read(address, &value, sizeof(value)));
+        return value;
+    }
+};
+
+void pageReadOncePerTick() {
+    Fixture f;
+    f.set(BASE + 0x10, 1);
+    f.set(BASE + 0x20, 2);
+
+    f.cache.beginTick();
+    CHECK(f.get(BASE + 0x10) == 1);
+    uint64_t callsAfterFirst = f.memory->calls();
+    CHECK(f.get(BASE + 0x20) == 2);
+    CHECK(f.get(BASE + 0x10) == 1);
+    CHECK(f.memory->calls() == callsAfterFirst);
+
+    TickCache::Stats stats = f.cache.getStats();
+    CHECK(stats.misses == 1 && stats.hits == 2 && stats.pageFetches == 1);
+
+    // The copy holds for the tick even if the game changes underneath
+    f.set(BASE + 0x10, 5);
+    CHECK(f.get(BASE + 0x10) == 1);
+    f.cache.endTick();
+
+    f.cache.beginTick();
+    CHECK(f.get(BASE + 0x10) == 5);
+    f.cache.endTick();
+}
+
+void writeInvalidatesItsPages() {
+    Fixture f;
+    f.set(BASE + 0x10, 1);
+    f.set(BASE + PAGE + 0x10, 2);
+
+    f.cache.beginTick();
+    CHECK(f.get(BASE + 0x10) == 1);
+    CHECK(f.get(BASE + PAGE + 0x10) == 2);
+
+    uint32_t value = 7;
+    CHECK(f.cache.write(BASE + 0x10, &value, sizeof(value)));
+    CHECK(f.cache.getStats().invalidations == 1);
+
+    // The written page is fetched again and shows the write; the other page keeps its copy
+    uint64_t fetches = f.cache.getStats().pageFetches;
+    CHECK(f.get(BASE + 0x10) == 7);
+    CHECK(f.cache.getStats().pageFetches == fetches + 1);
+    CHECK(f.get(BASE + PAGE + 0x10) == 2);
+    CHECK(f.cache.getStats().pageFetches == fetches + 1);
+
+    // A write across a page boundary drops both pages
+    uint64_t straddling = BASE + PAGE - 2;
+    CHECK(f.cache.write(straddling, &value, sizeof(value)));
+    CHECK(f.cache.getStats().invalidations == 3);
+
+    WriteRequest batch[1] = { { BASE + PAGE + 0x10, &value, sizeof(value) } };
+    f.get(BASE + PAGE + 0x10);
+    CHECK(f.cache.writeBatch(batch, 1) == 1);
+    CHECK(f.get(BASE + PAGE + 0x10) == 7);
+    f.cache.endTick();
+}
+
+void bypasses() {
+    Fixture f;
+    f.set(BASE, 3);
+
+    // Outside a tick every read goes to the process
+    uint64_t calls = f.memory->calls();
+    CHECK(f.get(BASE) == 3);
+    CHECK(f.get(BASE) == 3);
+    CHECK(f.memory->calls() == calls + 2);
+    CHECK(f.cache.getStats().bypasses == 2);
+
+    f.cache.beginTick();
+    // Too big to cache
+    std::vector<uint8_t> big(TickCache::MAX_CACHED_READ + 1);
+    calls = f.memory->calls();
+    CHECK(f.cache.read(BASE, big.data(), big.size()));
+    CHECK(f.memory->calls() == calls + 1);
+    CHECK(f.cache.getStats().bypasses == 3 && f.cache.getStats().pageFetches == 0);
+
+    // A page that can't be read fails the read instead of serving zeros
+    uint32_t value = 0;
+    CHECK(!f.cache.read(BASE + 8 * PAGE, &value, sizeof(value)));
+    f.cache.endTick();
+}
+
+void batchFetchesMissingPagesTogether() {
+    Fixture f;
+    f.set(BASE, 1);
+    f.set(BASE + 2 * PAGE, 2);
+    uint32_t a = 0, b = 0, c = 0;
+    ReadRequest requests[3] = {
+        { BASE, &a, sizeof(a) },
+        { BASE + 2 * PAGE, &b, sizeof(b) },
+        { BASE + 0x8 * PAGE, &c, sizeof(c) },
+    };
+
+    f.cache.beginTick();
+    uint64_t batches = f.memory->batches;
+    CHECK(f.cache.readBatch(requests, 3) == 2);
+    CHECK(f.memory->batches == batches + 1);
+    CHECK(requests[0].ok && a == 1);
+    CHECK(requests[1].ok && b == 2);
+    CHECK(!requests[2].ok);
+    f.cache.endTick();
+}
+
+} // namespace
+
+int main() {
+    pageReadOncePerTick();
+    writeInvalidatesItsPages();
+    bypasses();
+    batchFetchesMissingPagesTogether();
+    return test::result();
+}
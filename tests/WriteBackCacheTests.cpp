@@ -0,0 +1,167 @@
+// WriteBackCache: writes of a tick merged into spans, and spans the game
+// still holds left out of the flush, against an address space faked in memory.
+
+#include <memory>
+#include <vector>
+
+#include "../HobbitGameManager/WriteBackCache.h"
+#include "../HobbitGameManager/HobbitProcessAnalyzer.h"
+#include "CountingMemory.h"
+#include "TestCheck.h"
+
+namespace {
+
+const uint64_t BASE = 0x20000;
+
+struct Fixture {
+    std::shared_ptr<test::CountingMemory> memory = std::make_shared<test::CountingMemory>();
+    WriteBackCache cache{ memory };
+
+    Fixture() {
+        memory->map(BASE, 0x1000);
+    }
+    void put(uint64_t address, float value) {
+        CHECK(cache.write(address, &value, sizeof(value)));
+    }
+    float game(uint64_t address) {
+        return memory->get<float>(address);
+    }
+};
+
+void adjacentWritesBecomeOneSpan() {
+    Fixture f;
+    f.cache.beginTick();
+    f.put(BASE + 0x0, 1.0f);
+    f.put(BASE + 0x4, 2.0f);
+    f.put(BASE + 0x8, 3.0f);
+    // Nothing reaches the game before the flush
+    CHECK(f.memory->written.empty());
+    CHECK(f.game(BASE + 0x4) == 0.0f);
+
+    CHECK(f.cache.flush() == 0);
+    CHECK(f.memory->writeBatches == 1);
+    CHECK(f.memory->written.size() == 1);
+    CHECK(f.memory->written[0] == std::make_pair(BASE, size_t(12)));
+    CHECK(f.game(BASE + 0x0) == 1.0f && f.game(BASE + 0x4) == 2.0f && f.game(BASE + 0x8) == 3.0f);
+    CHECK(f.cache.getStats().writes == 3 && f.cache.getStats().spans == 1);
+}
+
+void laterWriteWins() {
+    Fixture f;
+    f.cache.beginTick();
+    f.put(BASE + 0x10, 1.0f);
+    f.put(BASE + 0x10, 2.0f);
+    f.put(BASE + 0x40, 5.0f);
+    f.put(BASE + 0x3E, 4.0f);   // overlaps the start of the one at 0x40
+
+    // Reads see what the tick buffered
+    float value = 0;
+    CHECK(f.cache.read(BASE + 0x10, &value, sizeof(value)) && value == 2.0f);
+    ReadRequest request{ BASE + 0x10, &value, sizeof(value) };
+    value = 0;
+    CHECK(f.cache.readBatch(&request, 1) == 1 && value == 2.0f);
+
+    f.cache.flush();
+    CHECK(f.memory->written.size() == 2);
+    CHECK(f.game(BASE + 0x10) == 2.0f);
+    CHECK(f.game(BASE + 0x3E) == 4.0f);
+}
+
+void unchangedSpansAreSkipped() {
+    Fixture f;
+    f.cache.beginTick();
+    f.put(BASE, 1.0f);
+    f.cache.flush();
+    CHECK(f.memory->written.size() == 1);
+
+    // The same value again, and the game still holds it: compared, not written
+    f.cache.beginTick();
+    f.put(BASE, 1.0f);
+    CHECK(f.cache.flush() == 0);
+    CHECK(f.memory->written.size() == 1);
+    CHECK(f.cache.getStats().verified == 1 && f.cache.getStats().skipped == 1);
+
+    // The game changed it since: written again
+    f.memory->set(BASE, 9.0f);
+    f.cache.beginTick();
+    f.put(BASE, 1.0f);
+    f.cache.flush();
+    CHECK(f.memory->written.size() == 2);
+    CHECK(f.game(BASE) == 1.0f);
+    CHECK(f.cache.getStats().verified == 2 && f.cache.getStats().skipped == 1);
+
+    // After invalidate() nothing is assumed
+    f.cache.invalidate();
+    f.cache.beginTick();
+    f.put(BASE, 1.0f);
+    f.cache.flush();
+    CHECK(f.memory->written.size() == 3);
+    CHECK(f.cache.getStats().verified == 2);
+}
+
+void writesOutsideTickGoThrough() {
+    Fixture f;
+    f.put(BASE + 0x20, 6.0f);
+    CHECK(f.memory->written.size() == 1);
+    CHECK(f.game(BASE + 0x20) == 6.0f);
+
+    // And count as written: the same value in a tick is only compared
+    f.cache.beginTick();
+    f.put(BASE + 0x20, 6.0f);
+    f.cache.flush();
+    CHECK(f.memory->written.size() == 1);
+    CHECK(f.cache.getStats().skipped == 1);
+}
+
+void failedSpansAreCounted() {
+    Fixture f;
+    f.cache.beginTick();
+    f.put(BASE, 1.0f);
+    f.put(BASE + 0x10000, 2.0f);    // not mapped
+    CHECK(f.cache.flush() == 1);
+    CHECK(f.cache.getStats().failed == 1);
+    CHECK(f.game(BASE) == 1.0f);
+
+    // A failed span isn't remembered, so it is never skipped
+    f.cache.beginTick();
+    f.put(BASE + 0x10000, 2.0f);
+    CHECK(f.cache.flush() == 1);
+    CHECK(f.cache.getStats().verified == 0);
+}
+
+// The analyzer puts this cache over a TickCache; a value the game changed
+// after the tick read its page must still be written back
+void gameChangeAfterTickReadIsWritten() {
+    auto memory = std::make_shared<test::CountingMemory>();
+    memory->map(BASE, 0x1000);
+    HobbitProcessAnalyzer analyzer;
+    analyzer.setRemoteMemory(memory);
+    const uint32_t address = static_cast<uint32_t>(BASE + 0x40);
+
+    analyzer.beginTick();
+    analyzer.writeData<float>(address, 5.0f);
+    analyzer.endTick();
+    CHECK(memory->writeBatches == 1);
+
+    analyzer.beginTick();
+    CHECK(analyzer.readData<float>(address) == 5.0f);
+    memory->set(address, 7.0f);
+    analyzer.writeData<float>(address, 5.0f);
+    analyzer.endTick();
+
+    CHECK(memory->get<float>(address) == 5.0f);
+    CHECK(analyzer.getWriteCacheStats().skipped == 0);
+}
+
+} // namespace
+
+int main() {
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    adjacentWritesBecomeOneSpan();
+    laterWriteWins();
+    unchangedSpansAreSkipped();
+    writesOutsideTickGoThrough();
+    failedSpansAreCounted();
+    gameChangeAfterTickReadIsWritten();
+    return test::result();
+}
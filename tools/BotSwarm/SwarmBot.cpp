@@ -0,0 +1,220 @@
+#include "SwarmBot.h"
+
+#include <cmath>
+
+namespace {
+
+const float PI = 3.14159265f;
+const float CIRCLE_RADIUS = 200.0f;
+const float PATROL_LENGTH = 800.0f;
+// Bots start on a grid so they don't all stand on the same spot
+const size_t GRID_WIDTH = 32;
+const float GRID_SPACING = 500.0f;
+// Enemy GUIDs the bots hit, shared so the server has something to merge
+const uint64_t FIRST_ENEMY_GUID = 0x1000;
+const size_t ENEMY_COUNT = 64;
+const uint8_t INVENTORY_SLOTS = 8;
+
+PathPoint gridOrigin(size_t botIndex) {
+    PathPoint origin;
+    origin.x = (botIndex % GRID_WIDTH) * GRID_SPACING;
+    origin.z = (botIndex / GRID_WIDTH) * GRID_SPACING;
+    return origin;
+}
+
+float distance(const PathPoint& a, const PathPoint& b) {
+    return std::sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y) + (b.z - a.z) * (b.z - a.z));
+}
+
+}
+
+PathPoint PathScript::position(size_t botIndex, double seconds) const {
+    PathPoint origin = gridOrigin(botIndex);
+    double travelled = seconds * speed;
+
+    switch (kind) {
+    case Kind::Circle: {
+        float angle = static_cast<float>(travelled / CIRCLE_RADIUS) + botIndex;
+        origin.x += CIRCLE_RADIUS * std::cos(angle);
+        origin.z += CIRCLE_RADIUS * std::sin(angle);
+        return origin;
+    }
+    case Kind::Patrol: {
+        double along = std::fmod(travelled + botIndex * 37.0, 2 * PATROL_LENGTH);
+        origin.x += static_cast<float>(along < PATROL_LENGTH ? along : 2 * PATROL_LENGTH - along);
+        return origin;
+    }
+    case Kind::Waypoints: {
+        if (waypoints.size() < 2)
+            return waypoints.empty() ? origin : waypoints.front();
+
+        double loopLength = 0.0;
+        for (size_t i = 0; i < waypoints.size(); ++i)
+            loopLength += distance(waypoints[i], waypoints[(i + 1) % waypoints.size()]);
+        if (loopLength <= 0.0)
+            return waypoints.front();
+
+        // Bots are spread along the loop by index
+        double along = std::fmod(travelled + botIndex * loopLength / 16.0, loopLength);
+        for (size_t i = 0; i < waypoints.size(); ++i) {
+            const PathPoint& from = waypoints[i];
+            const PathPoint& to = waypoints[(i + 1) % waypoints.size()];
+            double leg = distance(from, to);
+            if (along <= leg && leg > 0.0) {
+                float t = static_cast<float>(along / leg);
+                return { from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t, from.z + (to.z - from.z) * t };
+            }
+            along -= leg;
+        }
+        return waypoints.front();
+    }
+    }
+    return origin;
+}
+
+float PathScript::heading(size_t botIndex, double seconds) const {
+    PathPoint now = position(botIndex, seconds);
+    PathPoint next = position(botIndex, seconds + 0.05);
+    return std::atan2(next.x - now.x, next.z - now.z) * 180.0f / PI;
+}
+
+SwarmBot::SwarmBot(asio::io_context& ioContext, size_t index, const BotSettings& settings, SwarmStats& stats)
+    : AsyncClient(ioContext), ioContext(ioContext), index(index), settings(settings), stats(stats) {}
+
+void SwarmBot::launch() {
+    setConnectListener([this](bool connected) {
+        if (!connected) {
+            ++stats.failed;
+            return;
+        }
+        ++stats.connected;
+        asio::co_spawn(ioContext, play(), asio::detached);
+    });
+    start(settings.host, settings.port);
+}
+
+void SwarmBot::finish() {
+    finishing = true;
+    stop();
+}
+
+asio::awaitable<void> SwarmBot::play() {
+    asio::steady_timer timer(ioContext);
+    auto started = std::chrono::steady_clock::now();
+
+    // Snapshots carry our ID, which only arrives after the hello
+    while (getClientID() == static_cast<uint8_t>(-1) && getIsConnected() && !finishing) {
+        timer.expires_after(std::chrono::milliseconds(10));
+        co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+    }
+
+    using Clock = std::chrono::steady_clock;
+    auto snapshotInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.snapshotRate));
+    auto eventInterval = settings.eventRate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / settings.eventRate))
+        : Clock::duration::max();
+    // Offset each bot inside the interval, so the swarm doesn't send in lockstep
+    auto nextSnapshot = Clock::now() + snapshotInterval * static_cast<int>(index % 16) / 16;
+    auto nextEvent = eventInterval == Clock::duration::max() ? Clock::time_point::max() : nextSnapshot + eventInterval;
+
+    while (getIsConnected() && !finishing) {
+        auto wakeAt = std::min(nextSnapshot, nextEvent);
+        timer.expires_at(wakeAt);
+        co_await timer.async_wait(asio::as_tuple(asio::use_awaitable));
+        if (!getIsConnected() || finishing)
+            break;
+
+        auto now = Clock::now();
+        if (now >= nextSnapshot) {
+            sendMessage(writeSnapshot(std::chrono::duration<double>(now - started).count()));
+            nextSnapshot += snapshotInterval;
+            // A stalled bot skips the snapshots it missed instead of bursting them
+            if (nextSnapshot < now)
+                nextSnapshot = now + snapshotInterval;
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            ++stats.snapshotsSent;
+        }
+        if (now >= nextEvent) {
+            sendMessage(writeEvent());
+            nextEvent += eventInterval;
+            if (nextEvent < now)
+                nextEvent = now + eventInterval;
+            std::lock_guard<std::mutex> lock(stats.mutex);
+            ++stats.eventsSent;
+        }
+    }
+    --stats.connected;
+}
+
+BaseMessage SwarmBot::writeSnapshot(double seconds) {
+    PathPoint position = settings.path.position(index, seconds);
+    float rotation = settings.path.heading(index, seconds);
+    uint32_t animation = 1;     // walking
+    uint32_t frame = static_cast<uint32_t>(seconds * 30.0) % 24;
+    uint32_t lastFrame = frame == 0 ? 23 : frame - 1;
+    int8_t weapon = 0;
+
+    std::vector<uint8_t> body;
+    body.push_back(static_cast<uint8_t>(DataLabel::CONNECTED_PLAYER_SNAP));
+    body.push_back(static_cast<uint8_t>(PLAYER_SNAP_SIZE));
+    appendRaw(body, settings.level);
+    appendRaw(body, animation);
+    appendRaw(body, frame);
+    appendRaw(body, lastFrame);
+    appendRaw(body, position.x);
+    appendRaw(body, position.y);
+    appendRaw(body, position.z);
+    appendRaw(body, rotation);
+    appendRaw(body, weapon);
+    appendBenchStamp(body, ++sequence);
+
+    BaseMessage snapshot(SNAPSHOT_MESSAGE, getClientID());
+    for (uint8_t byte : body)
+        snapshot.message.push(byte);
+    return snapshot;
+}
+
+BaseMessage SwarmBot::writeEvent() {
+    // Every event hits one enemy and picks up one item, alternating between shared targets
+    EnemyHealthChange hit{ FIRST_ENEMY_GUID + (index + sequence) % ENEMY_COUNT, -1.0f };
+    uint8_t slot = static_cast<uint8_t>((index + sequence) % INVENTORY_SLOTS);
+    float& increments = inventoryIncrements[slot];
+    increments += 1.0f;
+    InventoryCounterEntry item{ slot, replicaID, increments, 0.0f };
+
+    std::vector<uint8_t> body;
+    appendBenchStamp(body, ++sequence);
+    writeEnemiesHealthRecord(body, { hit });
+    writeInventoryRecord(body, { item });
+
+    BaseMessage event(EVENT_MESSAGE, getClientID());
+    for (uint8_t byte : body)
+        event.message.push(byte);
+    return event;
+}
+
+bool SwarmBot::takeGameMessage(const BaseMessage& msg) {
+    BenchStamp stamp;
+    bool stamped = findBenchStamp(msg.message, stamp);
+    uint64_t latency = stamped ? (benchClockNow() - stamp.sentAt) / 1000 : 0;
+
+    if (stamped) {
+        auto it = lastSequence.find(msg.senderID);
+        if (it == lastSequence.end()) {
+            lastSequence[msg.senderID] = stamp.sequence;
+            ++received;
+        }
+        else if (stamp.sequence > it->second) {
+            missed += stamp.sequence - it->second - 1;
+            it->second = stamp.sequence;
+            ++received;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(stats.mutex);
+    ++stats.framesReceived;
+    stats.bytesReceived += sizeof(uint32_t) + 2 + msg.message.size();
+    if (stamped)
+        (msg.messageType == SNAPSHOT_MESSAGE ? stats.snapshotLatency : stats.eventLatency).record(latency);
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <string>
+
+#include "../../ServerClient/AsyncClient.h"
+#include "../../ServerClient/InventoryCounters.h"
+#include "../common/HdrHistogram.h"
+#include "../common/BenchStamp.h"
+
+struct PathPoint {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+// Where a bot walks. Every bot follows the same script from its own
+// starting point, so the snapshots differ without any randomness.
+struct PathScript {
+    enum class Kind { Circle, Patrol, Waypoints };
+
+    Kind kind = Kind::Circle;
+    float speed = 300.0f;               // units per second
+    std::vector<PathPoint> waypoints;   // Waypoints only, walked in a loop
+
+    PathPoint position(size_t botIndex, double seconds) const;
+    float heading(size_t botIndex, double seconds) const;
+};
+
+struct BotSettings {
+    std::string host = "127.0.0.1";
+    uint16_t port = PORT;
+    double snapshotRate = 20.0;     // per second
+    double eventRate = 1.0;         // per second, 0 for none
+    uint8_t level = 1;
+    PathScript path;
+};
+
+// Counters shared by the bots of one io thread. Bots only lock it for the
+// few instructions of an update, so the reporter can read it while they run.
+struct SwarmStats {
+    std::mutex mutex;
+    HdrHistogram snapshotLatency;   // microseconds, since the last report
+    HdrHistogram eventLatency;
+    uint64_t snapshotsSent = 0;
+    uint64_t eventsSent = 0;
+    uint64_t framesReceived = 0;
+    uint64_t bytesReceived = 0;
+    std::atomic<size_t> connected{ 0 };
+    std::atomic<size_t> failed{ 0 };
+};
+
+// Simulated player on the real wire protocol: hello, snapshots along its
+// path, enemy health and inventory events. Everything it receives is
+// counted and dropped instead of queued.
+class SwarmBot : public AsyncClient {
+public:
+    SwarmBot(asio::io_context& ioContext, size_t index, const BotSettings& settings, SwarmStats& stats);
+
+    // Both must run on the bot's io thread
+    void launch();
+    void finish();
+
+    // Relayed messages seen from other bots, and how many of theirs never arrived
+    uint64_t getReceived() const { return received; }
+    uint64_t getMissed() const { return missed; }
+    size_t getIndex() const { return index; }
+
+protected:
+    bool takeGameMessage(const BaseMessage& msg) override;
+
+private:
+    asio::io_context& ioContext;
+    size_t index;
+    const BotSettings& settings;
+    SwarmStats& stats;
+    bool finishing = false;
+
+    uint32_t sequence = 0;
+    std::map<uint8_t, uint32_t> lastSequence;   // per sender
+    uint64_t received = 0;
+    uint64_t missed = 0;
+    uint64_t replicaID = InventoryCounters::newReplicaID();
+    std::map<uint8_t, float> inventoryIncrements;
+
+    asio::awaitable<void> play();
+    BaseMessage writeSnapshot(double seconds);
+    BaseMessage writeEvent();
+};
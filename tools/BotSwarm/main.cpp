@@ -0,0 +1,308 @@
+// Load generator: a swarm of simulated players against a running server.
+//
+// Usage: BotSwarm [--host ip] [--port N] [--clients N] [--ramp N] [--threads N]
+//                 [--snapshot-rate N] [--event-rate N] [--duration N]
+//                 [--path circle|patrol|file] [--speed N] [--report-interval N]
+//                 [--histogram file.hgrm] [--log-level debug|info|warning|error]
+//                 [--scenario file]
+//
+// Bots join at --ramp per second until --clients are connected and keep playing
+// for --duration seconds after that. Every report line shows the connected bot
+// count next to the throughput and relay latency, so the ramp shows where the
+// server stops keeping up. --path with a file name walks the "x y z" waypoints
+// listed in it, one per line. --scenario puts an in-process NetImpair proxy
+// between the bots and the server, so a run over a bad link can be repeated.
+
+#include <csignal>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+#include "SwarmBot.h"
+#include "../common/ImpairProxy.h"
+
+namespace {
+
+std::atomic<bool> stopRequested(false);
+
+void onStopSignal(int) {
+    stopRequested = true;
+}
+
+struct SwarmOptions {
+    BotSettings bot;
+    size_t clients = 100;
+    double rampPerSecond = 50.0;
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    double durationSeconds = 30.0;
+    double reportSeconds = 1.0;
+    std::string histogramFile;
+    std::string scenarioFile;
+    LogLevel logLevel = LogLevel::Log_Warning;
+};
+
+bool readWaypoints(const std::string& path, std::vector<PathPoint>& waypoints) {
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        PathPoint point;
+        if (fields >> point.x >> point.y >> point.z)
+            waypoints.push_back(point);
+    }
+    return !waypoints.empty();
+}
+
+bool parseOptions(int argc, char* argv[], SwarmOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        try {
+            if (key == "--host") options.bot.host = value;
+            else if (key == "--port") options.bot.port = static_cast<uint16_t>(std::stoul(value));
+            else if (key == "--clients") options.clients = std::stoul(value);
+            else if (key == "--ramp") options.rampPerSecond = std::stod(value);
+            else if (key == "--threads") options.threads = std::max<size_t>(1, std::stoul(value));
+            else if (key == "--snapshot-rate") options.bot.snapshotRate = std::stod(value);
+            else if (key == "--event-rate") options.bot.eventRate = std::stod(value);
+            else if (key == "--duration") options.durationSeconds = std::stod(value);
+            else if (key == "--speed") options.bot.path.speed = std::stof(value);
+            else if (key == "--report-interval") options.reportSeconds = std::stod(value);
+            else if (key == "--histogram") options.histogramFile = value;
+            else if (key == "--scenario") options.scenarioFile = value;
+            else if (key == "--log-level") {
+                if (value == "debug") options.logLevel = LogLevel::Log_Debug;
+                else if (value == "info") options.logLevel = LogLevel::Log_Info;
+                else if (value == "warning") options.logLevel = LogLevel::Log_Warning;
+                else if (value == "error") options.logLevel = LogLevel::Log_Error;
+                else return false;
+            }
+            else if (key == "--path") {
+                if (value == "circle") options.bot.path.kind = PathScript::Kind::Circle;
+                else if (value == "patrol") options.bot.path.kind = PathScript::Kind::Patrol;
+                else if (readWaypoints(value, options.bot.path.waypoints)) options.bot.path.kind = PathScript::Kind::Waypoints;
+                else {
+                    std::cerr << "Can't read waypoints from " << value << "\n";
+                    return false;
+                }
+            }
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && options.bot.snapshotRate > 0.0 && options.rampPerSecond > 0.0 && options.reportSeconds > 0.0;
+}
+
+void printUsage() {
+    std::cout << "Usage: BotSwarm [--host ip] [--port N] [--clients N] [--ramp N] [--threads N]\n"
+              << "                [--snapshot-rate N] [--event-rate N] [--duration N]\n"
+              << "                [--path circle|patrol|file] [--speed N] [--report-interval N]\n"
+              << "                [--histogram file.hgrm] [--log-level debug|info|warning|error]\n"
+              << "                [--scenario file]\n";
+}
+
+// Totals collected from every io thread
+struct SwarmTotals {
+    HdrHistogram snapshotLatency;
+    HdrHistogram eventLatency;
+    uint64_t snapshotsSent = 0;
+    uint64_t eventsSent = 0;
+    uint64_t framesReceived = 0;
+    uint64_t bytesReceived = 0;
+    size_t connected = 0;
+    size_t failed = 0;
+
+    // Moves everything counted since the last call out of the threads' stats
+    void collect(std::vector<std::unique_ptr<SwarmStats>>& allStats) {
+        for (auto& stats : allStats) {
+            std::lock_guard<std::mutex> lock(stats->mutex);
+            snapshotLatency.add(stats->snapshotLatency);
+            eventLatency.add(stats->eventLatency);
+            snapshotsSent += stats->snapshotsSent;
+            eventsSent += stats->eventsSent;
+            framesReceived += stats->framesReceived;
+            bytesReceived += stats->bytesReceived;
+            stats->snapshotLatency.reset();
+            stats->eventLatency.reset();
+            stats->snapshotsSent = stats->eventsSent = stats->framesReceived = stats->bytesReceived = 0;
+        }
+        connected = failed = 0;
+        for (auto& stats : allStats) {
+            connected += stats->connected;
+            failed += stats->failed;
+        }
+    }
+
+    void add(const SwarmTotals& other) {
+        snapshotLatency.add(other.snapshotLatency);
+        eventLatency.add(other.eventLatency);
+        snapshotsSent += other.snapshotsSent;
+        eventsSent += other.eventsSent;
+        framesReceived += other.framesReceived;
+        bytesReceived += other.bytesReceived;
+        connected = other.connected;
+        failed = other.failed;
+    }
+};
+
+std::string formatLatency(const HdrHistogram& histogram, double percentile) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << histogram.valueAtPercentile(percentile) / 1000.0;
+    return out.str();
+}
+
+void printReport(double elapsed, double interval, const SwarmTotals& totals) {
+    std::cout << std::fixed << std::setprecision(1)
+        << "[" << std::setw(6) << elapsed << "s] bots " << std::setw(5) << totals.connected
+        << "  sent/s " << std::setw(8) << (totals.snapshotsSent + totals.eventsSent) / interval
+        << "  relayed/s " << std::setw(10) << totals.framesReceived / interval
+        << "  MB/s " << std::setw(7) << totals.bytesReceived / interval / 1e6
+        << "  snapshot ms p50 " << formatLatency(totals.snapshotLatency, 50)
+        << " p99 " << formatLatency(totals.snapshotLatency, 99)
+        << " p99.9 " << formatLatency(totals.snapshotLatency, 99.9)
+        << " max " << formatLatency(totals.snapshotLatency, 100) << std::endl;
+}
+
+void printDropRates(const std::vector<std::unique_ptr<SwarmBot>>& bots) {
+    uint64_t received = 0, missed = 0;
+    size_t botsWithDrops = 0;
+    std::vector<std::pair<double, size_t>> rates;
+    for (const auto& bot : bots) {
+        uint64_t expected = bot->getReceived() + bot->getMissed();
+        double rate = expected ? static_cast<double>(bot->getMissed()) / expected : 0.0;
+        received += bot->getReceived();
+        missed += bot->getMissed();
+        botsWithDrops += bot->getMissed() > 0;
+        rates.push_back({ rate, bot->getIndex() });
+    }
+    std::sort(rates.rbegin(), rates.rend());
+
+    std::cout << std::setprecision(4) << "Drops: " << missed << " of " << received + missed << " stamped messages ("
+        << (received + missed ? 100.0 * missed / (received + missed) : 0.0) << "%), "
+        << botsWithDrops << " of " << bots.size() << " bots missed some\n";
+    for (size_t i = 0; i < rates.size() && i < 5 && rates[i].first > 0.0; ++i)
+        std::cout << "  bot " << rates[i].second << ": " << 100.0 * rates[i].first << "% missed\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    SwarmOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    LogManager::Instance().SetGlobalLogLevel(options.logLevel);
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    std::unique_ptr<ImpairProxy> proxy;
+    if (!options.scenarioFile.empty()) {
+        ImpairScenario scenario;
+        std::string error;
+        if (!ImpairScenario::load(options.scenarioFile, scenario, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        proxy = std::make_unique<ImpairProxy>(scenario);
+        if (!proxy->startTcp(0, options.bot.host, options.bot.port)) {
+            std::cerr << "Can't start the impairment proxy for " << options.bot.host << "\n";
+            return 1;
+        }
+        std::cout << "Through scenario " << scenario.name << " (seed " << scenario.seed << ")" << std::endl;
+        options.bot.host = "127.0.0.1";
+        options.bot.port = proxy->getTcpPort();
+    }
+
+    // One io_context per thread: an AsyncClient must stay on a single thread
+    std::vector<std::unique_ptr<asio::io_context>> contexts;
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> workGuards;
+    std::vector<std::unique_ptr<SwarmStats>> allStats;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < options.threads; ++i) {
+        contexts.push_back(std::make_unique<asio::io_context>(1));
+        workGuards.push_back(asio::make_work_guard(*contexts.back()));
+        allStats.push_back(std::make_unique<SwarmStats>());
+    }
+    for (auto& context : contexts)
+        threads.emplace_back([&context] { context->run(); });
+
+    std::cout << "Swarming " << options.bot.host << ":" << options.bot.port << " with " << options.clients << " bots, "
+        << options.bot.snapshotRate << " snapshots/s and " << options.bot.eventRate << " events/s each" << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto started = Clock::now();
+    auto nextReport = started + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.reportSeconds));
+    auto rampInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rampPerSecond));
+    auto nextLaunch = started;
+    Clock::time_point rampDone = Clock::time_point::max();
+
+    std::vector<std::unique_ptr<SwarmBot>> bots;
+    SwarmTotals overall;
+    auto lastReport = started;
+    while (!stopRequested) {
+        auto now = Clock::now();
+        while (bots.size() < options.clients && now >= nextLaunch) {
+            size_t thread = bots.size() % contexts.size();
+            bots.push_back(std::make_unique<SwarmBot>(*contexts[thread], bots.size(), options.bot, *allStats[thread]));
+            asio::post(*contexts[thread], [bot = bots.back().get()] { bot->launch(); });
+            nextLaunch += rampInterval;
+        }
+        if (bots.size() == options.clients && rampDone == Clock::time_point::max())
+            rampDone = now;
+        if (rampDone != Clock::time_point::max() && now - rampDone >= std::chrono::duration<double>(options.durationSeconds))
+            break;
+
+        if (now >= nextReport) {
+            SwarmTotals interval;
+            interval.collect(allStats);
+            printReport(std::chrono::duration<double>(now - started).count(), std::chrono::duration<double>(now - lastReport).count(), interval);
+            overall.add(interval);
+            lastReport = now;
+            nextReport += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.reportSeconds));
+        }
+        std::this_thread::sleep_until(std::min({ nextReport, bots.size() < options.clients ? nextLaunch : nextReport }));
+    }
+
+    for (size_t i = 0; i < bots.size(); ++i)
+        asio::post(*contexts[i % contexts.size()], [bot = bots[i].get()] { bot->finish(); });
+    for (auto& guard : workGuards)
+        guard.reset();
+    for (auto& thread : threads)
+        thread.join();
+
+    SwarmTotals rest;
+    rest.collect(allStats);
+    overall.add(rest);
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+    std::cout << "\nTotal over " << std::setprecision(1) << elapsed << "s: " << overall.snapshotsSent << " snapshots and "
+        << overall.eventsSent << " events sent, " << overall.framesReceived << " frames relayed ("
+        << overall.framesReceived / elapsed << "/s), " << overall.failed << " bots failed to connect\n";
+    std::cout << "Snapshot relay latency (ms): p50 " << formatLatency(overall.snapshotLatency, 50)
+        << "  p90 " << formatLatency(overall.snapshotLatency, 90)
+        << "  p99 " << formatLatency(overall.snapshotLatency, 99)
+        << "  p99.9 " << formatLatency(overall.snapshotLatency, 99.9)
+        << "  max " << formatLatency(overall.snapshotLatency, 100) << "\n";
+    std::cout << "Event relay latency (ms):    p50 " << formatLatency(overall.eventLatency, 50)
+        << "  p99 " << formatLatency(overall.eventLatency, 99)
+        << "  max " << formatLatency(overall.eventLatency, 100) << "\n";
+    printDropRates(bots);
+    if (proxy) {
+        proxy->stop();
+        std::cout << "Impairment proxy:\n";
+        proxy->writeStats(std::cout);
+    }
+
+    if (!options.histogramFile.empty()) {
+        std::ofstream out(options.histogramFile);
+        overall.snapshotLatency.writePercentiles(out, 1000.0);
+        std::cout << "Snapshot latency histogram (ms) written to " << options.histogramFile << "\n";
+    }
+    return 0;
+}
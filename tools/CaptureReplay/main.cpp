@@ -0,0 +1,260 @@
+// Replays a session captured with HobbitServer --capture.
+//
+// Usage: CaptureReplay --capture file [--host ip] [--port N] [--speed N] [--loops N]
+//                      [--serve N] [--info]
+//
+// Every player in the capture gets a Client of its own, which sends that
+// player's frames at their recorded times, so the server sees the same traffic
+// shape again. --speed 2 plays twice as fast, --speed 0 as fast as possible.
+//
+// Without --serve the frames go to a running server at --host/--port. With
+// --serve N an in-process Server is started on --port instead, and the replay
+// waits until N other clients (a game's HobbitClient, for one) have joined, so
+// they receive the recorded session through the relay.
+//
+// --info only prints what is in the capture.
+
+#include <csignal>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <ctime>
+
+#include "../../ServerClient/Server.h"
+#include "../../ServerClient/Client.h"
+#include "../../ServerClient/SessionCapture.h"
+#include "../common/HdrHistogram.h"
+
+namespace {
+
+const std::chrono::seconds CONNECT_TIMEOUT(5);
+
+std::atomic<bool> stopRequested(false);
+
+void onStopSignal(int) {
+    stopRequested = true;
+}
+
+struct ReplayOptions {
+    std::string capturePath;
+    std::string host = "127.0.0.1";
+    uint16_t port = PORT;
+    double speed = 1.0;
+    size_t loops = 1;
+    size_t serveClients = 0;
+    bool serve = false;
+    bool info = false;
+};
+
+// Stands in for one recorded player; what the server sends back is counted and dropped
+class ReplayClient : public Client {
+public:
+    std::atomic<uint64_t> received{ 0 };
+
+protected:
+    bool takeGameMessage(const BaseMessage&) override {
+        ++received;
+        return true;
+    }
+};
+
+// The client does its own handshake; everything else is sent again
+bool isReplayed(const std::vector<uint8_t>& body) {
+    return !body.empty() && body[0] != CLIENT_HELLO_MESSAGE && body[0] != CLIENT_LIST_REQUEST_MESSAGE;
+}
+
+const char* typeName(uint8_t type) {
+    switch (type) {
+    case BASE_MESSAGE: return "base";
+    case TEXT_MESSAGE: return "text";
+    case EVENT_MESSAGE: return "event";
+    case SNAPSHOT_MESSAGE: return "snapshot";
+    case CLIENT_LIST_REQUEST_MESSAGE: return "list request";
+    case CLIENT_HELLO_MESSAGE: return "hello";
+    default: return "other";
+    }
+}
+
+bool printInfo(CaptureReader& reader) {
+    std::map<uint8_t, uint64_t> framesPerSender;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> perType;   // frames, bytes
+    uint64_t frames = 0, bytes = 0, lastMicros = 0;
+    CapturedFrame frame;
+    while (reader.next(frame)) {
+        ++frames;
+        bytes += frame.body.size();
+        ++framesPerSender[frame.senderID];
+        auto& type = perType[frame.body.empty() ? "empty" : typeName(frame.body[0])];
+        ++type.first;
+        type.second += frame.body.size();
+        lastMicros = frame.micros;
+    }
+
+    std::time_t started = static_cast<std::time_t>(reader.getStartedAtMs() / 1000);
+    std::cout << "Captured " << std::put_time(std::localtime(&started), "%Y-%m-%d %H:%M:%S") << ", "
+        << std::fixed << std::setprecision(1) << lastMicros / 1e6 << " s, " << frames << " frames, " << bytes << " bytes, "
+        << framesPerSender.size() << " senders\n";
+    for (const auto& type : perType)
+        std::cout << "  " << std::left << std::setw(14) << type.first << std::right << std::setw(10) << type.second.first
+            << " frames " << std::setw(12) << type.second.second << " bytes\n";
+    return frames > 0;
+}
+
+bool parseOptions(int argc, char* argv[], ReplayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string key = argv[i];
+        if (key == "--info") {
+            options.info = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+        try {
+            if (key == "--capture") options.capturePath = value;
+            else if (key == "--host") options.host = value;
+            else if (key == "--port") options.port = static_cast<uint16_t>(std::stoul(value));
+            else if (key == "--speed") options.speed = std::stod(value);
+            else if (key == "--loops") options.loops = std::stoul(value);
+            else if (key == "--serve") {
+                options.serve = true;
+                options.serveClients = std::stoul(value);
+            }
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return !options.capturePath.empty() && options.speed >= 0.0 && options.loops > 0;
+}
+
+void printUsage() {
+    std::cout << "Usage: CaptureReplay --capture file [--host ip] [--port N] [--speed N] [--loops N]\n"
+              << "                     [--serve N] [--info]\n"
+              << "  --speed   1 plays in real time, 2 twice as fast, 0 as fast as possible\n"
+              << "  --serve   run a server here and start once N other clients have joined\n";
+}
+
+bool waitFor(const std::function<bool()>& ready, std::chrono::steady_clock::duration timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!ready()) {
+        if (stopRequested || std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Warning);
+
+    CaptureReader reader;
+    if (!reader.open(options.capturePath)) {
+        std::cerr << "Can't read capture " << options.capturePath << "\n";
+        return 1;
+    }
+    if (options.info)
+        return printInfo(reader) ? 0 : 1;
+
+    std::set<uint8_t> senders;
+    CapturedFrame frame;
+    while (reader.next(frame)) {
+        if (isReplayed(frame.body))
+            senders.insert(frame.senderID);
+    }
+    if (senders.empty()) {
+        std::cerr << "Nothing to replay in " << options.capturePath << "\n";
+        return 1;
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    std::unique_ptr<Server> server;
+    if (options.serve) {
+        ServerConfig config;
+        config.port = options.port;
+        server = std::make_unique<Server>(config);
+        if (!server->start())
+            return 1;
+        options.host = "127.0.0.1";
+        if (options.serveClients > 0) {
+            std::cout << "Waiting for " << options.serveClients << " clients on port " << options.port << std::endl;
+            if (!waitFor([&] { return server->getClientCount() >= options.serveClients; }, std::chrono::hours(24)))
+                return 1;
+        }
+    }
+
+    std::map<uint8_t, std::unique_ptr<ReplayClient>> players;
+    for (uint8_t sender : senders) {
+        auto client = std::make_unique<ReplayClient>();
+        client->setServerPort(options.port);
+        if (client->start(options.host) != 0) {
+            std::cerr << "Can't connect to " << options.host << ":" << options.port << "\n";
+            return 1;
+        }
+        players[sender] = std::move(client);
+    }
+    auto deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+    for (const auto& player : players) {
+        if (!player.second->waitForClients(1, deadline)) {
+            std::cerr << "Replay clients didn't get their IDs in time\n";
+            return 1;
+        }
+    }
+    std::cout << "Replaying " << players.size() << " players ";
+    if (options.speed > 0.0)
+        std::cout << "at " << options.speed << "x" << std::endl;
+    else
+        std::cout << "as fast as possible" << std::endl;
+
+    // How far behind its recorded time each frame went out, in microseconds
+    HdrHistogram lag;
+    uint64_t sent = 0;
+    using Clock = std::chrono::steady_clock;
+    auto started = Clock::now();
+    for (size_t loop = 0; loop < options.loops && !stopRequested; ++loop) {
+        reader.rewind();
+        auto loopStarted = Clock::now();
+        while (!stopRequested && reader.next(frame)) {
+            if (!isReplayed(frame.body))
+                continue;
+            if (options.speed > 0.0) {
+                auto due = loopStarted + std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(frame.micros) / options.speed);
+                std::this_thread::sleep_until(due);
+                lag.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - due).count());
+            }
+            BaseMessage* msg = BaseMessage::deserializeMessage(frame.body);
+            if (!msg)
+                continue;
+            players[frame.senderID]->sendMessage(*msg);
+            delete msg;
+            ++sent;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - started).count();
+
+    uint64_t received = 0;
+    for (const auto& player : players)
+        received += player.second->received;
+    std::cout << std::fixed << std::setprecision(1) << "Sent " << sent << " frames in " << elapsed << " s ("
+        << sent / elapsed << "/s), replay clients received " << received << "\n";
+    if (lag.count() > 0)
+        std::cout << "Lag behind the recording (ms): p50 " << lag.valueAtPercentile(50) / 1000.0
+            << "  p99 " << lag.valueAtPercentile(99) / 1000.0 << "  max " << lag.max() / 1000.0 << "\n";
+
+    // Joins each client's receive thread, so none outlives its client
+    for (auto& player : players)
+        player.second->stop();
+    if (server)
+        server->stop();
+    return 0;
+}
@@ -0,0 +1,547 @@
+// Measures what reading and writing the game's memory costs.
+//
+// Usage: MemoryBench [--backend fake|linux|all] [--iterations N] [--objects N] [--scan-mb N]
+//
+// The game isn't needed: a stand-in of its memory is laid out at the
+// addresses the game uses (player pointer, level state, object stack, objects)
+// and the analyzer's usual access patterns run against it. The fake backend
+// keeps that image in this process, so its numbers are the analyzer's own
+// overhead. The linux backend puts the image into a forked child and goes
+// through process_vm_readv/process_vm_writev, like reading the game under Wine.
+// Pattern searches also go over a block of noise standing in for the rest of
+// the game's address space.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#endif
+
+#include "../../HobbitGameManager/HobbitProcessAnalyzer.h"
+#include "../../HobbitGameManager/GameAddresses.h"
+#include "../../HobbitGameManager/FakeRemoteMemory.h"
+#include "../../HobbitGameManager/MemoryScanner.h"
+#include "../../HobbitGameManager/PointerPaths.h"
+
+namespace {
+
+// Where the stand-in lives: the exe's data section, and a heap for the object
+// stack, the player and the other objects
+const uint32_t IMAGE_BASE = 0x00700000;
+const uint32_t IMAGE_SIZE = 0x00100000;
+const uint32_t HEAP_BASE = 0x01000000;
+const uint32_t HEAP_SIZE = 0x00800000;
+const uint32_t OBJECT_STACK = HEAP_BASE;
+const uint32_t PLAYER_OBJECT = HEAP_BASE + 0x00080000;
+const uint32_t PLAYER_SIZE = 0x1000;
+const uint32_t OBJECTS = HEAP_BASE + 0x00100000;
+const uint32_t OBJECT_SIZE = 0x300;
+const uint32_t OBJECT_PTR_SIZE = 0x14;
+// The animation chain of the first NPC: object +0x304 -> +0x50 -> +0x10C
+const uint32_t NPC_CHAIN = HEAP_BASE + 0x00090000;
+const uint32_t MAX_OBJECTS = 1 + (HEAP_SIZE - (OBJECTS - HEAP_BASE)) / OBJECT_SIZE;
+const uint32_t NOISE_BASE = 0x10000000;
+const uint32_t MAX_NOISE_MB = 1024;
+
+// Game addresses the benchmark touches: the built-in ones the analyzer falls
+// back to when no signature resolves, as used by MainPlayer and HobbitGameManager
+uint32_t gameAddress(GameAddress id) {
+    return gameAddressTable()[static_cast<size_t>(id)].fallback;
+}
+const uint32_t PLAYER_PTR = gameAddress(GameAddress::PlayerPtr);
+const uint32_t WEAPON = gameAddress(GameAddress::Weapon);
+const uint32_t INVENTORY = gameAddress(GameAddress::Inventory);
+const uint32_t LEVEL_ENDED = gameAddress(GameAddress::LevelLoaded);
+const uint32_t LEVEL_LOADING = gameAddress(GameAddress::LevelLoading);
+const uint32_t GAME_STATE = gameAddress(GameAddress::GameState);
+const uint32_t CURRENT_LEVEL = gameAddress(GameAddress::CurrentLevel);
+const uint32_t OBJECT_STACK_PTR = gameAddress(GameAddress::ObjectStack);
+const uint32_t OBJECT_STACK_SIZE = gameAddress(GameAddress::ObjectStackSize);
+const uint32_t LEVEL_ASSIGNED = gameAddress(GameAddress::LevelAssigned);
+
+const uint64_t ENEMY_PATTERN = 0x0000000200000002;
+const uint32_t ENEMY_PATTERN_SHIFT = 0x184 + 0x8 * 0x4;
+
+struct BenchOptions {
+    std::string backend = "all";
+    uint64_t iterations = 100000;
+    uint32_t objects = 600;
+    uint32_t scanMB = 64;
+};
+
+// Counts the calls that reach the backend; a batch is one call
+class CountingMemory : public RemoteMemory {
+public:
+    std::atomic<uint64_t> reads{ 0 };
+    std::atomic<uint64_t> writes{ 0 };
+
+    explicit CountingMemory(std::shared_ptr<RemoteMemory> inner) : inner(std::move(inner)) {}
+
+    bool read(uint64_t address, void* buffer, size_t size) override {
+        ++reads;
+        return inner->read(address, buffer, size);
+    }
+    bool write(uint64_t address, const void* data, size_t size) override {
+        ++writes;
+        return inner->write(address, data, size);
+    }
+    size_t readBatch(ReadRequest* requests, size_t count) override {
+        ++reads;
+        return inner->readBatch(requests, count);
+    }
+    size_t writeBatch(WriteRequest* requests, size_t count) override {
+        ++writes;
+        return inner->writeBatch(requests, count);
+    }
+    std::vector<MemoryRegion> regions() override { return inner->regions(); }
+    bool isAlive() override { return inner->isAlive(); }
+    int lastError() const override { return inner->lastError(); }
+    const char* name() const override { return inner->name(); }
+
+private:
+    std::shared_ptr<RemoteMemory> inner;
+};
+
+uint32_t objectAddress(uint32_t index) {
+    return index == 0 ? PLAYER_OBJECT : OBJECTS + (index - 1) * OBJECT_SIZE;
+}
+
+uint64_t objectGUID(uint32_t index) {
+    return 0x0000AB0000000000ull + index;
+}
+
+template <typename T>
+bool put(RemoteMemory& memory, uint32_t address, T value) {
+    return memory.write(address, &value, sizeof(T));
+}
+
+// Not random enough to matter, only so the first/last byte prefilter of a
+// search has work to do now and then
+void fillNoise(uint8_t* data, size_t size) {
+    uint32_t state = 0x2545F491;
+    for (size_t i = 0; i < size; ++i) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        data[i] = static_cast<uint8_t>(state);
+    }
+}
+
+// Object 0 is the player; every third object after it is an enemy
+bool buildGameImage(RemoteMemory& memory, uint32_t objects) {
+    bool ok = true;
+    for (uint32_t i = 0; i < objects; ++i) {
+        uint32_t object = objectAddress(i);
+        ok &= put(memory, OBJECT_STACK + i * OBJECT_PTR_SIZE, object);
+        ok &= put(memory, object + 0x8, objectGUID(i));
+        ok &= put(memory, object + 0x290, 100.0f);
+        if (i > 0 && i % 3 == 0) {
+            ok &= put(memory, object + 0x10, uint32_t(0x04004232));
+            ok &= put(memory, object + ENEMY_PATTERN_SHIFT, ENEMY_PATTERN);
+        }
+    }
+    uint32_t npc = objectAddress(1);
+    ok &= put(memory, npc + 0x304, NPC_CHAIN);
+    ok &= put(memory, NPC_CHAIN + 0x50, NPC_CHAIN + 0x100);
+    ok &= put(memory, NPC_CHAIN + 0x100 + 0x10C, NPC_CHAIN + 0x400);
+
+    uint32_t player = objectAddress(0);
+    ok &= put(memory, player + 0x560, player + 0x800);
+    ok &= put(memory, player + 0x800, player + 0x900);
+    ok &= put(memory, player + 0x7C4, 1.0f);
+    ok &= put(memory, player + 0x7C8, 2.0f);
+    ok &= put(memory, player + 0x7CC, 3.0f);
+
+    ok &= put(memory, PLAYER_PTR, player);
+    ok &= put(memory, WEAPON, int8_t(1));
+    ok &= put(memory, INVENTORY, 1.0f);
+    ok &= put(memory, LEVEL_ENDED, true);
+    ok &= put(memory, GAME_STATE, uint32_t(10));
+    ok &= put(memory, CURRENT_LEVEL, uint32_t(3));
+    ok &= put(memory, OBJECT_STACK_PTR, OBJECT_STACK);
+    ok &= put(memory, OBJECT_STACK_SIZE, objects);
+    ok &= put(memory, LEVEL_ASSIGNED, true);
+    return ok;
+}
+
+// MainPlayer::readPtrs and processData: the reads made every tick for the player
+void readPlayerTick(HobbitProcessAnalyzer& analyzer) {
+    uint32_t player = analyzer.readData<uint32_t>(PLAYER_PTR);
+    uint32_t animation = 0x8 + analyzer.readData<uint32_t>(0x560 + analyzer.readData<uint32_t>(PLAYER_PTR));
+    volatile float sink = analyzer.readData<float>(0x7C4 + player)
+        + analyzer.readData<float>(0x7C8 + player)
+        + analyzer.readData<float>(0x7CC + player)
+        + analyzer.readData<float>(0x7AC + player)
+        + static_cast<float>(analyzer.readData<uint32_t>(animation))
+        + analyzer.readData<float>(PLAYER_PTR + 0x530)
+        + analyzer.readData<float>(PLAYER_PTR + 0x53C)
+        + analyzer.readData<int8_t>(WEAPON)
+        + analyzer.readData<uint8_t>(CURRENT_LEVEL);
+    (void)sink;
+}
+
+// HobbitGameManager::updateLevelState
+void readLevelState(HobbitProcessAnalyzer& analyzer) {
+    volatile uint32_t sink = analyzer.readData<uint32_t>(GAME_STATE)
+        + analyzer.readData<uint32_t>(CURRENT_LEVEL)
+        + analyzer.readData<bool>(LEVEL_ENDED)
+        + analyzer.readData<bool>(LEVEL_LOADING)
+        + analyzer.readData<bool>(LEVEL_ASSIGNED);
+    (void)sink;
+}
+
+// The same reads as MainPlayer issues them now: pointers first, then one batch
+void readPlayerTickBatched(HobbitProcessAnalyzer& analyzer) {
+    uint32_t player = analyzer.readData<uint32_t>(PLAYER_PTR);
+    uint32_t animationPtr = 0x8 + analyzer.readData<uint32_t>(0x560 + player);
+    float x, y, z, rotation, frame, lastFrame;
+    uint32_t animation;
+    int8_t weapon;
+    uint8_t level;
+    ReadBatch batch;
+    batch.add(0x7C4 + player, x);
+    batch.add(0x7C8 + player, y);
+    batch.add(0x7CC + player, z);
+    batch.add(0x7AC + player, rotation);
+    batch.add(animationPtr, animation);
+    batch.add(PLAYER_PTR + 0x530, frame);
+    batch.add(PLAYER_PTR + 0x53C, lastFrame);
+    batch.add(WEAPON, weapon);
+    batch.add(CURRENT_LEVEL, level);
+    analyzer.readBatch(batch);
+}
+
+void readLevelStateBatched(HobbitProcessAnalyzer& analyzer) {
+    uint32_t state, level;
+    uint8_t ended, loading, assigned;
+    ReadBatch batch;
+    batch.add(GAME_STATE, state);
+    batch.add(CURRENT_LEVEL, level);
+    batch.add(LEVEL_ENDED, ended);
+    batch.add(LEVEL_LOADING, loading);
+    batch.add(LEVEL_ASSIGNED, assigned);
+    analyzer.readBatch(batch);
+}
+
+// What a HobbitClient tick reads now: the player snapshot, enemies and
+// inventory, and for a connected player the level, NPC animation and weapon
+void readClientTick(HobbitProcessAnalyzer& analyzer, uint64_t weaponGUID) {
+    readPlayerTickBatched(analyzer);
+
+    const uint32_t ENEMIES = 30;
+    float health[ENEMIES];
+    uint64_t guid[ENEMIES];
+    ReadBatch enemies;
+    for (uint32_t i = 0; i < ENEMIES; ++i) {
+        enemies.add(objectAddress(3 * (i + 1)) + 0x290, health[i]);
+        enemies.add(objectAddress(3 * (i + 1)) + 0x8, guid[i]);
+    }
+    analyzer.readBatch(enemies);
+
+    std::array<float, 56> inventory;
+    ReadBatch slots;
+    slots.add(INVENTORY, inventory);
+    analyzer.readBatch(slots);
+
+    uint8_t level;
+    uint32_t animation;
+    ReadBatch connected;
+    connected.add(CURRENT_LEVEL, level);
+    connected.add(objectAddress(0) + 0x900, animation);
+    analyzer.readBatch(connected);
+
+    uint32_t weaponObject = analyzer.findGameObjByGUID(weaponGUID);
+    if (weaponObject)
+        analyzer.readData<uint32_t>(weaponObject + 0x260);
+}
+
+// What searchProcessMemory did before MemoryScanner: memcmp at every offset
+void searchMemcmpLoop(RemoteMemory& process, const std::vector<uint8_t>& pattern) {
+    std::vector<uint64_t> found;
+    for (const MemoryRegion& region : process.regions()) {
+        std::vector<uint8_t> buffer(region.size);
+        if (region.size < pattern.size() || !process.read(region.base, buffer.data(), buffer.size()))
+            continue;
+        for (size_t i = 0; i + pattern.size() <= buffer.size(); ++i) {
+            if (memcmp(buffer.data() + i, pattern.data(), pattern.size()) == 0)
+                found.push_back(region.base + i);
+        }
+    }
+}
+
+std::shared_ptr<MemoryScanner> makeScanner(size_t threads, ScanInstructionSet set) {
+    auto scanner = std::make_shared<MemoryScanner>(threads);
+    scanner->setInstructionSet(set);
+    return scanner;
+}
+
+// What NPC::setNCP walked before PointerPaths: the animation chain twice,
+// a read per hop
+void walkNpcPointers(HobbitProcessAnalyzer& analyzer) {
+    uint32_t object = objectAddress(1);
+    for (int walk = 0; walk < 2; ++walk) {
+        uint32_t hop = analyzer.readData<uint32_t>(0x304 + object);
+        hop = analyzer.readData<uint32_t>(0x50 + hop);
+        volatile uint32_t animation = 0x8 + analyzer.readData<uint32_t>(0x10C + hop);
+        (void)animation;
+    }
+}
+
+// ConnectedPlayer::processPlayer for one remote player: the position into
+// the NPC's three copies of it, then rotation and animation
+void writeRemotePlayer(HobbitProcessAnalyzer& analyzer, float step) {
+    uint32_t npc = objectAddress(1);
+    const uint32_t positions[] = { npc + 0x14, npc + 0x20, NPC_CHAIN + 0x400 - 0xC4 };
+    for (uint32_t axis = 0; axis < 3; ++axis) {
+        for (uint32_t position : positions)
+            analyzer.writeData<float>(position + 0x4 * axis, step + axis);
+    }
+    analyzer.writeData<float>(npc + 0x6C, 0.5f);
+    analyzer.writeData<uint32_t>(NPC_CHAIN + 0x400, 7);
+}
+
+const PointerPaths& npcPaths() {
+    static const PointerPaths paths = [] {
+        PointerPaths declared;
+        declared.add({ 0x304, 0x50, 0x10C }, 0x8);
+        return declared;
+    }();
+    return paths;
+}
+
+struct Workload {
+    const char* name;
+    uint64_t divisor;   // runs iterations / divisor times, for the slow ones
+    std::function<void(HobbitProcessAnalyzer&)> run;
+};
+
+std::vector<Workload> workloads(const BenchOptions& options) {
+    uint64_t lastGUID = objectGUID(options.objects - 1);
+    uint32_t enemyHealth = objectAddress(3) + 0x290;
+    std::vector<uint8_t> guidBytes(sizeof(lastGUID));
+    memcpy(guidBytes.data(), &lastGUID, sizeof(lastGUID));
+    auto scalar = makeScanner(1, ScanInstructionSet::Scalar);
+    auto sse2 = makeScanner(1, ScanInstructionSet::SSE2);
+    auto avx2 = makeScanner(1, ScanInstructionSet::AVX2);
+    auto npcPointers = std::make_shared<PointerCache>(npcPaths(), 0x8, sizeof(uint64_t));
+    auto step = std::make_shared<float>(0.0f);
+    return {
+        { "read u32", 1, [](HobbitProcessAnalyzer& a) { a.readData<uint32_t>(CURRENT_LEVEL); } },
+        { "write f32", 1, [enemyHealth](HobbitProcessAnalyzer& a) { a.writeData<float>(enemyHealth, 50.0f); } },
+        { "read 4 KiB", 1, [](HobbitProcessAnalyzer& a) { a.readData<uint8_t>(PLAYER_OBJECT, PLAYER_SIZE); } },
+        { "player tick", 10, readPlayerTick },
+        { "player tick (batch)", 10, readPlayerTickBatched },
+        { "level state", 10, readLevelState },
+        { "level state (batch)", 10, readLevelStateBatched },
+        { "find by GUID (last)", 1, [lastGUID](HobbitProcessAnalyzer& a) { a.findGameObjByGUID(lastGUID); } },
+        { "index object stack", 1000, [lastGUID](HobbitProcessAnalyzer& a) {
+            a.invalidateObjectIndex();
+            a.findGameObjByGUID(lastGUID);
+        } },
+        { "npc pointers (walk)", 10, walkNpcPointers },
+        { "npc pointers (new)", 10, [npcPointers](HobbitProcessAnalyzer& a) {
+            npcPointers->invalidate();
+            npcPointers->get(a, objectAddress(1));
+            npcPointers->get(a, objectAddress(1));
+        } },
+        { "npc pointers (kept)", 10, [npcPointers](HobbitProcessAnalyzer& a) {
+            npcPointers->get(a, objectAddress(1));
+            npcPointers->get(a, objectAddress(1));
+        } },
+        { "remote player (still)", 10, [](HobbitProcessAnalyzer& a) { writeRemotePlayer(a, 1.0f); } },
+        { "remote player (moved)", 10, [step](HobbitProcessAnalyzer& a) { writeRemotePlayer(a, *step += 1.0f); } },
+        { "find process", 1000, [](HobbitProcessAnalyzer& a) { a.getProcess("MemoryBench"); } },
+        { "process alive", 1, [](HobbitProcessAnalyzer& a) { a.getRemoteMemory()->isAlive(); } },
+        { "client tick", 100, [lastGUID](HobbitProcessAnalyzer& a) { readClientTick(a, lastGUID); } },
+        { "find all enemies", 1000, [](HobbitProcessAnalyzer& a) { a.findAllGameObjByPattern<uint64_t>(ENEMY_PATTERN, ENEMY_PATTERN_SHIFT); } },
+        { "search: memcmp loop", 20000, [guidBytes](HobbitProcessAnalyzer& a) { searchMemcmpLoop(*a.getRemoteMemory(), guidBytes); } },
+        { "search: scalar x1", 20000, [guidBytes, scalar](HobbitProcessAnalyzer& a) { scalar->search(*a.getRemoteMemory(), guidBytes); } },
+        { "search: sse2 x1", 20000, [guidBytes, sse2](HobbitProcessAnalyzer& a) { sse2->search(*a.getRemoteMemory(), guidBytes); } },
+        { "search: avx2 x1", 20000, [guidBytes, avx2](HobbitProcessAnalyzer& a) { avx2->search(*a.getRemoteMemory(), guidBytes); } },
+        { "search memory", 20000, [lastGUID](HobbitProcessAnalyzer& a) { a.searchProcessMemory(lastGUID); } },
+    };
+}
+
+struct RunResult {
+    uint64_t runs = 0;
+    double nsPerRun = 0;
+    double callsPerRun = 0;
+};
+
+// With ticks, every run is a tick of its own: the cache starts empty each time
+RunResult runWorkload(HobbitProcessAnalyzer& analyzer, CountingMemory& counting, const Workload& workload,
+    uint64_t runs, bool ticks) {
+    counting.reads = 0;
+    counting.writes = 0;
+    auto started = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < runs; ++i) {
+        if (ticks)
+            analyzer.beginTick();
+        workload.run(analyzer);
+        if (ticks)
+            analyzer.endTick();
+    }
+    RunResult result;
+    result.runs = runs;
+    result.nsPerRun = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - started).count() / runs;
+    result.callsPerRun = double(counting.reads + counting.writes) / runs;
+    return result;
+}
+
+void runWorkloads(const std::shared_ptr<RemoteMemory>& backend, const BenchOptions& options) {
+    auto counting = std::make_shared<CountingMemory>(backend);
+    HobbitProcessAnalyzer analyzer;
+    analyzer.setRemoteMemory(counting);
+    analyzer.updateObjectStackAddress();
+
+    for (const Workload& workload : workloads(options)) {
+        uint64_t runs = std::max<uint64_t>(1, options.iterations / workload.divisor);
+        RunResult direct = runWorkload(analyzer, *counting, workload, runs, false);
+
+        TickCache::Stats before = analyzer.getTickCacheStats();
+        RunResult ticked = runWorkload(analyzer, *counting, workload, runs, true);
+        TickCache::Stats after = analyzer.getTickCacheStats();
+        uint64_t hits = after.hits - before.hits;
+        uint64_t cachedReads = hits + after.misses - before.misses;
+
+        std::cout << std::left << std::setw(8) << backend->name()
+                  << std::setw(22) << workload.name << std::right
+                  << std::setw(8) << runs
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(12) << direct.nsPerRun
+                  << std::setprecision(1) << std::setw(10) << direct.callsPerRun
+                  << std::setprecision(0) << std::setw(12) << ticked.nsPerRun
+                  << std::setprecision(1) << std::setw(10) << ticked.callsPerRun
+                  << std::setw(8) << (cachedReads ? 100.0 * hits / cachedReads : 0.0)
+                  << "\n";
+    }
+}
+
+void runFake(const BenchOptions& options) {
+    auto fake = std::make_shared<FakeRemoteMemory>();
+    fake->map(IMAGE_BASE, IMAGE_SIZE);
+    fake->map(HEAP_BASE, HEAP_SIZE);
+    fake->map(NOISE_BASE, options.scanMB << 20);
+    fillNoise(fake->data(NOISE_BASE), options.scanMB << 20);
+    buildGameImage(*fake, options.objects);
+    runWorkloads(fake, options);
+}
+
+#ifdef __linux__
+bool mapFixed(uint32_t base, uint32_t size) {
+#ifdef MAP_FIXED_NOREPLACE
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE;
+#else
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#endif
+    void* wanted = reinterpret_cast<void*>(static_cast<uintptr_t>(base));
+    void* mapped = mmap(wanted, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (mapped == MAP_FAILED)
+        return false;
+    if (mapped != wanted) {
+        munmap(mapped, size);
+        return false;
+    }
+    return true;
+}
+
+// The child only holds the image; it is killed once the runs are done
+bool runLinux(const BenchOptions& options) {
+    uint32_t noiseSize = options.scanMB << 20;
+    if (!mapFixed(IMAGE_BASE, IMAGE_SIZE) || !mapFixed(HEAP_BASE, HEAP_SIZE) || !mapFixed(NOISE_BASE, noiseSize)) {
+        std::cerr << "linux: can't map the game's addresses in this process\n";
+        return false;
+    }
+    fillNoise(reinterpret_cast<uint8_t*>(static_cast<uintptr_t>(NOISE_BASE)), noiseSize);
+    pid_t child = fork();
+    if (child < 0)
+        return false;
+    if (child == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        while (true)
+            pause();
+    }
+    munmap(reinterpret_cast<void*>(static_cast<uintptr_t>(IMAGE_BASE)), IMAGE_SIZE);
+    munmap(reinterpret_cast<void*>(static_cast<uintptr_t>(HEAP_BASE)), HEAP_SIZE);
+    munmap(reinterpret_cast<void*>(static_cast<uintptr_t>(NOISE_BASE)), noiseSize);
+
+    auto process = std::make_shared<LinuxRemoteMemory>(child);
+    bool ok = buildGameImage(*process, options.objects);
+    if (ok)
+        runWorkloads(process, options);
+    else
+        std::cerr << "linux: can't write to the child process (errno " << process->lastError() << ")\n";
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+    return ok;
+}
+#endif
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string key = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        std::string value = argv[++i];
+        try {
+            if (key == "--backend") options.backend = value;
+            else if (key == "--iterations") options.iterations = std::stoull(value);
+            else if (key == "--objects") options.objects = static_cast<uint32_t>(std::stoul(value));
+            else if (key == "--scan-mb") options.scanMB = static_cast<uint32_t>(std::stoul(value));
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    bool knownBackend = options.backend == "fake" || options.backend == "linux" || options.backend == "all";
+    return knownBackend && options.iterations > 0 && options.objects > 3 && options.objects <= MAX_OBJECTS
+        && options.scanMB > 0 && options.scanMB <= MAX_NOISE_MB;
+}
+
+void printUsage() {
+    std::cout << "Usage: MemoryBench [--backend fake|linux|all] [--iterations N] [--objects N] [--scan-mb N]\n"
+              << "  --objects   size of the object stack, 4 to " << MAX_OBJECTS << "\n"
+              << "  --scan-mb   MiB of noise pattern searches go over, 1 to " << MAX_NOISE_MB << "\n"
+              << "Every operation runs once reading the game directly and once per tick\n"
+              << "through the tick cache, which starts empty every run, with writes held\n"
+              << "back to the end of the tick.\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+
+    std::cout << std::left << std::setw(8) << "backend" << std::setw(22) << "operation" << std::right
+              << std::setw(8) << "runs" << std::setw(12) << "ns/op" << std::setw(10) << "calls/op"
+              << std::setw(12) << "tick ns/op" << std::setw(10) << "calls/op" << std::setw(8) << "hit %" << "\n";
+
+    bool ok = true;
+    if (options.backend == "fake" || options.backend == "all")
+        runFake(options);
+#ifdef __linux__
+    if (options.backend == "linux" || options.backend == "all")
+        ok = runLinux(options);
+#else
+    if (options.backend == "linux") {
+        std::cerr << "The linux backend only runs on Linux\n";
+        ok = false;
+    }
+#endif
+    return ok ? 0 : 1;
+}
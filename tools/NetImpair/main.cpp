@@ -0,0 +1,138 @@
+// Network impairment proxy: sits between clients and a server on localhost
+// and applies a scenario of latency, jitter, loss, reordering and bandwidth caps.
+//
+// Usage: NetImpair --target host:port [--listen N] [--scenario file]
+//                  [--udp-target host:port] [--udp-listen N] [--stats-interval N]
+//
+// Clients connect to --listen (default 54100) instead of the server. Scenario
+// files are described in tools/common/ImpairProxy.h; examples are in
+// tools/NetImpair/scenarios. Without one the proxy forwards unchanged.
+// Per-direction stats are printed every --stats-interval seconds and on exit.
+// BotSwarm and RelayLatency take the same --scenario and run the proxy in-process.
+
+#include <atomic>
+#include <csignal>
+#include <iostream>
+
+#include "../common/ImpairProxy.h"
+
+namespace {
+
+const uint16_t DEFAULT_LISTEN_PORT = 54100;
+
+std::atomic<bool> stopRequested(false);
+
+void onStopSignal(int) {
+    stopRequested = true;
+}
+
+struct ImpairOptions {
+    uint16_t listenPort = DEFAULT_LISTEN_PORT;
+    std::string targetHost;
+    uint16_t targetPort = 0;
+    uint16_t udpListenPort = 0;
+    std::string udpTargetHost;
+    uint16_t udpTargetPort = 0;
+    std::string scenarioFile;
+    double statsSeconds = 5.0;
+};
+
+bool parseHostPort(const std::string& text, std::string& host, uint16_t& port) {
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos || colon == 0)
+        return false;
+    host = text.substr(0, colon);
+    unsigned long number = std::stoul(text.substr(colon + 1));
+    if (number == 0 || number > 65535)
+        return false;
+    port = static_cast<uint16_t>(number);
+    return true;
+}
+
+bool parseOptions(int argc, char* argv[], ImpairOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        try {
+            if (key == "--listen") options.listenPort = static_cast<uint16_t>(std::stoul(value));
+            else if (key == "--target") {
+                if (!parseHostPort(value, options.targetHost, options.targetPort))
+                    return false;
+            }
+            else if (key == "--udp-listen") options.udpListenPort = static_cast<uint16_t>(std::stoul(value));
+            else if (key == "--udp-target") {
+                if (!parseHostPort(value, options.udpTargetHost, options.udpTargetPort))
+                    return false;
+            }
+            else if (key == "--scenario") options.scenarioFile = value;
+            else if (key == "--stats-interval") options.statsSeconds = std::stod(value);
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && !options.targetHost.empty() && options.statsSeconds > 0.0;
+}
+
+void printUsage() {
+    std::cout << "Usage: NetImpair --target host:port [--listen N] [--scenario file]\n"
+              << "                 [--udp-target host:port] [--udp-listen N] [--stats-interval N]\n"
+              << "  --listen          TCP port clients connect to (default " << DEFAULT_LISTEN_PORT << ")\n"
+              << "  --udp-target      also forward UDP datagrams (snapshot mesh) to this address\n"
+              << "  --udp-listen      UDP port for them (default: the TCP listen port)\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    ImpairOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    ImpairScenario scenario;
+    std::string error;
+    if (!options.scenarioFile.empty() && !ImpairScenario::load(options.scenarioFile, scenario, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+
+    ImpairProxy proxy(scenario);
+    if (!proxy.startTcp(options.listenPort, options.targetHost, options.targetPort)) {
+        std::cerr << "Can't listen on TCP port " << options.listenPort << " or resolve " << options.targetHost << "\n";
+        return 1;
+    }
+    std::cout << "Scenario " << scenario.name << " (seed " << scenario.seed << ", " << scenario.phases.size()
+        << " phases): TCP " << proxy.getTcpPort() << " -> " << options.targetHost << ":" << options.targetPort;
+    if (!options.udpTargetHost.empty()) {
+        uint16_t udpListen = options.udpListenPort ? options.udpListenPort : proxy.getTcpPort();
+        if (!proxy.startUdp(udpListen, options.udpTargetHost, options.udpTargetPort)) {
+            std::cerr << "\nCan't listen on UDP port " << udpListen << " or resolve " << options.udpTargetHost << "\n";
+            return 1;
+        }
+        std::cout << ", UDP " << proxy.getUdpPort() << " -> " << options.udpTargetHost << ":" << options.udpTargetPort;
+    }
+    std::cout << std::endl;
+
+    using Clock = std::chrono::steady_clock;
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.statsSeconds));
+    auto nextStats = Clock::now() + interval;
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (Clock::now() >= nextStats) {
+            proxy.writeStats(std::cout);
+            std::cout.flush();
+            nextStats += interval;
+        }
+    }
+
+    proxy.stop();
+    std::cout << "\nTotal:\n";
+    proxy.writeStats(std::cout);
+    return 0;
+}
@@ -0,0 +1,383 @@
+// Relay latency benchmark, after asio's src/tests/latency tcp_client/tcp_server.
+//
+// Usage: RelayLatency [--clients 2,8,32] [--sizes 16,256,1024] [--samples N]
+//                     [--warmup N] [--port N] [--workers N] [--host ip]
+//                     [--json file] [--csv file] [--hgrm-dir dir] [--scenario file]
+//
+// For every client count and message size it connects that many real Clients
+// to a Server over loopback (or to a running server with --host). A probe
+// client sends a stamped text message, the server relays it to everyone, an
+// echo client sends it straight back, and the probe waits for the echo before
+// sending the next one, like the ping-pong in asio's test. The other clients
+// only receive, so the fan-out costs are part of the measurement.
+// --scenario routes every client through an in-process NetImpair proxy with
+// a fixed seed, so runs over an impaired link are reproducible.
+//
+// Reported per configuration, in microseconds:
+//   relay      - probe send to echo receive (one way through the server)
+//   round trip - probe send to probe receiving the echo
+
+#include <condition_variable>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "../../ServerClient/Server.h"
+#include "../../ServerClient/Client.h"
+#include "../common/HdrHistogram.h"
+#include "../common/BenchStamp.h"
+#include "../common/ImpairProxy.h"
+
+namespace {
+
+// Nanosecond values up to 10 s
+const uint64_t HIGHEST_LATENCY_NS = 10000000000ull;
+const std::chrono::seconds ECHO_TIMEOUT(2);
+const std::chrono::seconds CONNECT_TIMEOUT(5);
+
+struct BenchOptions {
+    std::vector<size_t> clientCounts = { 2, 8, 32 };
+    std::vector<size_t> messageSizes = { 16, 256, 1024 };
+    size_t samples = 10000;
+    size_t warmup = 1000;
+    uint16_t port = PORT + 100;
+    size_t workers = 0;
+    std::string host;       // empty: run an in-process server
+    std::string jsonFile;
+    std::string csvFile;
+    std::string hgrmDir;
+    std::string scenarioFile;
+    ImpairScenario scenario;
+};
+
+// Text message: stamp record first, then padding up to the requested body size
+BaseMessage makeProbe(uint32_t sequence, size_t size) {
+    std::vector<uint8_t> body;
+    body.reserve(std::max<size_t>(size, 2 + BENCH_STAMP_SIZE));
+    appendBenchStamp(body, sequence);
+    body.resize(std::max(size, body.size()), 0x5A);
+
+    BaseMessage msg(TEXT_MESSAGE, 0);
+    for (uint8_t byte : body)
+        msg.message.push(byte);
+    return msg;
+}
+
+// Any client in the benchmark; messages are counted, never queued
+class BenchClient : public Client {
+public:
+    std::atomic<uint64_t> received{ 0 };
+
+protected:
+    bool takeGameMessage(const BaseMessage&) override {
+        ++received;
+        return true;
+    }
+};
+
+// Sends every probe it gets straight back and times the relay leg
+class EchoClient : public BenchClient {
+public:
+    std::atomic<uint8_t> probeID{ static_cast<uint8_t>(-1) };
+    HdrHistogram relay{ HIGHEST_LATENCY_NS };
+    std::mutex relayMutex;
+
+protected:
+    bool takeGameMessage(const BaseMessage& msg) override {
+        BenchStamp stamp;
+        if (msg.messageType == TEXT_MESSAGE && msg.senderID == probeID && findBenchStamp(msg.message, stamp)) {
+            uint64_t now = benchClockNow();
+            {
+                std::lock_guard<std::mutex> lock(relayMutex);
+                relay.record(now - stamp.sentAt);
+            }
+            sendMessage(msg);
+        }
+        return BenchClient::takeGameMessage(msg);
+    }
+};
+
+// Waits for its own probe to come back from the echo client
+class ProbeClient : public BenchClient {
+public:
+    std::atomic<uint8_t> echoID{ static_cast<uint8_t>(-1) };
+
+    // Returns the round trip in nanoseconds, or 0 on timeout
+    uint64_t roundTrip(uint32_t sequence, size_t size) {
+        std::unique_lock<std::mutex> lock(echoMutex);
+        echoedSequence = 0;
+        BaseMessage probe = makeProbe(sequence, size);
+        uint64_t sentAt = benchClockNow();
+        sendMessage(probe);
+        if (!echoed.wait_for(lock, ECHO_TIMEOUT, [&] { return echoedSequence == sequence; }))
+            return 0;
+        return echoedAt - sentAt;
+    }
+
+protected:
+    bool takeGameMessage(const BaseMessage& msg) override {
+        BenchStamp stamp;
+        if (msg.messageType == TEXT_MESSAGE && msg.senderID == echoID && findBenchStamp(msg.message, stamp)) {
+            uint64_t now = benchClockNow();
+            std::lock_guard<std::mutex> lock(echoMutex);
+            echoedSequence = stamp.sequence;
+            echoedAt = now;
+            echoed.notify_one();
+        }
+        return BenchClient::takeGameMessage(msg);
+    }
+
+private:
+    std::mutex echoMutex;
+    std::condition_variable echoed;
+    uint32_t echoedSequence = 0;
+    uint64_t echoedAt = 0;
+};
+
+struct BenchResult {
+    size_t clients = 0;
+    size_t size = 0;
+    size_t timeouts = 0;
+    HdrHistogram relay{ HIGHEST_LATENCY_NS };
+    HdrHistogram roundTrip{ HIGHEST_LATENCY_NS };
+    std::ostringstream proxyStats;
+};
+
+bool waitForIDs(const std::vector<std::unique_ptr<BenchClient>>& clients) {
+    auto deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+    for (const auto& client : clients) {
+        if (!client->waitForClients(clients.size(), deadline))
+            return false;
+    }
+    return true;
+}
+
+bool runConfiguration(const BenchOptions& options, size_t clientCount, size_t size, BenchResult& result) {
+    std::unique_ptr<Server> server;
+    std::string host = options.host.empty() ? "127.0.0.1" : options.host;
+    if (options.host.empty()) {
+        ServerConfig config;
+        config.port = options.port;
+        config.workerThreads = options.workers;
+        server = std::make_unique<Server>(config);
+        if (!server->start())
+            return false;
+    }
+    // A fresh proxy per run, so every configuration sees the same random sequence
+    std::unique_ptr<ImpairProxy> proxy;
+    uint16_t port = options.port;
+    if (!options.scenarioFile.empty()) {
+        proxy = std::make_unique<ImpairProxy>(options.scenario);
+        if (!proxy->startTcp(0, host, options.port))
+            return false;
+        host = "127.0.0.1";
+        port = proxy->getTcpPort();
+    }
+
+    // Client 0 probes, client 1 echoes, the rest just listen
+    std::vector<std::unique_ptr<BenchClient>> clients;
+    clients.push_back(std::make_unique<ProbeClient>());
+    clients.push_back(std::make_unique<EchoClient>());
+    while (clients.size() < std::max<size_t>(clientCount, 2))
+        clients.push_back(std::make_unique<BenchClient>());
+    for (auto& client : clients) {
+        client->setServerPort(port);
+        if (client->start(host) != 0)
+            return false;
+    }
+    if (!waitForIDs(clients)) {
+        std::cerr << "Clients didn't get their IDs and client list in time\n";
+        return false;
+    }
+
+    auto* probe = static_cast<ProbeClient*>(clients[0].get());
+    auto* echo = static_cast<EchoClient*>(clients[1].get());
+    probe->echoID = echo->getClientID();
+    echo->probeID = probe->getClientID();
+
+    result.clients = clients.size();
+    result.size = size;
+    for (size_t i = 0; i < options.warmup + options.samples; ++i) {
+        uint64_t roundTrip = probe->roundTrip(static_cast<uint32_t>(i + 1), size);
+        if (i + 1 == options.warmup) {
+            std::lock_guard<std::mutex> lock(echo->relayMutex);
+            echo->relay.reset();
+        }
+        if (i < options.warmup)
+            continue;
+        if (roundTrip == 0)
+            ++result.timeouts;
+        else
+            result.roundTrip.record(roundTrip);
+    }
+    {
+        std::lock_guard<std::mutex> lock(echo->relayMutex);
+        result.relay.add(echo->relay);
+    }
+
+    // Joins each client's receive thread, so none outlives its client
+    for (auto& client : clients)
+        client->stop();
+    if (proxy) {
+        proxy->stop();
+        proxy->writeStats(result.proxyStats);
+    }
+    if (server)
+        server->stop();
+    return true;
+}
+
+std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ','))
+        values.push_back(std::stoul(item));
+    return values;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        std::string value = argv[i + 1];
+        try {
+            if (key == "--clients") options.clientCounts = parseList(value);
+            else if (key == "--sizes") options.messageSizes = parseList(value);
+            else if (key == "--samples") options.samples = std::stoul(value);
+            else if (key == "--warmup") options.warmup = std::stoul(value);
+            else if (key == "--port") options.port = static_cast<uint16_t>(std::stoul(value));
+            else if (key == "--workers") options.workers = std::stoul(value);
+            else if (key == "--host") options.host = value;
+            else if (key == "--json") options.jsonFile = value;
+            else if (key == "--csv") options.csvFile = value;
+            else if (key == "--hgrm-dir") options.hgrmDir = value;
+            else if (key == "--scenario") options.scenarioFile = value;
+            else return false;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    return argc % 2 == 1 && options.samples > 0 && !options.clientCounts.empty() && !options.messageSizes.empty();
+}
+
+void printUsage() {
+    std::cout << "Usage: RelayLatency [--clients 2,8,32] [--sizes 16,256,1024] [--samples N]\n"
+              << "                    [--warmup N] [--port N] [--workers N] [--host ip]\n"
+              << "                    [--json file] [--csv file] [--hgrm-dir dir] [--scenario file]\n";
+}
+
+const std::vector<std::pair<const char*, double>> PERCENTILES = {
+    { "p50", 50.0 }, { "p90", 90.0 }, { "p99", 99.0 }, { "p999", 99.9 },
+};
+
+double micros(uint64_t nanoseconds) {
+    return nanoseconds / 1000.0;
+}
+
+void printRow(const char* metric, const BenchResult& result, const HdrHistogram& histogram) {
+    std::cout << std::setw(8) << result.clients << std::setw(8) << result.size << "  " << std::left << std::setw(11) << metric << std::right
+        << std::fixed << std::setprecision(1) << std::setw(9) << micros(histogram.min());
+    for (const auto& percentile : PERCENTILES)
+        std::cout << std::setw(9) << micros(histogram.valueAtPercentile(percentile.second));
+    std::cout << std::setw(10) << micros(histogram.max()) << std::endl;
+}
+
+void writeJsonStats(std::ostream& out, const HdrHistogram& histogram) {
+    out << "{\"count\": " << histogram.count() << ", \"min\": " << micros(histogram.min());
+    for (const auto& percentile : PERCENTILES)
+        out << ", \"" << percentile.first << "\": " << micros(histogram.valueAtPercentile(percentile.second));
+    out << ", \"max\": " << micros(histogram.max()) << ", \"mean\": " << histogram.mean() / 1000.0 << "}";
+}
+
+void writeJson(const std::string& path, const BenchOptions& options, const std::vector<std::unique_ptr<BenchResult>>& results) {
+    std::ofstream out(path);
+    out << std::fixed << std::setprecision(3) << "{\n  \"benchmark\": \"relay_latency\",\n  \"unit\": \"us\",\n";
+    if (!options.scenarioFile.empty())
+        out << "  \"scenario\": {\"name\": \"" << options.scenario.name << "\", \"seed\": " << options.scenario.seed << "},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& result = *results[i];
+        out << "    {\"clients\": " << result.clients << ", \"size\": " << result.size << ", \"timeouts\": " << result.timeouts
+            << ",\n     \"relay\": ";
+        writeJsonStats(out, result.relay);
+        out << ",\n     \"round_trip\": ";
+        writeJsonStats(out, result.roundTrip);
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(const std::string& path, const std::vector<std::unique_ptr<BenchResult>>& results) {
+    std::ofstream out(path);
+    out << "clients,size,metric,count,min_us,p50_us,p90_us,p99_us,p999_us,max_us,mean_us,timeouts\n" << std::fixed << std::setprecision(3);
+    for (const auto& result : results) {
+        for (const auto& metric : { std::make_pair("relay", &result->relay), std::make_pair("round_trip", &result->roundTrip) }) {
+            const HdrHistogram& histogram = *metric.second;
+            out << result->clients << "," << result->size << "," << metric.first << "," << histogram.count() << "," << micros(histogram.min());
+            for (const auto& percentile : PERCENTILES)
+                out << "," << micros(histogram.valueAtPercentile(percentile.second));
+            out << "," << micros(histogram.max()) << "," << histogram.mean() / 1000.0 << "," << result->timeouts << "\n";
+        }
+    }
+}
+
+void writeHistograms(const std::string& dir, const BenchResult& result) {
+    std::string prefix = dir + "/relay_c" + std::to_string(result.clients) + "_s" + std::to_string(result.size);
+    std::ofstream relay(prefix + "_relay.hgrm");
+    result.relay.writePercentiles(relay, 1000.0);
+    std::ofstream roundTrip(prefix + "_rtt.hgrm");
+    result.roundTrip.writePercentiles(roundTrip, 1000.0);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+    LogManager::Instance().SetGlobalLogLevel(LogLevel::Log_Error);
+    std::string error;
+    if (!options.scenarioFile.empty() && !ImpairScenario::load(options.scenarioFile, options.scenario, error)) {
+        std::cerr << error << "\n";
+        return 1;
+    }
+    if (!options.scenarioFile.empty())
+        std::cout << "Scenario " << options.scenario.name << " (seed " << options.scenario.seed << ")" << std::endl;
+
+    std::cout << std::setw(8) << "clients" << std::setw(8) << "size" << "  " << std::left << std::setw(11) << "metric" << std::right
+        << std::setw(9) << "min";
+    for (const auto& percentile : PERCENTILES)
+        std::cout << std::setw(9) << percentile.first;
+    std::cout << std::setw(10) << "max" << "   (us)" << std::endl;
+
+    std::vector<std::unique_ptr<BenchResult>> results;
+    bool failed = false;
+    for (size_t clientCount : options.clientCounts) {
+        for (size_t size : options.messageSizes) {
+            auto result = std::make_unique<BenchResult>();
+            if (!runConfiguration(options, clientCount, size, *result)) {
+                std::cerr << "Run with " << clientCount << " clients and " << size << " bytes failed\n";
+                failed = true;
+                continue;
+            }
+            printRow("relay", *result, result->relay);
+            printRow("round trip", *result, result->roundTrip);
+            if (result->timeouts)
+                std::cout << "        " << result->timeouts << " probes timed out" << std::endl;
+            if (!options.scenarioFile.empty())
+                std::cout << result->proxyStats.str();
+            if (!options.hgrmDir.empty())
+                writeHistograms(options.hgrmDir, *result);
+            results.push_back(std::move(result));
+        }
+    }
+
+    if (!options.jsonFile.empty())
+        writeJson(options.jsonFile, options, results);
+    if (!options.csvFile.empty())
+        writeCsv(options.csvFile, results);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <cstdint>
+
+#include "../../ServerClient/GameData.h"
+
+// Extra game record the load tools append to the messages they send:
+// sequence number (uint32) and send time (uint64, steady clock nanoseconds).
+// The server relays records with unknown labels untouched, and the tools run
+// all their clients in one process, so receive time minus send time is the
+// one-way relay latency and gaps in the sequence are lost messages.
+const uint8_t BENCH_STAMP_LABEL = 0xB5;
+const uint8_t BENCH_STAMP_SIZE = sizeof(uint32_t) + sizeof(uint64_t);
+
+struct BenchStamp {
+    uint32_t sequence = 0;
+    uint64_t sentAt = 0;
+};
+
+inline uint64_t benchClockNow() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void appendBenchStamp(std::vector<uint8_t>& body, uint32_t sequence) {
+    body.push_back(BENCH_STAMP_LABEL);
+    body.push_back(BENCH_STAMP_SIZE);
+    appendRaw(body, sequence);
+    appendRaw(body, benchClockNow());
+}
+
+// Looks for the stamp record among the records of a message body
+inline bool findBenchStamp(const std::queue<uint8_t>& message, BenchStamp& stamp) {
+    std::queue<uint8_t> body = message;
+    while (body.size() >= 2) {
+        uint8_t label = body.front();
+        body.pop();
+        uint8_t size = body.front();
+        body.pop();
+        if (body.size() < size)
+            return false;
+
+        std::vector<uint8_t> data(size);
+        for (uint8_t& byte : data) {
+            byte = body.front();
+            body.pop();
+        }
+        if (label == BENCH_STAMP_LABEL && size == BENCH_STAMP_SIZE) {
+            size_t offset = 0;
+            return readRaw(data, offset, stamp.sequence) && readRaw(data, offset, stamp.sentAt);
+        }
+    }
+    return false;
+}
@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <bit>
+#include <algorithm>
+#include <ostream>
+#include <iomanip>
+
+// Log-linear histogram in the layout of HdrHistogram: values are grouped in
+// power-of-two buckets, each split into enough linear sub-buckets to keep
+// `significantDigits` decimal digits. Recording is a few shifts and an
+// increment, so it is cheap enough for every message, and percentiles stay
+// accurate from microseconds up to seconds in the same histogram.
+//
+// Not thread safe; give each thread its own and add() them for the report.
+class HdrHistogram {
+public:
+    explicit HdrHistogram(uint64_t highestTrackable = 60000000, int significantDigits = 3) {
+        uint64_t largestSingleUnitResolution = 2 * static_cast<uint64_t>(std::pow(10, significantDigits));
+        subBucketCount = std::bit_ceil(largestSingleUnitResolution);
+        subBucketHalfCountMagnitude = std::bit_width(subBucketCount) - 2;
+        subBucketHalfCount = subBucketCount / 2;
+        subBucketMask = subBucketCount - 1;
+
+        bucketCount = 1;
+        for (uint64_t smallestUntrackable = subBucketCount; smallestUntrackable <= highestTrackable; smallestUntrackable <<= 1)
+            ++bucketCount;
+        counts.assign((bucketCount + 1) * subBucketHalfCount, 0);
+        highest = highestTrackable;
+    }
+
+    void record(uint64_t value) {
+        value = std::min(value, highest);
+        ++counts[countsIndex(value)];
+        ++total;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+        sum += static_cast<double>(value);
+    }
+
+    // Both histograms must have been created with the same settings
+    void add(const HdrHistogram& other) {
+        for (size_t i = 0; i < counts.size() && i < other.counts.size(); ++i)
+            counts[i] += other.counts[i];
+        total += other.total;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        sum += other.sum;
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+        sum = 0;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minValue : 0; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? sum / total : 0.0; }
+
+    // Highest value of the bucket the percentile (0-100) falls into
+    uint64_t valueAtPercentile(double percentile) const {
+        if (total == 0)
+            return 0;
+        uint64_t target = static_cast<uint64_t>(std::ceil(std::clamp(percentile, 0.0, 100.0) / 100.0 * total));
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= target)
+                return std::min(highestEquivalentValue(valueFromIndex(i)), maxValue);
+        }
+        return maxValue;
+    }
+
+    // Writes the percentile distribution in the .hgrm text format that the
+    // HdrHistogram plotter reads. Values are divided by unitScale (1000 turns
+    // microseconds into milliseconds).
+    void writePercentiles(std::ostream& out, double unitScale = 1.0, int ticksPerHalfDistance = 5) const {
+        out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " "
+            << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+        out << std::fixed;
+
+        double level = 0.0;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size() && total > 0; ++i) {
+            if (counts[i] == 0)
+                continue;
+            seen += counts[i];
+            double reached = 100.0 * seen / total;
+            uint64_t value = std::min(highestEquivalentValue(valueFromIndex(i)), maxValue);
+            while (level <= reached) {
+                writeRow(out, value / unitScale, reached, seen);
+                if (reached >= 100.0)
+                    break;
+                // Rows get denser towards the tail: each halving of the distance to 100% gets the same number of rows
+                double halfDistance = std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - level))) + 1);
+                level += 100.0 / (ticksPerHalfDistance * halfDistance);
+            }
+        }
+
+        double variance = 0.0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            if (counts[i] == 0)
+                continue;
+            double delta = medianEquivalentValue(valueFromIndex(i)) - mean();
+            variance += delta * delta * counts[i];
+        }
+        double stdDeviation = total ? std::sqrt(variance / total) : 0.0;
+
+        out << std::setprecision(3)
+            << "#[Mean    = " << std::setw(12) << mean() / unitScale << ", StdDeviation   = " << std::setw(12) << stdDeviation / unitScale << "]\n"
+            << "#[Max     = " << std::setw(12) << max() / unitScale << ", Total count    = " << std::setw(12) << total << "]\n"
+            << "#[Buckets = " << std::setw(12) << bucketCount << ", SubBuckets     = " << std::setw(12) << subBucketCount << "]\n";
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t subBucketCount;
+    uint64_t subBucketHalfCount;
+    uint64_t subBucketMask;
+    int subBucketHalfCountMagnitude;
+    int bucketCount;
+    uint64_t highest;
+
+    uint64_t total = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+    double sum = 0;
+
+    int bucketIndex(uint64_t value) const {
+        return std::bit_width(value | subBucketMask) - (subBucketHalfCountMagnitude + 1);
+    }
+    size_t countsIndex(uint64_t value) const {
+        int bucket = bucketIndex(value);
+        uint64_t subBucket = value >> bucket;
+        return (static_cast<size_t>(bucket + 1) << subBucketHalfCountMagnitude) + (subBucket - subBucketHalfCount);
+    }
+    uint64_t valueFromIndex(size_t index) const {
+        int bucket = static_cast<int>(index >> subBucketHalfCountMagnitude) - 1;
+        uint64_t subBucket = (index & (subBucketHalfCount - 1)) + subBucketHalfCount;
+        if (bucket < 0) {
+            subBucket -= subBucketHalfCount;
+            bucket = 0;
+        }
+        return subBucket << bucket;
+    }
+    uint64_t highestEquivalentValue(uint64_t value) const {
+        return value + (uint64_t(1) << bucketIndex(value)) - 1;
+    }
+    double medianEquivalentValue(uint64_t value) const {
+        return value + static_cast<double>(uint64_t(1) << bucketIndex(value)) / 2;
+    }
+
+    static void writeRow(std::ostream& out, double value, double percentile, uint64_t totalCount) {
+        out << std::setprecision(3) << std::setw(12) << value << " "
+            << std::setprecision(12) << std::setw(14) << percentile / 100.0 << " "
+            << std::setw(10) << totalCount << " ";
+        if (percentile < 100.0)
+            out << std::setprecision(2) << std::setw(14) << 1.0 / (1.0 - percentile / 100.0) << "\n";
+        else
+            out << std::setw(14) << "inf" << "\n";
+    }
+};
@@ -0,0 +1,427 @@
+#include "ImpairProxy.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A lost TCP segment waits for the retransmission timeout before it is sent again
+const double MIN_RETRANSMIT_MS = 200.0;
+// Extra delay that pushes a reordered datagram behind the ones sent after it
+const double REORDER_DELAY_MS = 10.0;
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos)
+        return "";
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+bool setField(Impairment& impairment, const std::string& key, double value) {
+    if (key == "latency") impairment.latencyMs = value;
+    else if (key == "jitter") impairment.jitterMs = value;
+    else if (key == "loss") impairment.lossPercent = value;
+    else if (key == "reorder") impairment.reorderPercent = value;
+    else if (key == "bandwidth") impairment.bandwidthKbps = value;
+    else return false;
+    return true;
+}
+
+}
+
+bool ImpairScenario::load(const std::string& path, ImpairScenario& scenario, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "can't open " + path;
+        return false;
+    }
+
+    scenario = ImpairScenario();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::string where = path + ":" + std::to_string(lineNumber) + ": ";
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty())
+            continue;
+
+        if (line.rfind("at ", 0) == 0) {
+            // A new phase starts from the settings of the previous one
+            Phase phase = scenario.phases.back();
+            try {
+                phase.atSeconds = std::stod(line.substr(3));
+            }
+            catch (const std::exception&) {
+                error = where + "bad time";
+                return false;
+            }
+            if (phase.atSeconds <= scenario.phases.back().atSeconds) {
+                error = where + "phases must be in increasing time";
+                return false;
+            }
+            scenario.phases.push_back(phase);
+            continue;
+        }
+
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            error = where + "expected key = value";
+            return false;
+        }
+        std::string key = trim(line.substr(0, equals));
+        std::string value = trim(line.substr(equals + 1));
+
+        if (key == "name") {
+            scenario.name = value;
+            continue;
+        }
+        if (key == "tcp-loss") {
+            if (value != "retransmit" && value != "drop") {
+                error = where + "tcp-loss is retransmit or drop";
+                return false;
+            }
+            scenario.dropFrames = value == "drop";
+            continue;
+        }
+
+        double number;
+        try {
+            number = std::stod(value);
+        }
+        catch (const std::exception&) {
+            error = where + "bad number for " + key;
+            return false;
+        }
+        if (number < 0.0) {
+            error = where + key + " can't be negative";
+            return false;
+        }
+        if (key == "seed") {
+            scenario.seed = static_cast<uint64_t>(number);
+            continue;
+        }
+
+        Phase& phase = scenario.phases.back();
+        bool known;
+        if (key.rfind("up.", 0) == 0)
+            known = setField(phase.up, key.substr(3), number);
+        else if (key.rfind("down.", 0) == 0)
+            known = setField(phase.down, key.substr(5), number);
+        else
+            known = setField(phase.up, key, number) && setField(phase.down, key, number);
+        if (!known) {
+            error = where + "unknown key " + key;
+            return false;
+        }
+    }
+    return true;
+}
+
+const ImpairScenario::Phase& ImpairScenario::phaseAt(double seconds) const {
+    size_t current = 0;
+    while (current + 1 < phases.size() && phases[current + 1].atSeconds <= seconds)
+        ++current;
+    return phases[current];
+}
+
+ImpairProxy::ImpairProxy(const ImpairScenario& scenario)
+    : scenario(scenario), startedAt(Clock::now()) {}
+
+std::shared_ptr<ImpairProxy::Lane> ImpairProxy::makeLane(uint64_t connection, bool up) {
+    std::seed_seq seed{ scenario.seed, connection, static_cast<uint64_t>(up) };
+    return std::make_shared<Lane>(ioContext, seed);
+}
+
+bool ImpairProxy::startTcp(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort) {
+    if (acceptor)
+        return false;
+    try {
+        asio::ip::tcp::resolver resolver(ioContext);
+        tcpTarget = *resolver.resolve(asio::ip::tcp::v4(), targetHost, std::to_string(targetPort)).begin();
+
+        acceptor = std::make_unique<asio::ip::tcp::acceptor>(ioContext);
+        asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), listenPort);
+        acceptor->open(endpoint.protocol());
+        acceptor->set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        acceptor->bind(endpoint);
+        acceptor->listen();
+        tcpPort = acceptor->local_endpoint().port();
+    }
+    catch (const std::exception&) {
+        acceptor.reset();
+        return false;
+    }
+
+    asio::co_spawn(ioContext, acceptLoop(), asio::detached);
+    ensureRunning();
+    return true;
+}
+
+bool ImpairProxy::startUdp(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort) {
+    if (udpListen)
+        return false;
+    try {
+        asio::ip::udp::resolver resolver(ioContext);
+        udpTarget = *resolver.resolve(asio::ip::udp::v4(), targetHost, std::to_string(targetPort)).begin();
+
+        udpListen = std::make_unique<asio::ip::udp::socket>(ioContext,
+            asio::ip::udp::endpoint(asio::ip::udp::v4(), listenPort));
+        udpPort = udpListen->local_endpoint().port();
+    }
+    catch (const std::exception&) {
+        udpListen.reset();
+        return false;
+    }
+
+    asio::co_spawn(ioContext, readDatagrams(), asio::detached);
+    ensureRunning();
+    return true;
+}
+
+void ImpairProxy::ensureRunning() {
+    if (running.exchange(true))
+        return;
+    startedAt = Clock::now();
+    thread = std::thread([this]() { ioContext.run(); });
+}
+
+void ImpairProxy::stop() {
+    if (!running.exchange(false))
+        return;
+    ioContext.stop();
+    if (thread.joinable())
+        thread.join();
+}
+
+bool ImpairProxy::schedule(Lane& lane, DirectionStats& stats, bool up, bool ordered, std::vector<uint8_t> data) {
+    auto now = Clock::now();
+    const ImpairScenario::Phase& phase = scenario.phaseAt(std::chrono::duration<double>(now - startedAt).count());
+    const Impairment& impairment = up ? phase.up : phase.down;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    double delayMs = impairment.latencyMs;
+    if (impairment.jitterMs > 0.0)
+        delayMs += (unit(lane.random) * 2.0 - 1.0) * impairment.jitterMs;
+    delayMs = std::max(0.0, delayMs);
+
+    if (impairment.lossPercent > 0.0 && unit(lane.random) * 100.0 < impairment.lossPercent) {
+        if (!ordered || scenario.dropFrames) {
+            ++stats.dropped;
+            return false;
+        }
+        delayMs += std::max(MIN_RETRANSMIT_MS, 2.0 * impairment.latencyMs);
+        ++stats.retransmitted;
+    }
+    if (!ordered && impairment.reorderPercent > 0.0 && unit(lane.random) * 100.0 < impairment.reorderPercent) {
+        delayMs += 2.0 * impairment.jitterMs + REORDER_DELAY_MS;
+        ++stats.reordered;
+    }
+
+    auto releaseAt = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(delayMs));
+    if (impairment.bandwidthKbps > 0.0) {
+        // The link sends one packet at a time at the capped rate
+        double sendSeconds = data.size() * 8.0 / (impairment.bandwidthKbps * 1000.0);
+        lane.linkFreeAt = std::max(lane.linkFreeAt, now)
+            + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(sendSeconds));
+        releaseAt = std::max(releaseAt, lane.linkFreeAt);
+    }
+
+    ++stats.frames;
+    stats.bytes += data.size();
+    stats.addedDelayUs += std::chrono::duration_cast<std::chrono::microseconds>(releaseAt - now).count();
+
+    if (ordered) {
+        // A stream can't overtake itself
+        releaseAt = std::max(releaseAt, lane.lastRelease);
+        lane.lastRelease = releaseAt;
+        lane.queue.push_back({ std::move(data), releaseAt });
+    }
+    else {
+        auto at = std::upper_bound(lane.queue.begin(), lane.queue.end(), releaseAt,
+            [](Clock::time_point time, const Packet& packet) { return time < packet.releaseAt; });
+        lane.queue.insert(at, { std::move(data), releaseAt });
+    }
+
+    uint64_t queued = lane.queue.size();
+    uint64_t seen = stats.maxQueued.load();
+    while (queued > seen && !stats.maxQueued.compare_exchange_weak(seen, queued)) {}
+
+    // Wakes the writer if this packet is now the first one due
+    if (lane.queue.front().releaseAt == releaseAt)
+        lane.wake->cancel();
+    return true;
+}
+
+asio::awaitable<bool> ImpairProxy::nextDue(Lane& lane, Packet& packet) {
+    while (true) {
+        if (lane.queue.empty()) {
+            if (lane.closed)
+                co_return false;
+            lane.wake->expires_at(Clock::time_point::max());
+            co_await lane.wake->async_wait(asio::as_tuple(asio::use_awaitable));
+            continue;
+        }
+        if (Clock::now() < lane.queue.front().releaseAt) {
+            lane.wake->expires_at(lane.queue.front().releaseAt);
+            co_await lane.wake->async_wait(asio::as_tuple(asio::use_awaitable));
+            continue;
+        }
+        packet = std::move(lane.queue.front());
+        lane.queue.pop_front();
+        co_return true;
+    }
+}
+
+asio::awaitable<void> ImpairProxy::acceptLoop() {
+    while (true) {
+        auto [ec, socket] = co_await acceptor->async_accept(asio::as_tuple(asio::use_awaitable));
+        if (ec == asio::error::operation_aborted)
+            co_return;
+        if (ec)
+            continue;
+        asio::co_spawn(ioContext, bridge(std::make_shared<asio::ip::tcp::socket>(std::move(socket))), asio::detached);
+    }
+}
+
+asio::awaitable<void> ImpairProxy::bridge(std::shared_ptr<asio::ip::tcp::socket> client) {
+    auto server = std::make_shared<asio::ip::tcp::socket>(ioContext);
+    auto [ec] = co_await server->async_connect(tcpTarget, asio::as_tuple(asio::use_awaitable));
+    if (ec) {
+        asio::error_code ignored;
+        client->close(ignored);
+        co_return;
+    }
+    // The proxy adds its own delays, Nagle must not add more
+    asio::error_code ignored;
+    client->set_option(asio::ip::tcp::no_delay(true), ignored);
+    server->set_option(asio::ip::tcp::no_delay(true), ignored);
+
+    uint64_t connection = connections++;
+    auto upLane = makeLane(connection, true);
+    auto downLane = makeLane(connection, false);
+    asio::co_spawn(ioContext, readFrames(client, upLane, true), asio::detached);
+    asio::co_spawn(ioContext, writeFrames(upLane, server), asio::detached);
+    asio::co_spawn(ioContext, readFrames(server, downLane, false), asio::detached);
+    asio::co_spawn(ioContext, writeFrames(downLane, client), asio::detached);
+}
+
+asio::awaitable<void> ImpairProxy::readFrames(std::shared_ptr<asio::ip::tcp::socket> from, std::shared_ptr<Lane> lane, bool up) {
+    uint8_t prefix[sizeof(uint32_t)];
+    while (true) {
+        auto [ec, n] = co_await asio::async_read(*from, asio::buffer(prefix), asio::as_tuple(asio::use_awaitable));
+        if (ec)
+            break;
+        // Network byte order, as the clients and server write it
+        uint32_t size = (uint32_t(prefix[0]) << 24) | (uint32_t(prefix[1]) << 16) | (uint32_t(prefix[2]) << 8) | prefix[3];
+
+        std::vector<uint8_t> frame(sizeof(prefix) + size);
+        std::copy(prefix, prefix + sizeof(prefix), frame.begin());
+        auto [bodyEc, bodyN] = co_await asio::async_read(*from, asio::buffer(frame.data() + sizeof(prefix), size),
+            asio::as_tuple(asio::use_awaitable));
+        if (bodyEc)
+            break;
+        schedule(*lane, up ? this->up : down, up, true, std::move(frame));
+    }
+    lane->closed = true;
+    lane->wake->cancel();
+}
+
+asio::awaitable<void> ImpairProxy::writeFrames(std::shared_ptr<Lane> lane, std::shared_ptr<asio::ip::tcp::socket> to) {
+    Packet packet;
+    while (co_await nextDue(*lane, packet)) {
+        auto [ec, n] = co_await asio::async_write(*to, asio::buffer(packet.data), asio::as_tuple(asio::use_awaitable));
+        if (ec)
+            break;
+    }
+    // Closing this side ends the reader of the other direction too
+    asio::error_code ignored;
+    to->shutdown(asio::ip::tcp::socket::shutdown_both, ignored);
+    to->close(ignored);
+}
+
+asio::awaitable<void> ImpairProxy::readDatagrams() {
+    std::vector<uint8_t> buffer(65536);
+    asio::ip::udp::endpoint sender;
+    while (true) {
+        auto [ec, n] = co_await udpListen->async_receive_from(asio::buffer(buffer), sender, asio::as_tuple(asio::use_awaitable));
+        if (ec == asio::error::operation_aborted)
+            break;
+        if (ec)
+            continue;
+
+        std::shared_ptr<UdpSession>& session = udpSessions[sender];
+        if (!session) {
+            session = std::make_shared<UdpSession>(ioContext);
+            session->client = sender;
+            asio::error_code openEc;
+            session->upstream.open(asio::ip::udp::v4(), openEc);
+            if (!openEc)
+                session->upstream.bind(asio::ip::udp::endpoint(asio::ip::udp::v4(), 0), openEc);
+            if (openEc) {
+                udpSessions.erase(sender);
+                continue;
+            }
+            uint64_t connection = connections++;
+            session->up = makeLane(connection, true);
+            session->down = makeLane(connection, false);
+            asio::co_spawn(ioContext, writeDatagrams(session, true), asio::detached);
+            asio::co_spawn(ioContext, readUpstream(session), asio::detached);
+            asio::co_spawn(ioContext, writeDatagrams(session, false), asio::detached);
+        }
+        schedule(*session->up, up, true, false, std::vector<uint8_t>(buffer.begin(), buffer.begin() + n));
+    }
+    for (auto& entry : udpSessions) {
+        entry.second->up->closed = true;
+        entry.second->up->wake->cancel();
+        asio::error_code ignored;
+        entry.second->upstream.close(ignored);
+    }
+}
+
+asio::awaitable<void> ImpairProxy::readUpstream(std::shared_ptr<UdpSession> session) {
+    std::vector<uint8_t> buffer(65536);
+    asio::ip::udp::endpoint sender;
+    while (true) {
+        auto [ec, n] = co_await session->upstream.async_receive_from(asio::buffer(buffer), sender, asio::as_tuple(asio::use_awaitable));
+        if (ec == asio::error::operation_aborted || ec == asio::error::bad_descriptor)
+            break;
+        if (ec)
+            continue;
+        schedule(*session->down, down, false, false, std::vector<uint8_t>(buffer.begin(), buffer.begin() + n));
+    }
+    session->down->closed = true;
+    session->down->wake->cancel();
+}
+
+asio::awaitable<void> ImpairProxy::writeDatagrams(std::shared_ptr<UdpSession> session, bool up) {
+    Lane& lane = up ? *session->up : *session->down;
+    asio::ip::udp::socket& to = up ? session->upstream : *udpListen;
+    Packet packet;
+    while (co_await nextDue(lane, packet)) {
+        co_await to.async_send_to(asio::buffer(packet.data), up ? udpTarget : session->client,
+            asio::as_tuple(asio::use_awaitable));
+    }
+}
+
+void ImpairProxy::writeStats(std::ostream& out) const {
+    auto line = [&out](const char* name, const DirectionStats& stats) {
+        uint64_t frames = stats.frames.load();
+        double averageMs = frames > 0 ? stats.addedDelayUs.load() / 1000.0 / frames : 0.0;
+        out << std::left << std::setw(6) << name << std::right
+            << " frames " << std::setw(9) << frames
+            << "  bytes " << std::setw(11) << stats.bytes.load()
+            << "  dropped " << std::setw(6) << stats.dropped.load()
+            << "  retransmitted " << std::setw(6) << stats.retransmitted.load()
+            << "  reordered " << std::setw(6) << stats.reordered.load()
+            << "  avg delay " << std::fixed << std::setprecision(2) << std::setw(8) << averageMs << " ms"
+            << "  max queued " << stats.maxQueued.load() << "\n";
+    };
+    line("up", up);
+    line("down", down);
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+// Requires C++20 (asio awaitables)
+#include <asio.hpp>
+
+// What one direction of the link does to traffic
+struct Impairment {
+    double latencyMs = 0.0;
+    double jitterMs = 0.0;          // uniform, +/- around the latency
+    double lossPercent = 0.0;
+    double reorderPercent = 0.0;    // UDP only, TCP delivers in order
+    double bandwidthKbps = 0.0;     // 0 for unlimited
+};
+
+// Scenario file: "key = value" lines, '#' starts a comment.
+//   name = bad-wifi
+//   seed = 7                  random seed, the same seed gives the same run
+//   tcp-loss = retransmit     or "drop": lost TCP frames are dropped outright
+//   latency = 40              applies to both directions
+//   up.loss = 2               up = client to server, down = server to client
+//   at 10                     later keys take effect 10 s after start
+//   down.bandwidth = 256
+// Keys: latency, jitter (ms), loss, reorder (percent), bandwidth (kbit/s).
+struct ImpairScenario {
+    struct Phase {
+        double atSeconds = 0.0;
+        Impairment up;
+        Impairment down;
+    };
+
+    std::string name = "clean";
+    uint64_t seed = 1;
+    // TCP can't lose data; a lost segment costs a retransmission instead.
+    // dropFrames removes the whole frame to test how the protocol copes.
+    bool dropFrames = false;
+    std::vector<Phase> phases{ Phase() };
+
+    // Returns false and sets error on a malformed file
+    static bool load(const std::string& path, ImpairScenario& scenario, std::string& error);
+    const Phase& phaseAt(double seconds) const;
+};
+
+struct DirectionStats {
+    std::atomic<uint64_t> frames{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    std::atomic<uint64_t> retransmitted{ 0 };
+    std::atomic<uint64_t> reordered{ 0 };
+    std::atomic<uint64_t> addedDelayUs{ 0 };    // sum over forwarded frames
+    std::atomic<uint64_t> maxQueued{ 0 };
+};
+
+// Localhost proxy that puts a scenario between clients and a server.
+// TCP connections are cut into protocol frames (length prefix) so delay,
+// loss and bandwidth apply per message; UDP datagrams are handled one by one,
+// with replies sent back to the client endpoint they answer. Runs on its own thread.
+class ImpairProxy {
+public:
+    explicit ImpairProxy(const ImpairScenario& scenario);
+    ~ImpairProxy() { stop(); }
+
+    // listenPort 0 picks a free port, see getTcpPort()/getUdpPort()
+    bool startTcp(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort);
+    bool startUdp(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort);
+    void stop();
+
+    uint16_t getTcpPort() const { return tcpPort; }
+    uint16_t getUdpPort() const { return udpPort; }
+    const ImpairScenario& getScenario() const { return scenario; }
+
+    DirectionStats up;      // client to server
+    DirectionStats down;    // server to client
+    void writeStats(std::ostream& out) const;
+
+private:
+    struct Packet {
+        std::vector<uint8_t> data;
+        std::chrono::steady_clock::time_point releaseAt;
+    };
+    // Delay line for one direction of one connection. Each has its own random
+    // sequence, so what happens to a packet doesn't depend on how the traffic
+    // of other lanes interleaves with it.
+    struct Lane {
+        std::deque<Packet> queue;
+        std::chrono::steady_clock::time_point linkFreeAt{};
+        std::chrono::steady_clock::time_point lastRelease{};
+        std::unique_ptr<asio::steady_timer> wake;
+        std::mt19937_64 random;
+        bool closed = false;    // the sending side is gone, deliver what is left and stop
+
+        Lane(asio::io_context& ioContext, std::seed_seq& seed)
+            : wake(std::make_unique<asio::steady_timer>(ioContext, std::chrono::steady_clock::time_point::max())), random(seed) {}
+    };
+    // One UDP client: its own upstream socket, so replies find their way back to it
+    struct UdpSession {
+        asio::ip::udp::endpoint client;
+        asio::ip::udp::socket upstream;
+        std::shared_ptr<Lane> up;
+        std::shared_ptr<Lane> down;
+
+        explicit UdpSession(asio::io_context& ioContext) : upstream(ioContext) {}
+    };
+
+    ImpairScenario scenario;
+    asio::io_context ioContext;
+    std::unique_ptr<asio::ip::tcp::acceptor> acceptor;
+    std::unique_ptr<asio::ip::udp::socket> udpListen;
+    std::map<asio::ip::udp::endpoint, std::shared_ptr<UdpSession>> udpSessions;
+    asio::ip::udp::endpoint udpTarget;
+    asio::ip::tcp::endpoint tcpTarget;
+    uint16_t tcpPort = 0;
+    uint16_t udpPort = 0;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    uint64_t connections = 0;   // TCP connections and UDP clients so far, numbers their lanes
+    std::chrono::steady_clock::time_point startedAt;
+
+    void ensureRunning();
+    // Seeded from the scenario seed, the connection number and the direction
+    std::shared_ptr<Lane> makeLane(uint64_t connection, bool up);
+    // Decides what happens to a packet; returns false if it is lost
+    bool schedule(Lane& lane, DirectionStats& stats, bool up, bool ordered, std::vector<uint8_t> data);
+
+    // Waits until the head of the lane is due; returns false once the lane is closed and empty
+    asio::awaitable<bool> nextDue(Lane& lane, Packet& packet);
+
+    asio::awaitable<void> acceptLoop();
+    asio::awaitable<void> bridge(std::shared_ptr<asio::ip::tcp::socket> client);
+    asio::awaitable<void> readFrames(std::shared_ptr<asio::ip::tcp::socket> from, std::shared_ptr<Lane> lane, bool up);
+    asio::awaitable<void> writeFrames(std::shared_ptr<Lane> lane, std::shared_ptr<asio::ip::tcp::socket> to);
+    // Client datagrams, each to the session of its sender
+    asio::awaitable<void> readDatagrams();
+    asio::awaitable<void> readUpstream(std::shared_ptr<UdpSession> session);
+    asio::awaitable<void> writeDatagrams(std::shared_ptr<UdpSession> session, bool up);
+};